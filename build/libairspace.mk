@@ -10,6 +10,7 @@ AIRSPACE_SOURCES = \
 	$(AIRSPACE_SRC_DIR)/AirspaceCircle.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspacePolygon.cpp \
 	$(AIRSPACE_SRC_DIR)/Airspaces.cpp \
+	$(AIRSPACE_SRC_DIR)/AirspaceFilterTable.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceIntersectSort.cpp \
 	$(AIRSPACE_SRC_DIR)/SoonestAirspace.cpp \
 	$(AIRSPACE_SRC_DIR)/Predicate/AirspacePredicate.cpp \
@@ -9,6 +9,7 @@ THREAD_SOURCES = \
 	$(THREAD_SRC_DIR)/RecursivelySuspensibleThread.cpp \
 	$(THREAD_SRC_DIR)/WorkerThread.cpp \
 	$(THREAD_SRC_DIR)/StandbyThread.cpp \
+	$(THREAD_SRC_DIR)/ThreadPool.cpp \
 	$(THREAD_SRC_DIR)/Mutex.cpp \
 	$(THREAD_SRC_DIR)/Debug.cpp
 
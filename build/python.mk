@@ -9,6 +9,7 @@ PYTHON_SOURCES = \
 	$(SRC)/IGC/IGCFix.cpp \
 	$(ENGINE_SRC_DIR)/Trace/Point.cpp \
 	$(ENGINE_SRC_DIR)/Trace/Trace.cpp \
+	$(ENGINE_SRC_DIR)/Trace/PackedTrace.cpp \
 	$(SRC)/Computer/CirclingComputer.cpp \
         $(SRC)/Computer/Wind/Settings.cpp \
         $(SRC)/Computer/Wind/WindEKF.cpp \
@@ -48,6 +49,7 @@ PYTHON_SOURCES = \
 	$(ENGINE_SRC_DIR)/Airspace/AirspaceIntersectSort.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/AirspacePolygon.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/Airspaces.cpp \
+	$(ENGINE_SRC_DIR)/Airspace/AirspaceFilterTable.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/AirspaceSorter.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/AirspaceVisitor.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/AirspaceAircraftPerformance.cpp \
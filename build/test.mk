@@ -67,6 +67,7 @@ define link-harness-program
 $(1)_SOURCES = \
 	$(SRC)/Engine/Trace/Point.cpp \
 	$(SRC)/Engine/Trace/Trace.cpp \
+	$(SRC)/Engine/Trace/PackedTrace.cpp \
 	$(SRC)/Engine/Trace/Vector.cpp \
 	$(SRC)/Engine/Navigation/Aircraft.cpp \
 	$(SRC)/Engine/Util/Gradient.cpp \
@@ -90,13 +91,21 @@ TEST_NAMES = \
 	test_pressure \
 	test_task \
 	TestOverwritingRingBuffer \
+	TestDenseHashMap \
+	TestPackedTrace TestTrace \
 	TestDateTime TestRoughTime TestWrapClock \
 	TestMathTables \
 	TestAngle TestARange \
 	TestUnits TestEarth TestSunEphemeris \
 	TestValidity TestUTM TestProfile \
 	TestAllocatedGrid \
-	TestRadixTree TestGeoBounds TestGeoClip \
+	TestSlopeShading \
+	TestRasterTileCache TestRasterMap \
+	TestThreadPool \
+	TestOLCTriangle \
+	TestSnapshotBuffer \
+	TestRadixTree TestGeoBounds TestGeoClip TestPolygonEdgeIndex \
+	TestPackedRTree TestAirspaceFilterTable TestAirspaceCache \
 	TestLogger TestGRecord TestDriver TestClimbAvCalc \
 	TestWaypointReader TestThermalBase \
 	TestFlarmNet \
@@ -138,6 +147,20 @@ TEST_OVERWRITING_RING_BUFFER_SOURCES = \
 TEST_OVERWRITING_RING_BUFFER_DEPENDS = MATH
 $(eval $(call link-program,TestOverwritingRingBuffer,TEST_OVERWRITING_RING_BUFFER))
 
+TEST_DENSE_HASH_MAP_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestDenseHashMap.cpp
+TEST_DENSE_HASH_MAP_DEPENDS = MATH
+$(eval $(call link-program,TestDenseHashMap,TEST_DENSE_HASH_MAP))
+
+TEST_PACKED_TRACE_SOURCES = \
+	$(SRC)/Engine/Trace/Point.cpp \
+	$(SRC)/Engine/Trace/PackedTrace.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestPackedTrace.cpp
+TEST_PACKED_TRACE_DEPENDS = GEO MATH
+$(eval $(call link-program,TestPackedTrace,TEST_PACKED_TRACE))
+
 TEST_IGC_PARSER_SOURCES = \
 	$(SRC)/IGC/IGCParser.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -180,6 +203,22 @@ TEST_AIRSPACE_PARSER_LDADD = $(FAKE_LIBS)
 TEST_AIRSPACE_PARSER_DEPENDS = IO OS AIRSPACE ZZIP GEO MATH UTIL
 $(eval $(call link-program,TestAirspaceParser,TEST_AIRSPACE_PARSER))
 
+TEST_AIRSPACE_CACHE_SOURCES = \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
+	$(SRC)/Units/Descriptor.cpp \
+	$(SRC)/Units/System.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(TEST_SRC_DIR)/FakeDialogs.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAirspaceCache.cpp
+TEST_AIRSPACE_CACHE_LDADD = $(FAKE_LIBS)
+TEST_AIRSPACE_CACHE_DEPENDS = IO OS AIRSPACE ZZIP GEO MATH UTIL
+$(eval $(call link-program,TestAirspaceCache,TEST_AIRSPACE_CACHE))
+
 TEST_DATE_TIME_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestDateTime.cpp
@@ -324,6 +363,7 @@ TEST_REPLAY_TASK_SOURCES = \
 	$(SRC)/Atmosphere/AirDensity.cpp \
 	$(SRC)/Atmosphere/Pressure.cpp \
 	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/IGC/IGCMappedReader.cpp \
 	$(SRC)/Replay/IgcReplay.cpp \
 	$(SRC)/Replay/TaskAutoPilot.cpp \
 	$(SRC)/Units/Descriptor.cpp \
@@ -385,6 +425,26 @@ TEST_GEO_CLIP_SOURCES = \
 TEST_GEO_CLIP_DEPENDS = GEO MATH
 $(eval $(call link-program,TestGeoClip,TEST_GEO_CLIP))
 
+TEST_POLYGON_EDGE_INDEX_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestPolygonEdgeIndex.cpp
+TEST_POLYGON_EDGE_INDEX_DEPENDS = GEO MATH
+$(eval $(call link-program,TestPolygonEdgeIndex,TEST_POLYGON_EDGE_INDEX))
+
+TEST_PACKED_RTREE_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestPackedRTree.cpp
+TEST_PACKED_RTREE_DEPENDS = GEO MATH
+$(eval $(call link-program,TestPackedRTree,TEST_PACKED_RTREE))
+
+TEST_AIRSPACE_FILTER_TABLE_SOURCES = \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAirspaceFilterTable.cpp
+TEST_AIRSPACE_FILTER_TABLE_DEPENDS = AIRSPACE GEO MATH UTIL
+$(eval $(call link-program,TestAirspaceFilterTable,TEST_AIRSPACE_FILTER_TABLE))
+
 TEST_CLIMB_AV_CALC_SOURCES = \
 	$(SRC)/Computer/ClimbAverageCalculator.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -577,6 +637,46 @@ TEST_ALLOCATED_GRID_SOURCES = \
 TEST_ALLOCATED_GRID_DEPENDS = UTIL
 $(eval $(call link-program,TestAllocatedGrid,TEST_ALLOCATED_GRID))
 
+TEST_SLOPE_SHADING_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestSlopeShading.cpp
+TEST_SLOPE_SHADING_DEPENDS = MATH
+$(eval $(call link-program,TestSlopeShading,TEST_SLOPE_SHADING))
+
+TEST_RASTER_TILE_CACHE_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestRasterTileCache.cpp
+TEST_RASTER_TILE_CACHE_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,TestRasterTileCache,TEST_RASTER_TILE_CACHE))
+
+TEST_RASTER_MAP_SOURCES = \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestRasterMap.cpp
+TEST_RASTER_MAP_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,TestRasterMap,TEST_RASTER_MAP))
+
+TEST_THREAD_POOL_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestThreadPool.cpp
+TEST_THREAD_POOL_DEPENDS = THREAD
+$(eval $(call link-program,TestThreadPool,TEST_THREAD_POOL))
+
+TEST_OLC_TRIANGLE_SOURCES = \
+	$(SRC)/IGC/IGCParser.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Point.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Trace.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestOLCTriangle.cpp
+TEST_OLC_TRIANGLE_DEPENDS = CONTEST THREAD IO OS GEO MATH UTIL
+$(eval $(call link-program,TestOLCTriangle,TEST_OLC_TRIANGLE))
+
+TEST_SNAPSHOT_BUFFER_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestSnapshotBuffer.cpp
+TEST_SNAPSHOT_BUFFER_DEPENDS = THREAD
+$(eval $(call link-program,TestSnapshotBuffer,TEST_SNAPSHOT_BUFFER))
+
 TEST_RADIX_TREE_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestRadixTree.cpp
@@ -673,6 +773,7 @@ TEST_TRACE_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(SRC)/Engine/Trace/Point.cpp \
 	$(SRC)/Engine/Trace/Trace.cpp \
+	$(SRC)/Engine/Trace/PackedTrace.cpp \
 	$(SRC)/IGC/IGCParser.cpp \
 	$(TEST_SRC_DIR)/FakeTerrain.cpp \
 	$(TEST_SRC_DIR)/Printing.cpp \
@@ -696,7 +797,6 @@ DEBUG_PROGRAM_NAMES = \
 	test_reach \
 	test_route \
 	test_troute \
-	TestTrace \
 	FlightTable \
 	RunTrace \
 	RunOLCAnalysis \
@@ -704,6 +804,11 @@ DEBUG_PROGRAM_NAMES = \
 	FlightPath \
 	BenchmarkProjection \
 	BenchmarkFAITriangleSector \
+	BenchmarkAirspacePolygon \
+	BenchmarkAirspaceSync \
+	BenchmarkAirspaceQueries \
+	BenchmarkAirspaceWarnings \
+	BenchmarkAirspaceCache \
 	DumpTextFile DumpTextZip DumpTextInflate WriteTextFile RunTextWriter \
 	DumpHexColor \
 	RunXMLParser \
@@ -726,6 +831,7 @@ DEBUG_PROGRAM_NAMES = \
 	lxn2igc \
 	RunIGCWriter \
 	RunFlightLogger RunFlyingComputer \
+	RunGlideComputer \
 	RunCirclingWind RunWindEKF RunWindComputer \
 	RunExternalWind \
 	RunTask \
@@ -765,6 +871,7 @@ DEBUG_PROGRAM_NAMES = \
 ifeq ($(TARGET),UNIX)
 DEBUG_PROGRAM_NAMES += \
 	AnalyseFlight \
+	BatchAnalyseFlights \
 	FeedFlyNetData
 endif
 
@@ -795,6 +902,7 @@ DEBUG_REPLAY_SOURCES = \
 	$(SRC)/Device/Util/NMEAReader.cpp \
 	$(SRC)/Device/Config.cpp \
 	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/IGC/IGCMappedReader.cpp \
 	$(SRC)/IGC/Generator.cpp \
 	$(SRC)/Units/Descriptor.cpp \
 	$(SRC)/Units/System.cpp \
@@ -861,6 +969,55 @@ BENCHMARK_FAI_TRIANGLE_SECTOR_SOURCES = \
 BENCHMARK_FAI_TRIANGLE_SECTOR_DEPENDS = GEO MATH
 $(eval $(call link-program,BenchmarkFAITriangleSector,BENCHMARK_FAI_TRIANGLE_SECTOR))
 
+BENCHMARK_AIRSPACE_POLYGON_SOURCES = \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Units/Descriptor.cpp \
+	$(SRC)/Units/System.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/BenchmarkAirspacePolygon.cpp
+BENCHMARK_AIRSPACE_POLYGON_LDADD = $(FAKE_LIBS)
+BENCHMARK_AIRSPACE_POLYGON_DEPENDS = IO OS TIME AIRSPACE ZZIP GEO MATH UTIL
+$(eval $(call link-program,BenchmarkAirspacePolygon,BENCHMARK_AIRSPACE_POLYGON))
+
+BENCHMARK_AIRSPACE_SYNC_SOURCES = \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkAirspaceSync.cpp
+BENCHMARK_AIRSPACE_SYNC_DEPENDS = OS TIME AIRSPACE GEO MATH UTIL
+$(eval $(call link-program,BenchmarkAirspaceSync,BENCHMARK_AIRSPACE_SYNC))
+
+BENCHMARK_AIRSPACE_QUERIES_SOURCES = \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkAirspaceQueries.cpp
+BENCHMARK_AIRSPACE_QUERIES_DEPENDS = OS TIME AIRSPACE GEO MATH UTIL
+$(eval $(call link-program,BenchmarkAirspaceQueries,BENCHMARK_AIRSPACE_QUERIES))
+
+BENCHMARK_AIRSPACE_WARNINGS_SOURCES = \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(SRC)/Engine/Navigation/Aircraft.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkAirspaceWarnings.cpp
+BENCHMARK_AIRSPACE_WARNINGS_DEPENDS = OS TIME AIRSPACE GLIDE GEO MATH UTIL
+$(eval $(call link-program,BenchmarkAirspaceWarnings,BENCHMARK_AIRSPACE_WARNINGS))
+
+BENCHMARK_AIRSPACE_CACHE_SOURCES = \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
+	$(SRC)/Units/Descriptor.cpp \
+	$(SRC)/Units/System.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/BenchmarkAirspaceCache.cpp
+BENCHMARK_AIRSPACE_CACHE_LDADD = $(FAKE_LIBS)
+BENCHMARK_AIRSPACE_CACHE_DEPENDS = IO OS TIME AIRSPACE ZZIP GEO MATH UTIL
+$(eval $(call link-program,BenchmarkAirspaceCache,BENCHMARK_AIRSPACE_CACHE))
+
 DUMP_TEXT_FILE_SOURCES = \
 	$(TEST_SRC_DIR)/DumpTextFile.cpp
 DUMP_TEXT_FILE_DEPENDS = IO OS ZZIP UTIL
@@ -1516,6 +1673,89 @@ RUN_FLYING_COMPUTER_LDADD = $(DEBUG_REPLAY_LDADD)
 RUN_FLYING_COMPUTER_DEPENDS = GEO MATH UTIL TIME
 $(eval $(call link-program,RunFlyingComputer,RUN_FLYING_COMPUTER))
 
+RUN_GLIDE_COMPUTER_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(SRC)/Engine/Util/Gradient.cpp \
+	$(SRC)/Engine/Trace/Point.cpp \
+	$(SRC)/Engine/Trace/Trace.cpp \
+	$(SRC)/Engine/Trace/PackedTrace.cpp \
+	$(SRC)/Engine/Trace/Vector.cpp \
+	$(SRC)/NMEA/Aircraft.cpp \
+	$(SRC)/Task/Deserialiser.cpp \
+	$(SRC)/Task/StateDeserialiser.cpp \
+	$(SRC)/Task/PointStateDeserialiser.cpp \
+	$(SRC)/Task/LoadFile.cpp \
+	$(SRC)/Task/ProtectedTaskManager.cpp \
+	$(SRC)/Task/ProtectedRoutePlanner.cpp \
+	$(SRC)/Task/RoutePlannerGlue.cpp \
+	$(SRC)/Task/TaskFile.cpp \
+	$(SRC)/Task/TaskFileXCSoar.cpp \
+	$(SRC)/Task/TaskFileSeeYou.cpp \
+	$(SRC)/Task/TaskFileIGC.cpp \
+	$(SRC)/Waypoint/WaypointReaderBase.cpp \
+	$(SRC)/Waypoint/WaypointReaderSeeYou.cpp \
+	$(SRC)/Waypoint/Factory.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(SRC)/Atmosphere/CuSonde.cpp \
+	$(SRC)/Computer/Wind/CirclingWind.cpp \
+	$(SRC)/Computer/Wind/Store.cpp \
+	$(SRC)/Computer/Wind/MeasurementList.cpp \
+	$(SRC)/Computer/Wind/WindEKF.cpp \
+	$(SRC)/Computer/Wind/WindEKFGlue.cpp \
+	$(SRC)/Computer/Wind/Computer.cpp \
+	$(SRC)/Computer/Wind/Settings.cpp \
+	$(SRC)/Computer/ThermalLocator.cpp \
+	$(SRC)/Computer/ThermalBase.cpp \
+	$(SRC)/Computer/ThermalBandComputer.cpp \
+	$(SRC)/Computer/GlideRatioCalculator.cpp \
+	$(SRC)/Computer/AutoQNH.cpp \
+	$(SRC)/Computer/CirclingComputer.cpp \
+	$(SRC)/Computer/ContestComputer.cpp \
+	$(SRC)/Computer/TraceComputer.cpp \
+	$(SRC)/Computer/WarningComputer.cpp \
+	$(SRC)/Computer/LiftDatabaseComputer.cpp \
+	$(SRC)/Computer/AverageVarioComputer.cpp \
+	$(SRC)/Computer/GlideRatioComputer.cpp \
+	$(SRC)/Computer/GlideComputer.cpp \
+	$(SRC)/Computer/GlideComputerBlackboard.cpp \
+	$(SRC)/Computer/TaskComputer.cpp \
+	$(SRC)/Computer/RouteComputer.cpp \
+	$(SRC)/Computer/GlideComputerAirData.cpp \
+	$(SRC)/Computer/WaveComputer.cpp \
+	$(SRC)/Computer/StatsComputer.cpp \
+	$(SRC)/Computer/GlideComputerInterface.cpp \
+	$(SRC)/Computer/LogComputer.cpp \
+	$(SRC)/Computer/CuComputer.cpp \
+	$(SRC)/Computer/Settings.cpp \
+	$(SRC)/FlightStatistics.cpp \
+	$(SRC)/Audio/Settings.cpp \
+	$(SRC)/Audio/VarioSettings.cpp \
+	$(SRC)/Audio/VegaVoiceSettings.cpp \
+	$(SRC)/Audio/VegaVoice.cpp \
+	$(SRC)/TeamCode/TeamCode.cpp \
+	$(SRC)/TeamCode/Settings.cpp \
+	$(SRC)/Logger/Settings.cpp \
+	$(SRC)/Tracking/TrackingSettings.cpp \
+	$(SRC)/Airspace/ActivePredicate.cpp \
+	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
+	$(SRC)/Formatter/TimeFormatter.cpp \
+	$(SRC)/Units/Units.cpp \
+	$(SRC)/Units/Settings.cpp \
+	$(SRC)/FilePickAndDownloadSettings.cpp \
+	$(SRC)/Math/SunEphemeris.cpp \
+	$(SRC)/XML/Node.cpp \
+	$(SRC)/XML/Parser.cpp \
+	$(SRC)/XML/DataNode.cpp \
+	$(SRC)/XML/DataNodeXML.cpp \
+	$(TEST_SRC_DIR)/FakeLogFile.cpp \
+	$(TEST_SRC_DIR)/RunGlideComputer.cpp
+RUN_GLIDE_COMPUTER_DEPENDS = \
+	TERRAIN DRIVER CONTEST TASK ROUTE GLIDE WAYPOINT AIRSPACE \
+	IO OS THREAD ZZIP UTIL GEO MATH TIME
+$(eval $(call link-program,RunGlideComputer,RUN_GLIDE_COMPUTER))
+
 RUN_CIRCLING_WIND_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/Formatter/TimeFormatter.cpp \
@@ -1611,7 +1851,7 @@ RUN_OLC_SOURCES = \
 	$(TEST_SRC_DIR)/ContestPrinting.cpp \
 	$(TEST_SRC_DIR)/RunOLCAnalysis.cpp
 RUN_OLC_LDADD = $(DEBUG_REPLAY_LDADD)
-RUN_OLC_DEPENDS = CONTEST UTIL GEO MATH TIME
+RUN_OLC_DEPENDS = CONTEST THREAD UTIL GEO MATH TIME
 $(eval $(call link-program,RunOLCAnalysis,RUN_OLC))
 
 RUN_WAVE_COMPUTER_SOURCES = \
@@ -1649,12 +1889,20 @@ ANALYSE_FLIGHT_SOURCES = \
 	$(TEST_SRC_DIR)/FlightPhaseJSON.cpp \
 	$(TEST_SRC_DIR)/ThermalWriter.cpp \
 	$(TEST_SRC_DIR)/FlightPhaseDetector.cpp \
+	$(TEST_SRC_DIR)/FlightAnalysis.cpp \
 	$(TEST_SRC_DIR)/AnalyseFlight.cpp \
 	$(TEST_SRC_DIR)/FakeLogFile.cpp
 ANALYSE_FLIGHT_LDADD = $(DEBUG_REPLAY_LDADD)
 ANALYSE_FLIGHT_DEPENDS = CONTEST UTIL GEO MATH TIME
 $(eval $(call link-program,AnalyseFlight,ANALYSE_FLIGHT))
 
+BATCH_ANALYSE_FLIGHTS_SOURCES = \
+	$(filter-out %/ThermalWriter.cpp %/AnalyseFlight.cpp,$(ANALYSE_FLIGHT_SOURCES)) \
+	$(TEST_SRC_DIR)/BatchAnalyseFlights.cpp
+BATCH_ANALYSE_FLIGHTS_LDADD = $(DEBUG_REPLAY_LDADD)
+BATCH_ANALYSE_FLIGHTS_DEPENDS = CONTEST THREAD UTIL GEO MATH TIME
+$(eval $(call link-program,BatchAnalyseFlights,BATCH_ANALYSE_FLIGHTS))
+
 FLIGHT_PATH_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/IGC/IGCParser.cpp \
@@ -1704,6 +1952,7 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Engine/Util/Gradient.cpp \
 	$(SRC)/Engine/Trace/Point.cpp \
 	$(SRC)/Engine/Trace/Trace.cpp \
+	$(SRC)/Engine/Trace/PackedTrace.cpp \
 	$(SRC)/Engine/Trace/Vector.cpp \
 	$(SRC)/Engine/Navigation/Aircraft.cpp \
 	$(IO_SRC_DIR)/DataFile.cpp \
@@ -2160,6 +2409,7 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Engine/Util/Gradient.cpp \
 	$(SRC)/Engine/Trace/Point.cpp \
 	$(SRC)/Engine/Trace/Trace.cpp \
+	$(SRC)/Engine/Trace/PackedTrace.cpp \
 	$(SRC)/Engine/Trace/Vector.cpp \
 	$(SRC)/NMEA/Aircraft.cpp \
 	$(SRC)/UIUtil/GestureManager.cpp \
@@ -2276,6 +2526,7 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
 	$(SRC)/Renderer/AirspaceRendererSettings.cpp \
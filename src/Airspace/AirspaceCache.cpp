@@ -0,0 +1,393 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "AirspaceCache.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/FileMapping.hpp"
+
+#include <algorithm>
+#include <memory>
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * The file consists of the header, the airspace file path and one
+ * record per airspace, each followed by its name, its radio
+ * frequency and its polygon points.  Everything is padded to 8
+ * bytes.  The payload may start at any offset within the mapped
+ * FileCache file, so the reader copies each object out of the
+ * mapping instead of accessing it in place.
+ */
+
+struct AirspaceCacheHeader {
+  /**
+   * Increment this when the layout changes.
+   */
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t version;
+  uint32_t tchar_size;
+  uint32_t n_airspaces;
+
+  /** the length of the airspace file path in characters */
+  uint32_t path_length;
+};
+
+struct AirspaceCacheAltitude {
+  double altitude, flight_level, altitude_above_terrain;
+  int8_t reference;
+  uint8_t padding[7];
+};
+
+struct AirspaceCacheRecord {
+  AirspaceCacheAltitude base, top;
+
+  /** the circle's center (radians); unused for polygons */
+  double center_longitude, center_latitude;
+
+  /** the circle's radius (m); unused for polygons */
+  double radius;
+
+  /** the number of polygon points, 0 for circles */
+  uint32_t n_points;
+
+  /** the length of the name and the radio frequency in characters */
+  uint32_t name_length, radio_length;
+
+  uint8_t shape, type, days, padding;
+};
+
+struct AirspaceCachePoint {
+  double longitude, latitude;
+};
+
+static_assert(sizeof(AirspaceCacheHeader) % 8 == 0, "Wrong size");
+static_assert(sizeof(AirspaceCacheAltitude) == 32, "Wrong size");
+static_assert(sizeof(AirspaceCacheRecord) % 8 == 0, "Wrong size");
+
+static constexpr size_t
+Pad(size_t size)
+{
+  return (size + 7) & ~size_t(7);
+}
+
+static bool
+WritePadded(FILE *file, const void *data, size_t size)
+{
+  static constexpr uint8_t zero[8] = { 0 };
+  return fwrite(data, 1, size, file) == size &&
+    fwrite(zero, 1, Pad(size) - size, file) == Pad(size) - size;
+}
+
+static AirspaceCacheAltitude
+ToCache(const AirspaceAltitude &altitude)
+{
+  AirspaceCacheAltitude result;
+  memset(&result, 0, sizeof(result));
+  result.altitude = (double)altitude.altitude;
+  result.flight_level = (double)altitude.flight_level;
+  result.altitude_above_terrain = (double)altitude.altitude_above_terrain;
+  result.reference = (int8_t)altitude.reference;
+  return result;
+}
+
+static bool
+SaveAirspace(FILE *file, const AbstractAirspace &airspace)
+{
+  AirspaceCacheRecord record;
+
+  /* zero-fill all implicit padding bytes */
+  memset(&record, 0, sizeof(record));
+
+  record.base = ToCache(airspace.GetBase());
+  record.top = ToCache(airspace.GetTop());
+
+  const bool circle = airspace.GetShape() == AbstractAirspace::Shape::CIRCLE;
+  if (circle) {
+    const AirspaceCircle &c = (const AirspaceCircle &)airspace;
+    record.center_longitude = (double)c.GetCenter().longitude.Native();
+    record.center_latitude = (double)c.GetCenter().latitude.Native();
+    record.radius = (double)c.GetRadius();
+  } else
+    record.n_points = airspace.GetPoints().size();
+
+  const TCHAR *name = airspace.GetName();
+  const tstring &radio = airspace.GetRadioText();
+  record.name_length = _tcslen(name);
+  record.radio_length = radio.length();
+
+  record.shape = (uint8_t)airspace.GetShape();
+  record.type = airspace.GetType();
+  record.days = airspace.GetDays().GetRawMask();
+
+  if (fwrite(&record, sizeof(record), 1, file) != 1 ||
+      !WritePadded(file, name, record.name_length * sizeof(TCHAR)) ||
+      !WritePadded(file, radio.c_str(), record.radio_length * sizeof(TCHAR)))
+    return false;
+
+  if (!circle) {
+    for (const auto &i : airspace.GetPoints()) {
+      const AirspaceCachePoint point = {
+        (double)i.GetLocation().longitude.Native(),
+        (double)i.GetLocation().latitude.Native(),
+      };
+
+      if (fwrite(&point, sizeof(point), 1, file) != 1)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+bool
+SaveAirspaceCache(FILE *file, const TCHAR *path,
+                  const std::vector<const AbstractAirspace *> &airspaces)
+{
+  AirspaceCacheHeader header;
+  header.version = AirspaceCacheHeader::VERSION;
+  header.tchar_size = sizeof(TCHAR);
+  header.n_airspaces = airspaces.size();
+  header.path_length = _tcslen(path);
+
+  if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+      !WritePadded(file, path, header.path_length * sizeof(TCHAR)))
+    return false;
+
+  for (const auto *i : airspaces)
+    if (!SaveAirspace(file, *i))
+      return false;
+
+  return true;
+}
+
+/**
+ * Sequential, bounds-checked access to the mapped cache file.  The
+ * data may be unaligned, therefore all objects are copied with
+ * memcpy().
+ */
+class AirspaceCacheReader {
+  const uint8_t *p, *const end;
+
+public:
+  AirspaceCacheReader(const void *data, size_t size)
+    :p((const uint8_t *)data), end(p + size) {}
+
+  /**
+   * Returns a pointer to the next n objects of the given size and
+   * skips them (and the padding after them), or nullptr if the file
+   * is too short.  The pointer must not be dereferenced as a T.
+   */
+  const uint8_t *Skip(size_t n, size_t object_size) {
+    const size_t size = Pad(n * object_size);
+    if (size > size_t(end - p))
+      return nullptr;
+
+    const uint8_t *result = p;
+    p += size;
+    return result;
+  }
+
+  template<typename T>
+  bool Read(T &dest) {
+    const uint8_t *src = Skip(1, sizeof(T));
+    if (src == nullptr)
+      return false;
+
+    memcpy(&dest, src, sizeof(T));
+    return true;
+  }
+
+  bool ReadString(size_t length, tstring &dest) {
+    const uint8_t *src = Skip(length, sizeof(TCHAR));
+    if (src == nullptr)
+      return false;
+
+    dest.resize(length);
+    if (length > 0)
+      memcpy(&dest[0], src, length * sizeof(TCHAR));
+    return true;
+  }
+
+  bool IsEnd() const {
+    return p == end;
+  }
+};
+
+static bool
+FromCache(const AirspaceCacheAltitude &src, AirspaceAltitude &dest)
+{
+  if (src.reference < (int8_t)AltitudeReference::NONE ||
+      src.reference > (int8_t)AltitudeReference::STD)
+    return false;
+
+  dest.altitude = fixed(src.altitude);
+  dest.flight_level = fixed(src.flight_level);
+  dest.altitude_above_terrain = fixed(src.altitude_above_terrain);
+  dest.reference = (AltitudeReference)src.reference;
+  return true;
+}
+
+static AbstractAirspace *
+LoadAirspace(AirspaceCacheReader &reader, std::vector<GeoPoint> &points)
+{
+  AirspaceCacheRecord record;
+  if (!reader.Read(record) || record.type >= AIRSPACECLASSCOUNT)
+    return nullptr;
+
+  AirspaceAltitude base, top;
+  if (!FromCache(record.base, base) || !FromCache(record.top, top))
+    return nullptr;
+
+  tstring name, radio;
+  if (!reader.ReadString(record.name_length, name) ||
+      !reader.ReadString(record.radio_length, radio))
+    return nullptr;
+
+  AbstractAirspace *airspace;
+  switch ((AbstractAirspace::Shape)record.shape) {
+  case AbstractAirspace::Shape::CIRCLE:
+    if (record.n_points != 0)
+      return nullptr;
+
+    airspace = new AirspaceCircle(GeoPoint(Angle::Native(fixed(record.center_longitude)),
+                                           Angle::Native(fixed(record.center_latitude))),
+                                  fixed(record.radius));
+    break;
+
+  case AbstractAirspace::Shape::POLYGON: {
+    if (record.n_points < 3)
+      return nullptr;
+
+    const uint8_t *src = reader.Skip(record.n_points,
+                                     sizeof(AirspaceCachePoint));
+    if (src == nullptr)
+      return nullptr;
+
+    points.clear();
+    for (unsigned i = 0; i < record.n_points;
+         ++i, src += sizeof(AirspaceCachePoint)) {
+      AirspaceCachePoint point;
+      memcpy(&point, src, sizeof(point));
+      points.emplace_back(Angle::Native(fixed(point.longitude)),
+                          Angle::Native(fixed(point.latitude)));
+    }
+
+    airspace = new AirspacePolygon(points);
+    break;
+  }
+
+  default:
+    return nullptr;
+  }
+
+  airspace->SetProperties(std::move(name),
+                          (AirspaceClass)record.type, base, top);
+  airspace->SetRadio(radio);
+  airspace->SetDays(AirspaceActivity::FromRawMask(record.days));
+  return airspace;
+}
+
+bool
+LoadAirspaceCache(const void *data, size_t size, const TCHAR *path,
+                  Airspaces &airspaces)
+{
+  AirspaceCacheReader reader(data, size);
+
+  AirspaceCacheHeader header;
+  if (!reader.Read(header) ||
+      header.version != AirspaceCacheHeader::VERSION ||
+      header.tchar_size != sizeof(TCHAR) ||
+      header.path_length != _tcslen(path))
+    return false;
+
+  const uint8_t *cached_path = reader.Skip(header.path_length,
+                                           sizeof(TCHAR));
+  if (cached_path == nullptr ||
+      memcmp(cached_path, path, header.path_length * sizeof(TCHAR)) != 0)
+    return false;
+
+  /* decode everything before adding, so a corrupt file leaves the
+     database unmodified */
+  std::vector<AbstractAirspace *> result;
+  result.reserve(std::min<size_t>(header.n_airspaces,
+                                  size / sizeof(AirspaceCacheRecord)));
+
+  std::vector<GeoPoint> points;
+  for (unsigned i = 0; i < header.n_airspaces; ++i) {
+    AbstractAirspace *airspace = LoadAirspace(reader, points);
+    if (airspace == nullptr)
+      break;
+
+    result.push_back(airspace);
+  }
+
+  if (result.size() != header.n_airspaces || !reader.IsEnd()) {
+    for (auto *i : result)
+      delete i;
+    return false;
+  }
+
+  for (auto *i : result)
+    airspaces.Add(i);
+
+  return true;
+}
+
+bool
+LoadAirspaceCacheFile(FileCache &cache, const TCHAR *cache_name,
+                      const TCHAR *path, Airspaces &airspaces)
+{
+  size_t offset;
+  std::unique_ptr<FileMapping> mapping(cache.Map(cache_name, path, offset));
+  if (!mapping)
+    return false;
+
+  if (!LoadAirspaceCache(mapping->at(offset), mapping->size() - offset,
+                         path, airspaces)) {
+    /* stale or corrupt; discard it, it will be rebuilt */
+    cache.Flush(cache_name);
+    return false;
+  }
+
+  return true;
+}
+
+void
+SaveAirspaceCacheFile(FileCache &cache, const TCHAR *cache_name,
+                      const TCHAR *path,
+                      const std::vector<const AbstractAirspace *> &airspaces)
+{
+  FILE *file = cache.Save(cache_name, path);
+  if (file == nullptr)
+    return;
+
+  if (SaveAirspaceCache(file, path, airspaces))
+    cache.Commit(cache_name, file);
+  else
+    cache.Cancel(cache_name, file);
+}
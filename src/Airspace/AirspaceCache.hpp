@@ -0,0 +1,85 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_AIRSPACE_CACHE_HPP
+#define XCSOAR_AIRSPACE_CACHE_HPP
+
+#include <vector>
+
+#include <tchar.h>
+#include <stddef.h>
+#include <stdio.h>
+
+class Airspaces;
+class AbstractAirspace;
+class FileCache;
+
+/**
+ * Write the airspaces parsed from one file to a binary cache file.
+ * It stores the polygons with all arcs already expanded, so loading
+ * it needs no parsing at all.
+ *
+ * Only the parser is skipped: loading still allocates every airspace
+ * and builds its edge index, and Airspaces::Optimise() still projects
+ * the airspaces and builds the R-tree.  The projection depends on all
+ * loaded files, which are not known when one file is cached.
+ *
+ * @param path the path of the airspace file; it is stored in the
+ * cache and checked by LoadAirspaceCache()
+ * @return false on I/O error
+ */
+bool
+SaveAirspaceCache(FILE *file, const TCHAR *path,
+                  const std::vector<const AbstractAirspace *> &airspaces);
+
+/**
+ * Add the airspaces from a cache file written by SaveAirspaceCache(),
+ * which has been mapped into memory.
+ *
+ * @return false if the data is not a valid cache of the given
+ * airspace file; nothing has been added to #airspaces then
+ */
+bool
+LoadAirspaceCache(const void *data, size_t size, const TCHAR *path,
+                  Airspaces &airspaces);
+
+/**
+ * Map the cache entry of the given airspace file from the #FileCache
+ * and add its airspaces.  A stale or corrupt entry is deleted.
+ *
+ * @return false if there is no valid entry
+ */
+bool
+LoadAirspaceCacheFile(FileCache &cache, const TCHAR *cache_name,
+                      const TCHAR *path, Airspaces &airspaces);
+
+/**
+ * Write the airspaces parsed from the given file to the #FileCache.
+ * Errors are ignored; the file will just be parsed again next time.
+ */
+void
+SaveAirspaceCacheFile(FileCache &cache, const TCHAR *cache_name,
+                      const TCHAR *path,
+                      const std::vector<const AbstractAirspace *> &airspaces);
+
+#endif
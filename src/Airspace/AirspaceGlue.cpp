@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "Airspace/AirspaceGlue.hpp"
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
 #include "Profile/ProfileKeys.hpp"
 #include "Operation/Operation.hpp"
@@ -34,12 +35,14 @@ Copyright_License {
 
 #include <windef.h> /* for MAX_PATH */
 #include <memory>
+#include <vector>
 
 #include <string.h>
 
 static bool
 ParseAirspaceFile(AirspaceParser &parser, const TCHAR *path,
-                  OperationEnvironment &operation)
+                  OperationEnvironment &operation,
+                  std::vector<const AbstractAirspace *> *added)
 {
   std::unique_ptr<TLineReader> reader(OpenTextFile(path, Charset::AUTO));
   if (!reader) {
@@ -47,7 +50,7 @@ ParseAirspaceFile(AirspaceParser &parser, const TCHAR *path,
     return false;
   }
 
-  if (!parser.Parse(*reader, operation)) {
+  if (!parser.Parse(*reader, operation, added)) {
     LogFormat(_T("Failed to parse airspace file: %s"), path);
     return false;
   }
@@ -55,10 +58,35 @@ ParseAirspaceFile(AirspaceParser &parser, const TCHAR *path,
   return true;
 }
 
+/**
+ * Load an airspace file from its cache, or parse it and write the
+ * cache.
+ */
+static bool
+LoadAirspaceFile(AirspaceParser &parser, Airspaces &airspaces,
+                 const TCHAR *path,
+                 FileCache *cache, const TCHAR *cache_name,
+                 OperationEnvironment &operation)
+{
+  if (cache == nullptr)
+    return ParseAirspaceFile(parser, path, operation, nullptr);
+
+  if (LoadAirspaceCacheFile(*cache, cache_name, path, airspaces))
+    return true;
+
+  std::vector<const AbstractAirspace *> added;
+  if (!ParseAirspaceFile(parser, path, operation, &added))
+    return false;
+
+  SaveAirspaceCacheFile(*cache, cache_name, path, added);
+  return true;
+}
+
 void
 ReadAirspace(Airspaces &airspaces,
              RasterTerrain *terrain,
              const AtmosphericPressure &press,
+             FileCache *cache,
              OperationEnvironment &operation)
 {
   LogFormat("ReadAirspace");
@@ -71,14 +99,18 @@ ReadAirspace(Airspaces &airspaces,
   // Read the airspace filenames from the registry
   TCHAR path[MAX_PATH];
   if (Profile::GetPath(ProfileKeys::AirspaceFile, path))
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
+    airspace_ok |= LoadAirspaceFile(parser, airspaces, path,
+                                    cache, _T("airspace"), operation);
 
   if (Profile::GetPath(ProfileKeys::AdditionalAirspaceFile, path))
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
+    airspace_ok |= LoadAirspaceFile(parser, airspaces, path,
+                                    cache, _T("airspace_additional"),
+                                    operation);
 
   if (Profile::GetPath(ProfileKeys::MapFile, path)) {
     _tcscat(path, _T("/airspace.txt"));
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
+    airspace_ok |= LoadAirspaceFile(parser, airspaces, path,
+                                    cache, _T("airspace_map"), operation);
   }
 
   if (airspace_ok) {
@@ -27,15 +27,20 @@ Copyright_License {
 class RasterTerrain;
 class AtmosphericPressure;
 class Airspaces;
+class FileCache;
 class OperationEnvironment;
 
 /**
  * Reads the airspace files into the memory
+ *
+ * @param cache if not nullptr, a binary copy of each parsed file is
+ * kept there and loaded instead of parsing the file again
  */
 void
 ReadAirspace(Airspaces &airspaces,
              RasterTerrain *terrain,
              const AtmosphericPressure &press,
+             FileCache *cache,
              OperationEnvironment &operation);
 
 #endif
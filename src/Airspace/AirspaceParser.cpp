@@ -117,11 +117,14 @@ static constexpr AirspaceClassStringCouple airspace_tnp_type_strings[] = {
 
 struct TempAirspaceType
 {
-  TempAirspaceType() {
+  TempAirspaceType():added(nullptr) {
     points.reserve(256);
     Reset();
   }
 
+  /** receives the new airspaces, see AirspaceParser::Parse() */
+  std::vector<const AbstractAirspace *> *added;
+
   // General
   tstring name;
   tstring radio;
@@ -176,6 +179,9 @@ struct TempAirspaceType
     as->SetRadio(radio);
     as->SetDays(days_of_operation);
     airspace_database.Add(as);
+
+    if (added != nullptr)
+      added->push_back(as);
   }
 
   void
@@ -186,6 +192,9 @@ struct TempAirspaceType
     as->SetRadio(radio);
     as->SetDays(days_of_operation);
     airspace_database.Add(as);
+
+    if (added != nullptr)
+      added->push_back(as);
   }
 
   static int
@@ -882,7 +891,8 @@ DetectFileType(const TCHAR *line)
 }
 
 bool
-AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
+AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation,
+                      std::vector<const AbstractAirspace *> *added)
 {
   bool ignore = false;
 
@@ -892,6 +902,7 @@ AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
   const long file_size = reader.GetSize();
 
   TempAirspaceType temp_area;
+  temp_area.added = added;
   AirspaceFileType filetype = AirspaceFileType::UNKNOWN;
 
   TCHAR *line;
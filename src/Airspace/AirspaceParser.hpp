@@ -24,7 +24,10 @@ Copyright_License {
 #ifndef XCSOAR_AIRSPACE_PARSER_HPP
 #define XCSOAR_AIRSPACE_PARSER_HPP
 
+#include <vector>
+
 class Airspaces;
+class AbstractAirspace;
 class TLineReader;
 class OperationEnvironment;
 
@@ -35,7 +38,14 @@ class AirspaceParser
 public:
   AirspaceParser(Airspaces &_airspaces): airspaces(_airspaces) {}
 
-  bool Parse(TLineReader &reader, OperationEnvironment &operation);
+  /**
+   * Parse an OpenAir or TNP file and add its airspaces.
+   *
+   * @param added if not nullptr, each new airspace is appended to
+   * this list
+   */
+  bool Parse(TLineReader &reader, OperationEnvironment &operation,
+             std::vector<const AbstractAirspace *> *added = nullptr);
 };
 
 #endif
@@ -53,6 +53,9 @@ DeviceBlackboard::DeviceBlackboard()
 
   real_clock.Reset();
   replay_clock.Reset();
+
+  basic_snapshot.Publish(gps_info);
+  calculated_snapshot.Publish(calculated_info);
 }
 
 /**
@@ -205,6 +208,7 @@ void
 DeviceBlackboard::ReadBlackboard(const DerivedInfo &derived_info)
 {
   calculated_info = derived_info;
+  calculated_snapshot.Publish(calculated_info);
 }
 
 /**
@@ -29,6 +29,7 @@ Copyright_License {
 #include "Device/Simulator.hpp"
 #include "Device/Features.hpp"
 #include "Thread/Mutex.hpp"
+#include "Thread/SnapshotBuffer.hpp"
 #include "Time/WrapClock.hpp"
 
 #include <cassert>
@@ -79,6 +80,13 @@ class DeviceBlackboard
    */
   WrapClock real_clock, replay_clock;
 
+  /**
+   * Copies of #gps_info and #calculated_info which can be read
+   * without locking #mutex.
+   */
+  SnapshotBuffer<MoreData> basic_snapshot;
+  SnapshotBuffer<DerivedInfo> calculated_snapshot;
+
 public:
   Mutex mutex;
 
@@ -91,14 +99,42 @@ public:
     devices = &_devices;
   }
 
+  /**
+   * Replace the calculated data and publish it to
+   * GetCalculatedSnapshot().  Caller must lock the blackboard.
+   */
   void ReadBlackboard(const DerivedInfo &derived_info);
   void ReadComputerSettings(const ComputerSettings &settings);
   void ReadSimulatorAirspeeds(const NMEAInfo &basic);
 
+  /**
+   * Lock-free access to the latest basic data published by
+   * PublishBasic().
+   */
+  const SnapshotBuffer<MoreData> &GetBasicSnapshot() const {
+    return basic_snapshot;
+  }
+
+  /**
+   * Lock-free access to the latest calculated data passed to
+   * ReadBlackboard().
+   */
+  const SnapshotBuffer<DerivedInfo> &GetCalculatedSnapshot() const {
+    return calculated_snapshot;
+  }
+
 protected:
   NMEAInfo &SetBasic() { return gps_info; }
   MoreData &SetMoreData() { return gps_info; }
 
+  /**
+   * Publish the current basic data to GetBasicSnapshot().  Caller
+   * must lock the blackboard.
+   */
+  void PublishBasic() {
+    basic_snapshot.Publish(gps_info);
+  }
+
 public:
   const NMEAInfo &RealState(unsigned i) const {
     assert(i < NUMDEV);
@@ -68,12 +68,12 @@ CalculationThread::Tick()
 
   // update and transfer master info to glide computer
   {
-    ScopeLock protect(device_blackboard->mutex);
-
-    gps_updated = device_blackboard->Basic().location_available.Modified(glide_computer.Basic().location_available);
+    const Validity last_location = glide_computer.Basic().location_available;
 
     // Copy data from DeviceBlackboard to GlideComputerBlackboard
-    glide_computer.ReadBlackboard(device_blackboard->Basic());
+    glide_computer.ReadBlackboard(device_blackboard->GetBasicSnapshot());
+
+    gps_updated = glide_computer.Basic().location_available.Modified(last_location);
   }
 
   bool force;
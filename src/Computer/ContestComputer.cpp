@@ -23,13 +23,186 @@ Copyright_License {
 
 #include "ContestComputer.hpp"
 #include "Engine/Contest/Settings.hpp"
+#include "Asset.hpp"
+
+#include <assert.h>
+
+/**
+ * The size of the traces rebuilt for the exact pass.
+ */
+static constexpr unsigned exact_trace_size =
+  HasLittleMemory() ? 1024 : 2048;
+
+/**
+ * The minimum flight time between two exact passes [s].
+ */
+static constexpr unsigned exact_interval = 300;
+
+void
+ContestComputer::TraceMirror::Snapshot()
+{
+  /* if the source was thinned or cleared since the last snapshot,
+     the copy must be rebuilt; otherwise appending the new points is
+     enough */
+  const bool modified = !synced || source.GetModifySerial() != modify_serial;
+  modify_serial = source.GetModifySerial();
+  synced = true;
+
+  /* a pending reset which was not yet picked up by the thread must
+     not get lost */
+  next_reset |= modified;
+  source.GetPoints(next);
+}
+
+bool
+ContestComputer::TraceMirror::Take()
+{
+  points.swap(next);
+  next.clear();
+
+  const bool reset = next_reset;
+  next_reset = false;
+  return reset;
+}
+
+void
+ContestComputer::TraceMirror::Apply(const TracePointVector &v, bool reset)
+{
+  if (reset)
+    copy.clear();
+
+  for (const TracePoint &point : v)
+    if (copy.empty() || copy.back().IsOlderThan(point))
+      copy.push_back(point);
+}
+
+void
+ContestComputer::TraceMirror::SyncDirect()
+{
+  Snapshot();
+  Apply(next, next_reset);
+  next_reset = false;
+}
 
 ContestComputer::ContestComputer(const Trace &trace_full,
                                  const Trace &trace_triangle,
-                                 const Trace &trace_sprint)
-  :contest_manager(Contest::OLC_SPRINT, trace_full, trace_triangle, trace_sprint, true)
+                                 const Trace &trace_sprint,
+                                 const PackedTrace &trace_packed)
+  :StandbyThread("Contest"),
+   full(trace_full), triangle(trace_triangle), sprint(trace_sprint),
+   packed_source(trace_packed),
+   pool(ThreadPool::GetDefaultWorkers(3)),
+   contest_manager(Contest::OLC_SPRINT, full.copy, triangle.copy,
+                   sprint.copy, true),
+   predicted(TracePoint::Invalid()),
+   synchronous_interval(0), synchronous_counter(0),
+   next_handicap(100), next_contest(Contest::OLC_SPRINT),
+   next_predicted(TracePoint::Invalid()), next_exact(false),
+   exact_time(0), exact_contest(Contest::NONE), exact_handicap(0)
 {
   contest_manager.SetIncremental(true);
+  contest_manager.SetExecutor(&pool);
+
+  /* this runs in its own thread, it cannot stall the calculation
+     thread */
+  contest_manager.SetTimeout(0);
+
+  stats.Reset();
+  exact_stats.Reset();
+}
+
+ContestComputer::~ContestComputer()
+{
+  LockStop();
+}
+
+void
+ContestComputer::SetIncremental(bool incremental)
+{
+  const ScopeLock protect(mutex);
+  WaitDone();
+
+  contest_manager.SetIncremental(incremental);
+}
+
+void
+ContestComputer::Reset()
+{
+  const ScopeLock protect(mutex);
+  WaitDone();
+
+  full.Clear();
+  triangle.Clear();
+  sprint.Clear();
+  packed.clear();
+
+  contest_manager.Reset();
+  stats.Reset();
+
+  exact_time = 0;
+  exact_stats.Reset();
+}
+
+inline void
+ContestComputer::Configure(unsigned handicap, Contest contest,
+                           const TracePoint &_predicted)
+{
+  contest_manager.SetHandicap(handicap);
+  contest_manager.SetContest(contest);
+  contest_manager.SetPredicted(_predicted);
+}
+
+void
+ContestComputer::SolveExact(unsigned handicap, Contest contest)
+{
+  assert(!packed.empty());
+
+  /* these are large, but they are needed only for the duration of
+     this pass */
+  Trace exact_full(0, Trace::null_time, exact_trace_size);
+  Trace exact_sprint(0, sprint.copy.GetMaxTime(), exact_trace_size / 2);
+  for (const TracePoint point : packed) {
+    exact_full.push_back(point);
+    exact_sprint.push_back(point);
+  }
+
+  ContestManager manager(contest, exact_full, exact_full, exact_sprint,
+                         true);
+  manager.SetHandicap(handicap);
+  manager.SetTimeout(0);
+  manager.SetExecutor(&pool);
+  manager.SolveExhaustive();
+
+  exact_stats = manager.GetStats();
+  exact_contest = contest;
+  exact_handicap = handicap;
+  exact_time = packed.GetLastTime();
+}
+
+void
+ContestComputer::UpdateExact(unsigned handicap, Contest contest)
+{
+  if (contest != exact_contest || handicap != exact_handicap) {
+    /* the old result is meaningless now */
+    exact_time = 0;
+    exact_stats.Reset();
+  }
+
+  if (packed.empty() ||
+      (exact_time > 0 && packed.GetLastTime() < exact_time + exact_interval))
+    return;
+
+  SolveExact(handicap, contest);
+}
+
+void
+ContestComputer::MergeExact()
+{
+  /* the results of one pass belong together (e.g. OLC+ is derived
+     from the classic and the FAI result), so they are never mixed */
+  const ContestResult &exact = exact_stats.GetResult();
+  if (exact.IsDefined() && exact.score > stats.GetResult().score)
+    stats = exact_stats;
 }
 
 void
@@ -39,12 +212,37 @@ ContestComputer::Solve(const ContestSettings &settings,
   if (!settings.enable)
     return;
 
-  contest_manager.SetHandicap(settings.handicap);
-  contest_manager.SetContest(settings.contest);
+  const ScopeLock protect(mutex);
+
+  contest_stats = stats;
 
-  contest_manager.UpdateIdle();
+  if (synchronous_interval > 0) {
+    if (++synchronous_counter < synchronous_interval)
+      return;
+
+    synchronous_counter = 0;
+  } else if (IsBusy())
+    /* still working on the previous snapshot */
+    return;
 
-  contest_stats = contest_manager.GetStats();
+  full.Snapshot();
+  triangle.Snapshot();
+  sprint.Snapshot();
+
+  next_exact = settings.exact;
+  if (next_exact)
+    packed.Sync(packed_source);
+
+  next_handicap = settings.handicap;
+  next_contest = settings.contest;
+  next_predicted = predicted;
+
+  Trigger();
+
+  if (synchronous_interval > 0) {
+    WaitDone();
+    contest_stats = stats;
+  }
 }
 
 bool
@@ -54,12 +252,61 @@ ContestComputer::SolveExhaustive(const ContestSettings &settings,
   if (!settings.enable)
     return false;
 
-  contest_manager.SetHandicap(settings.handicap);
-  contest_manager.SetContest(settings.contest);
+  const ScopeLock protect(mutex);
+  WaitDone();
+
+  full.SyncDirect();
+  triangle.SyncDirect();
+  sprint.SyncDirect();
+
+  Configure(settings.handicap, settings.contest, predicted);
 
   bool result = contest_manager.SolveExhaustive();
 
-  contest_stats = contest_manager.GetStats();
+  stats = contest_manager.GetStats();
+
+  if (settings.exact) {
+    packed.Sync(packed_source);
+    if (!packed.empty())
+      SolveExact(settings.handicap, settings.contest);
+    MergeExact();
+  }
+
+  contest_stats = stats;
 
   return result;
 }
+
+void
+ContestComputer::Tick()
+{
+  // TODO: call only once
+  SetIdlePriority();
+
+  const bool reset_full = full.Take();
+  const bool reset_triangle = triangle.Take();
+  const bool reset_sprint = sprint.Take();
+
+  const unsigned handicap = next_handicap;
+  const Contest contest = next_contest;
+  const TracePoint _predicted = next_predicted;
+  const bool exact = next_exact;
+
+  mutex.Unlock();
+
+  full.Apply(full.points, reset_full);
+  triangle.Apply(triangle.points, reset_triangle);
+  sprint.Apply(sprint.points, reset_sprint);
+
+  Configure(handicap, contest, _predicted);
+  contest_manager.SolveExhaustive();
+
+  if (exact)
+    UpdateExact(handicap, contest);
+
+  mutex.Lock();
+
+  stats = contest_manager.GetStats();
+  if (exact)
+    MergeExact();
+}
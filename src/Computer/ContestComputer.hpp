@@ -24,40 +24,253 @@ Copyright_License {
 #ifndef XCSOAR_CONTEST_COMPUTER_HPP
 #define XCSOAR_CONTEST_COMPUTER_HPP
 
+#include "Thread/StandbyThread.hpp"
+#include "Thread/ThreadPool.hpp"
 #include "Engine/Contest/ContestManager.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "Engine/Trace/Vector.hpp"
+#include "Engine/Trace/PackedTrace.hpp"
+#include "Util/Serial.hpp"
 
 struct ContestSettings;
 struct ContestStatistics;
-class Trace;
 
-class ContestComputer {
+/**
+ * Runs the contest solvers in a low-priority background thread.
+ *
+ * The solvers work on private copies of the #TraceComputer traces,
+ * which are refreshed from the calculation thread whenever the
+ * background thread has finished a job.  Each job runs the solvers
+ * to completion; its result is picked up by the next Solve() call.
+ *
+ * If ContestSettings::exact is set, a job occasionally rebuilds
+ * larger traces from all recorded fixes (#PackedTrace) and solves
+ * them, too.  These traces exist only during that "exact pass", and
+ * its results replace the regular ones which score lower.
+ */
+class ContestComputer final : private StandbyThread {
+  /**
+   * A private copy of one trace for the solvers.
+   */
+  struct TraceMirror {
+    /**
+     * The original trace; it may only be accessed in the
+     * calculation thread.
+     */
+    const Trace &source;
+
+    /**
+     * The Trace::GetModifySerial() value of #source at the time of
+     * the last snapshot, used only in the calculation thread.
+     */
+    Serial modify_serial;
+
+    /**
+     * Is #modify_serial valid?
+     */
+    bool synced;
+
+    /**
+     * The snapshot for the next job; protected by the mutex.
+     */
+    TracePointVector next;
+
+    /**
+     * Must #copy be cleared before appending #next?
+     */
+    bool next_reset;
+
+    /**
+     * The snapshot being processed by the thread.
+     */
+    TracePointVector points;
+
+    /**
+     * The copy of #source which is analysed by the solvers.
+     */
+    Trace copy;
+
+    explicit TraceMirror(const Trace &_source)
+      :source(_source), synced(false), next_reset(true),
+       copy(source.GetNoThinTime(), source.GetMaxTime(),
+            source.GetMaxSize()) {}
+
+    /**
+     * Copy the source trace into #next.  Called in the calculation
+     * thread; caller must lock the mutex.
+     */
+    void Snapshot();
+
+    /**
+     * Move the snapshot from #next to #points.  Called in the
+     * thread; caller must lock the mutex.
+     *
+     * @return true if #copy must be cleared before applying it
+     */
+    bool Take();
+
+    /**
+     * Apply a snapshot to #copy.
+     */
+    void Apply(const TracePointVector &v, bool reset);
+
+    /**
+     * Bring #copy up to date with #source directly.  Called in the
+     * calculation thread while the background thread is idle.
+     */
+    void SyncDirect();
+
+    void Clear() {
+      synced = false;
+      next_reset = true;
+      next.clear();
+      copy.clear();
+    }
+  };
+
+  TraceMirror full, triangle, sprint;
+
+  /**
+   * The original packed trace; it may only be accessed in the
+   * calculation thread.
+   */
+  const PackedTrace &packed_source;
+
+  /**
+   * A copy of #packed_source for the exact pass.  The calculation
+   * thread updates it only while the thread is idle, holding the
+   * mutex.
+   */
+  PackedTrace packed;
+
+  /**
+   * Runs the independent solvers of a contest and large triangle
+   * searches concurrently; used only by the thread.
+   */
+  ThreadPool pool;
+
+  /**
+   * Operates on the #TraceMirror copies.  It is used by the thread;
+   * the calculation thread may only access it after WaitDone(),
+   * while holding the mutex.
+   */
   ContestManager contest_manager;
 
+  /**
+   * The predicted trace point passed to SetPredicted(), used only in
+   * the calculation thread.
+   */
+  TracePoint predicted;
+
+  /**
+   * If non-zero, then every Nth Solve() call waits for the job it
+   * has started, and the other calls do not start one.  Used only in
+   * the calculation thread.
+   */
+  unsigned synchronous_interval, synchronous_counter;
+
+  /* parameters for the next job; protected by the mutex */
+  unsigned next_handicap;
+  Contest next_contest;
+  TracePoint next_predicted;
+  bool next_exact;
+
+  /**
+   * The time of the last fix which was included in the last exact
+   * pass; used by the thread.
+   */
+  unsigned exact_time;
+
+  /**
+   * The result of the last exact pass and the parameters it was
+   * calculated with; used by the thread.
+   */
+  ContestStatistics exact_stats;
+  Contest exact_contest;
+  unsigned exact_handicap;
+
+  /**
+   * The result of the last job; protected by the mutex.
+   */
+  ContestStatistics stats;
+
 public:
   ContestComputer(const Trace &trace_full,
                   const Trace &trace_triangle,
-                  const Trace &trace_sprint);
+                  const Trace &trace_sprint,
+                  const PackedTrace &trace_packed);
 
-  void SetIncremental(bool incremental) {
-    contest_manager.SetIncremental(incremental);
-  }
+  ~ContestComputer();
+
+  void SetIncremental(bool incremental);
 
-  void Reset() {
-    contest_manager.Reset();
+  /**
+   * Let every Nth Solve() call wait for its job and return its
+   * result; the other calls only return the previous result.  This
+   * makes the results and the time spent in Solve() independent of
+   * thread scheduling, e.g. for replaying a flight in a test program.
+   * Pass 0 to go back to the default, i.e. never wait.
+   */
+  void SetSynchronous(unsigned interval) {
+    synchronous_interval = interval;
+    synchronous_counter = 0;
   }
 
+  void Reset();
+
   /**
    * @see ContestDijkstra::SetPredicted()
    */
-  void SetPredicted(const TracePoint &predicted) {
-    contest_manager.SetPredicted(predicted);
+  void SetPredicted(const TracePoint &_predicted) {
+    predicted = _predicted;
   }
 
+  /**
+   * Copy the latest result to #contest_stats and, if the thread is
+   * idle, start a new job with a snapshot of the traces.  This
+   * method never waits for the solvers, unless SetSynchronous() was
+   * called.
+   */
   void Solve(const ContestSettings &settings_computer,
              ContestStatistics &contest_stats);
 
+  /**
+   * Find the final solution synchronously, in the calling thread.
+   */
   bool SolveExhaustive(const ContestSettings &settings_computer,
                        ContestStatistics &contest_stats);
+
+private:
+  /**
+   * Apply the settings to #contest_manager.  Caller must ensure
+   * exclusive access to it.
+   */
+  void Configure(unsigned handicap, Contest contest,
+                 const TracePoint &_predicted);
+
+  /**
+   * Run an exact pass if enough new fixes have been recorded since
+   * the last one, or if the parameters have changed.  Called in the
+   * thread, without holding the mutex.
+   */
+  void UpdateExact(unsigned handicap, Contest contest);
+
+  /**
+   * Rebuild large traces from #packed, solve them and store the
+   * result in #exact_stats.  The prediction is not used, because the
+   * result is kept for a while.  Caller must ensure exclusive access
+   * to #packed.
+   */
+  void SolveExact(unsigned handicap, Contest contest);
+
+  /**
+   * Replace #stats with the results of the last exact pass if its
+   * best result scores higher.
+   */
+  void MergeExact();
+
+  /* virtual methods from class StandbyThread */
+  void Tick() override;
 };
 
 #endif
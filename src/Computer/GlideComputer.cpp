@@ -22,6 +22,7 @@ Copyright_License {
 */
 
 #include "GlideComputer.hpp"
+#include "StageTimes.hpp"
 #include "Computer/Settings.hpp"
 #include "NMEA/Derived.hpp"
 #include "ConditionMonitor/ConditionMonitors.hpp"
@@ -31,7 +32,6 @@ Copyright_License {
 #include "Waypoint/FlarmGlue.hpp"
 #include "Components.hpp"
 
-static PeriodClock last_team_code_update;
 static GeoPoint last_teammate_task;
 static TaskType last_teammate_task_type;
 static bool last_teammate_flarm_current;
@@ -49,7 +49,8 @@ GlideComputer::GlideComputer(const Waypoints &_way_points,
   task_computer(task, _airspace_database, &warning_computer.GetManager()),
   waypoints(_way_points),
   retrospective(_way_points),
-  team_code_ref_id(-1)
+  team_code_ref_id(-1),
+  stage_times(nullptr)
 {
   events.SetComputer(*this);
   idle_clock.Update();
@@ -73,6 +74,7 @@ GlideComputer::ResetFlight(const bool full)
   warning_computer.Reset();
 
   trace_history_time.Reset();
+  team_code_clock.Reset();
 }
 
 /**
@@ -114,8 +116,11 @@ GlideComputer::ProcessGPS(bool force)
   calculated.Expire(basic.clock);
 
   // Process basic information
-  air_data_computer.ProcessBasic(Basic(), SetCalculated(),
-                                 GetComputerSettings());
+  {
+    const ScopeStageTimer timer(stage_times, GlideComputerStage::AIR_DATA);
+    air_data_computer.ProcessBasic(Basic(), SetCalculated(),
+                                   GetComputerSettings());
+  }
 
   // Process basic task information
   const bool last_finished = calculated.ordered_task_stats.task_finished;
@@ -130,19 +135,30 @@ GlideComputer::ProcessGPS(bool force)
     OnFinishTask();
 
   // Check if everything is okay with the gps time and process it
-  air_data_computer.FlightTimes(Basic(), SetCalculated(),
-                                GetComputerSettings());
+  {
+    const ScopeStageTimer timer(stage_times, GlideComputerStage::AIR_DATA);
+    air_data_computer.FlightTimes(Basic(), SetCalculated(),
+                                  GetComputerSettings());
+  }
 
   TakeoffLanding(last_flying);
 
   task_computer.ProcessAutoTask(basic, calculated);
 
   // Process extended information
-  air_data_computer.ProcessVertical(Basic(),
-                                    SetCalculated(),
-                                    GetComputerSettings());
+  {
+    const ScopeStageTimer timer(stage_times, GlideComputerStage::VERTICAL);
+    air_data_computer.ProcessVertical(Basic(),
+                                      SetCalculated(),
+                                      GetComputerSettings());
+  }
+
+  {
+    const ScopeStageTimer timer(stage_times, GlideComputerStage::STATS);
+    stats_computer.ProcessClimbEvents(calculated);
+  }
 
-  stats_computer.ProcessClimbEvents(calculated);
+  const ScopeStageTimer timer(stage_times, GlideComputerStage::OTHER);
 
   // Calculate the team code
   CalculateOwnTeamCode();
@@ -180,18 +196,27 @@ GlideComputer::ProcessIdle(bool exhaustive)
 
   // Log GPS fixes for internal usage
   // (snail trail, stats, olc, ...)
-  stats_computer.DoLogging(basic, calculated);
-  log_computer.Run(basic, calculated, GetComputerSettings().logger);
+  {
+    const ScopeStageTimer timer(stage_times, GlideComputerStage::LOGGING);
+    stats_computer.DoLogging(basic, calculated);
+    log_computer.Run(basic, calculated, GetComputerSettings().logger);
+  }
 
   task_computer.ProcessIdle(basic, calculated, GetComputerSettings(),
                             exhaustive);
 
-  warning_computer.Update(GetComputerSettings(), basic,
-                          calculated, calculated.airspace_warnings);
+  {
+    const ScopeStageTimer timer(stage_times, GlideComputerStage::WARNINGS);
+    warning_computer.Update(GetComputerSettings(), basic,
+                            calculated, calculated.airspace_warnings);
+  }
 
   // Calculate summary of flight
-  if (basic.location_available)
+  if (basic.location_available) {
+    const ScopeStageTimer timer(stage_times,
+                                GlideComputerStage::RETROSPECTIVE);
     retrospective.UpdateSample(basic.location);
+  }
 }
 
 bool
@@ -225,7 +250,8 @@ GlideComputer::CalculateOwnTeamCode()
     return;
 
   // Only calculate every 10sec otherwise cancel calculation
-  if (!last_team_code_update.CheckUpdate(10000))
+  if (!Basic().time_available ||
+      !team_code_clock.CheckAdvance(Basic().time, fixed(10)))
     return;
 
   // Get bearing and distance to the reference waypoint
@@ -27,6 +27,7 @@ Copyright_License {
 #include "GlideComputerBlackboard.hpp"
 #include "Audio/VegaVoice.hpp"
 #include "Time/PeriodClock.hpp"
+#include "Time/GPSClock.hpp"
 #include "Time/DeltaTime.hpp"
 #include "GlideComputerAirData.hpp"
 #include "StatsComputer.hpp"
@@ -41,6 +42,7 @@ class Waypoints;
 class ProtectedTaskManager;
 class GlideComputerTaskEvents;
 class RasterTerrain;
+struct GlideComputerStageTimes;
 
 // TODO: replace copy constructors so copies of these structures
 // do not replicate the large items or items that should be singletons
@@ -62,6 +64,12 @@ class GlideComputer : public GlideComputerBlackboard
   bool team_code_ref_found;
   GeoPoint team_code_ref_location;
 
+  /**
+   * Limits the own team code calculation to every 10 seconds of GPS
+   * time.
+   */
+  GPSClock team_code_clock;
+
   PeriodClock idle_clock;
   VegaVoice vegavoice;
 
@@ -71,6 +79,8 @@ class GlideComputer : public GlideComputerBlackboard
    */
   DeltaTime trace_history_time;
 
+  GlideComputerStageTimes *stage_times;
+
 public:
   GlideComputer(const Waypoints &_way_points,
                 Airspaces &_airspace_database,
@@ -149,6 +159,23 @@ public:
     task_computer.SetContestIncremental(incremental);
   }
 
+  /**
+   * @see ContestComputer::SetSynchronous()
+   */
+  void SetContestSynchronous(unsigned interval) {
+    task_computer.SetContestSynchronous(interval);
+  }
+
+  /**
+   * Install a #GlideComputerStageTimes instance which accumulates the
+   * time spent in each stage of ProcessGPS() and ProcessIdle().  Pass
+   * nullptr to disable the measurements (the default).
+   */
+  void SetStageTimes(GlideComputerStageTimes *_stage_times) {
+    stage_times = _stage_times;
+    task_computer.SetStageTimes(_stage_times);
+  }
+
 protected:
   void OnTakeoff();
   void OnLanding();
@@ -27,6 +27,8 @@ Copyright_License {
 #include "Blackboard/BaseBlackboard.hpp"
 #include "Blackboard/ComputerSettingsBlackboard.hpp"
 
+template<typename T> class SnapshotBuffer;
+
 /**
  * Blackboard class used by glide computer (calculation) thread.
  * Can only write DERIVED_INFO
@@ -39,6 +41,7 @@ class GlideComputerBlackboard:
 
 public:
   void ReadBlackboard(const MoreData &nmea_info);
+  void ReadBlackboard(const SnapshotBuffer<MoreData> &nmea_info);
   void ReadComputerSettings(const ComputerSettings &settings);
 
 protected:
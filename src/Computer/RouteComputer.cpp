@@ -34,14 +34,21 @@ Copyright_License {
 RouteComputer::RouteComputer(const Airspaces &airspace_database,
                              const ProtectedAirspaceWarningManager *warnings)
   :protected_route_planner(route_planner, airspace_database, warnings),
+   reach_pool(ThreadPool::GetDefaultWorkers(3)),
+   last_reach_solved(false),
+   last_reach_ceiling(0),
    terrain(NULL)
-{}
+{
+  last_reach_config.SetDefaults();
+  route_planner.SetExecutor(&reach_pool);
+}
 
 void
 RouteComputer::ResetFlight()
 {
   route_clock.Reset();
   reach_clock.Reset();
+  reach_age_clock.Reset();
   protected_route_planner.Reset();
 
   last_task_type = TaskType::NONE;
@@ -124,6 +131,23 @@ RouteComputer::TerrainWarning(const MoreData &basic,
   calculated.terrain_warning = false;
 }
 
+/**
+ * Would the reach fan change if it was solved with the other settings?
+ */
+gcc_pure
+static bool
+IsReachConfigChanged(const RoutePlannerConfig &a, RoughAltitude a_ceiling,
+                     const RoutePlannerConfig &b, RoughAltitude b_ceiling)
+{
+  return a.safety_height_terrain != b.safety_height_terrain ||
+    a.reach_calc_mode != b.reach_calc_mode ||
+    a.reach_polar_mode != b.reach_polar_mode ||
+    a.allow_climb != b.allow_climb ||
+    a.use_ceiling != b.use_ceiling ||
+    /* the ceiling is ignored unless enabled */
+    (a.use_ceiling && a_ceiling != b_ceiling);
+}
+
 inline void
 RouteComputer::Reach(const MoreData &basic, DerivedInfo &calculated,
                      const RoutePlannerConfig &config)
@@ -143,7 +167,24 @@ RouteComputer::Reach(const MoreData &basic, DerivedInfo &calculated,
   const RoughAltitude h_ceiling((short)std::max((int)basic.nav_altitude + 500,
                                                 (int)calculated.thermal_band.working_band_ceiling));
 
-  if (reach_clock.CheckAdvance(basic.time, PERIOD)) {
+  if (!reach_clock.CheckAdvance(basic.time, REACH_PERIOD))
+    return;
+
+  /* only recalculate if the old solution has become too
+     inaccurate, because the aircraft has moved or its glide range
+     has changed */
+  const bool expired = reach_age_clock.CheckAdvance(basic.time, REACH_MAX_AGE);
+  if (expired || do_solve != last_reach_solved ||
+      IsReachConfigChanged(config, h_ceiling,
+                           last_reach_config, last_reach_ceiling) ||
+      route_planner.IsReachEmpty() ||
+      route_planner.GetReachStaleness(start) > fixed(REACH_MAX_STALENESS)) {
+    if (!expired)
+      reach_age_clock.Update(basic.time);
+
+    last_reach_solved = do_solve;
+    last_reach_config = config;
+    last_reach_ceiling = h_ceiling;
     protected_route_planner.SolveReach(start, config, h_ceiling, do_solve);
 
     if (do_solve) {
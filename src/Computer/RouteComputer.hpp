@@ -28,6 +28,7 @@ Copyright_License {
 #include "Engine/Task/TaskType.hpp"
 #include "Engine/Route/RoutePlanner.hpp"
 #include "Time/GPSClock.hpp"
+#include "Thread/ThreadPool.hpp"
 
 struct MoreData;
 struct DerivedInfo;
@@ -40,12 +41,60 @@ class GlidePolar;
 class RouteComputer {
   static constexpr unsigned PERIOD = 5;
 
+  /**
+   * How often (in seconds) to check whether the reach needs to be
+   * recalculated.
+   *
+   * This only throttles the reach calculation: the fan is never
+   * updated incrementally.  It is either reused unchanged, or solved
+   * again from scratch when it is stale (see REACH_MAX_STALENESS),
+   * too old (see REACH_MAX_AGE), or was solved with different
+   * settings.
+   */
+  static constexpr unsigned REACH_PERIOD = 1;
+
+  /**
+   * The reach is recalculated at least this often (in seconds), to
+   * pick up terrain effects which are not covered by
+   * ReachFan::GetStaleness().
+   */
+  static constexpr unsigned REACH_MAX_AGE = 30;
+
+  /**
+   * Recalculate the reach when the old solution may be off by more
+   * than this distance [m].
+   */
+  static constexpr unsigned REACH_MAX_STALENESS = 500;
+
   RoutePlannerGlue route_planner;
   ProtectedRoutePlanner protected_route_planner;
 
+  /**
+   * Calculates the reach fan directions concurrently.
+   */
+  ThreadPool reach_pool;
+
   GPSClock route_clock;
   GPSClock reach_clock;
 
+  /**
+   * Tracks the age of the current reach solution.
+   */
+  GPSClock reach_age_clock;
+
+  /**
+   * The "do_solve" flag of the current reach solution.
+   */
+  bool last_reach_solved;
+
+  /**
+   * The settings of the current reach solution.  ReachFan::GetStaleness()
+   * does not see changes of the safety height, the reach mode or the
+   * ceiling, so any change forces a new solution.
+   */
+  RoutePlannerConfig last_reach_config;
+  RoughAltitude last_reach_ceiling;
+
   const RasterTerrain *terrain;
 
   TaskType last_task_type;
@@ -0,0 +1,140 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GLIDE_COMPUTER_STAGE_TIMES_HPP
+#define XCSOAR_GLIDE_COMPUTER_STAGE_TIMES_HPP
+
+#include "OS/Clock.hpp"
+#include "Compiler.h"
+
+#include <algorithm>
+
+#include <stdint.h>
+
+/**
+ * The parts of the #GlideComputer pipeline which can be timed
+ * separately.
+ */
+enum class GlideComputerStage : uint8_t {
+  /* GlideComputer::ProcessGPS() */
+  AIR_DATA,
+  TRACE,
+  TASK,
+  ROUTE,
+  VERTICAL,
+  STATS,
+  OTHER,
+
+  /* GlideComputer::ProcessIdle() */
+  LOGGING,
+  CONTEST,
+  TASK_IDLE,
+  WARNINGS,
+  RETROSPECTIVE,
+
+  COUNT
+};
+
+/**
+ * Accumulates the wall clock time spent in each #GlideComputerStage.
+ * This is meant for benchmark and profiling tools; the
+ * #GlideComputer does not measure anything unless an instance has
+ * been installed with GlideComputer::SetStageTimes().
+ */
+struct GlideComputerStageTimes {
+  static constexpr unsigned N = unsigned(GlideComputerStage::COUNT);
+
+  /**
+   * Accumulated duration of each stage [us].
+   */
+  uint64_t duration[N];
+
+  /**
+   * Number of times each stage has been run.
+   */
+  unsigned count[N];
+
+  void Clear() {
+    std::fill_n(duration, N, 0);
+    std::fill_n(count, N, 0);
+  }
+
+  void Add(GlideComputerStage stage, uint64_t us) {
+    duration[unsigned(stage)] += us;
+    ++count[unsigned(stage)];
+  }
+
+  uint64_t GetDuration(GlideComputerStage stage) const {
+    return duration[unsigned(stage)];
+  }
+
+  unsigned GetCount(GlideComputerStage stage) const {
+    return count[unsigned(stage)];
+  }
+
+  gcc_const
+  static const char *GetName(GlideComputerStage stage) {
+    switch (stage) {
+    case GlideComputerStage::AIR_DATA: return "air_data";
+    case GlideComputerStage::TRACE: return "trace";
+    case GlideComputerStage::TASK: return "task";
+    case GlideComputerStage::ROUTE: return "route";
+    case GlideComputerStage::VERTICAL: return "vertical";
+    case GlideComputerStage::STATS: return "stats";
+    case GlideComputerStage::OTHER: return "other";
+    case GlideComputerStage::LOGGING: return "logging";
+    case GlideComputerStage::CONTEST: return "contest";
+    case GlideComputerStage::TASK_IDLE: return "task_idle";
+    case GlideComputerStage::WARNINGS: return "warnings";
+    case GlideComputerStage::RETROSPECTIVE: return "retrospective";
+    case GlideComputerStage::COUNT: break;
+    }
+
+    return nullptr;
+  }
+};
+
+/**
+ * Adds the lifetime of this object to a #GlideComputerStageTimes
+ * instance.  Does nothing if the pointer is nullptr.
+ */
+class ScopeStageTimer {
+  GlideComputerStageTimes *const times;
+  const GlideComputerStage stage;
+  const uint64_t start;
+
+public:
+  ScopeStageTimer(GlideComputerStageTimes *_times, GlideComputerStage _stage)
+    :times(_times), stage(_stage),
+     start(times != nullptr ? MonotonicClockUS() : 0) {}
+
+  ~ScopeStageTimer() {
+    if (times != nullptr)
+      times->Add(stage, MonotonicClockUS() - start);
+  }
+
+  ScopeStageTimer(const ScopeStageTimer &) = delete;
+  ScopeStageTimer &operator=(const ScopeStageTimer &) = delete;
+};
+
+#endif
@@ -23,6 +23,7 @@ Copyright_License {
 */
 
 #include "TaskComputer.hpp"
+#include "StageTimes.hpp"
 #include "Task/ProtectedTaskManager.hpp"
 #include "Engine/Task/Ordered/OrderedTask.hpp"
 #include "NMEA/Aircraft.hpp"
@@ -43,7 +44,9 @@ TaskComputer::TaskComputer(ProtectedTaskManager &_task,
                            const ProtectedAirspaceWarningManager *warnings)
   :task(_task),
    route(airspace_database, warnings),
-   contest(trace.GetFull(), trace.GetContest(), trace.GetSprint())
+   contest(trace.GetFull(), trace.GetContest(), trace.GetSprint(),
+           trace.GetPacked()),
+   stage_times(nullptr)
 {
   task.SetRoutePlanner(&route.GetRoutePlanner());
 }
@@ -76,7 +79,12 @@ TaskComputer::ProcessBasicTask(const MoreData &basic,
                                const ComputerSettings &settings_computer,
                                bool force)
 {
-  trace.Update(settings_computer, basic, calculated);
+  {
+    const ScopeStageTimer timer(stage_times, GlideComputerStage::TRACE);
+    trace.Update(settings_computer, basic, calculated);
+  }
+
+  const ScopeStageTimer timer(stage_times, GlideComputerStage::TASK);
 
   ProtectedTaskManager::ExclusiveLease _task(task);
 
@@ -117,10 +125,13 @@ TaskComputer::ProcessMoreTask(const MoreData &basic,
   const GlidePolar &glide_polar = settings_computer.polar.glide_polar_task;
   const GlidePolar &safety_polar = calculated.glide_polar_safety;
 
-  route.ProcessRoute(basic, calculated,
-                     settings_computer.task.glide,
-                     settings_computer.task.route_planner,
-                     glide_polar, safety_polar);
+  {
+    const ScopeStageTimer timer(stage_times, GlideComputerStage::ROUTE);
+    route.ProcessRoute(basic, calculated,
+                       settings_computer.task.glide,
+                       settings_computer.task.route_planner,
+                       glide_polar, safety_polar);
+  }
 
   if (settings_computer.features.block_stf_enabled)
     calculated.V_stf = calculated.common_stats.V_block;
@@ -158,14 +169,20 @@ TaskComputer::ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
                           const ComputerSettings &settings_computer,
                           bool exhaustive)
 {
-  contest.SetPredicted(Predicted(settings_computer.contest, basic,
-                                 calculated.task_stats.current_leg));
+  {
+    const ScopeStageTimer timer(stage_times, GlideComputerStage::CONTEST);
 
-  if (exhaustive)
-    contest.SolveExhaustive(settings_computer.contest,
-                            calculated.contest_stats);
-  else
-    contest.Solve(settings_computer.contest, calculated.contest_stats);
+    contest.SetPredicted(Predicted(settings_computer.contest, basic,
+                                   calculated.task_stats.current_leg));
+
+    if (exhaustive)
+      contest.SolveExhaustive(settings_computer.contest,
+                              calculated.contest_stats);
+    else
+      contest.Solve(settings_computer.contest, calculated.contest_stats);
+  }
+
+  const ScopeStageTimer timer(stage_times, GlideComputerStage::TASK_IDLE);
 
   const AircraftState as = ToAircraftState(basic, calculated);
 
@@ -193,6 +210,8 @@ TaskComputer::ProcessAutoTask(const NMEAInfo &basic,
       calculated.altitude_agl > fixed(500))
     return;
 
+  const ScopeStageTimer timer(stage_times, GlideComputerStage::TASK);
+
   ProtectedTaskManager::ExclusiveLease _task(task);
   _task->TakeoffAutotask(calculated.flight.takeoff_location,
                          calculated.terrain_altitude);
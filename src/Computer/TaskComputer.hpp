@@ -31,6 +31,7 @@ Copyright_License {
 #include "NMEA/Validity.hpp"
 
 struct NMEAInfo;
+struct GlideComputerStageTimes;
 class ProtectedTaskManager;
 class ProtectedAirspaceWarningManager;
 
@@ -51,6 +52,8 @@ class TaskComputer
 
   Validity last_location_available;
 
+  GlideComputerStageTimes *stage_times;
+
 public:
   TaskComputer(ProtectedTaskManager &_task,
                const Airspaces &airspace_database,
@@ -109,6 +112,19 @@ public:
     contest.SetIncremental(incremental);
   }
 
+  void SetContestSynchronous(unsigned interval) {
+    contest.SetSynchronous(interval);
+  }
+
+  /**
+   * Install a #GlideComputerStageTimes instance which accumulates the
+   * time spent in the trace, task, route and contest calculations.
+   * Pass nullptr to disable the measurements.
+   */
+  void SetStageTimes(GlideComputerStageTimes *_stage_times) {
+    stage_times = _stage_times;
+  }
+
   /**
    * Auto-create a task on takeoff that leads back home.
    */
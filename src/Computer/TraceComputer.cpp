@@ -55,6 +55,7 @@ TraceComputer::Reset()
 
   contest.clear();
   sprint.clear();
+  packed.clear();
 }
 
 void
@@ -96,5 +97,9 @@ TraceComputer::Update(const ComputerSettings &settings_computer,
   if (settings_computer.contest.enable) {
     sprint.push_back(point);
     contest.push_back(point);
+
+    // only the exact pass reads all fixes
+    if (settings_computer.contest.exact)
+      packed.push_back(point);
   }
 }
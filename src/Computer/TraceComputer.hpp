@@ -26,6 +26,7 @@ Copyright_License {
 
 #include "Thread/Mutex.hpp"
 #include "Engine/Trace/Trace.hpp"
+#include "Engine/Trace/PackedTrace.hpp"
 
 struct ComputerSettings;
 struct MoreData;
@@ -44,6 +45,12 @@ class TraceComputer {
 
   Trace full, contest, sprint;
 
+  /**
+   * All fixes used for the contest, without thinning.  Filled only
+   * if ContestSettings::exact is enabled.
+   */
+  PackedTrace packed;
+
 public:
   TraceComputer();
 
@@ -79,6 +86,14 @@ public:
     return sprint;
   }
 
+  /**
+   * Returns an unprotected reference to the packed contest trace.
+   * This object may be used only inside the #CalculationThread.
+   */
+  const PackedTrace &GetPacked() const {
+    return packed;
+  }
+
   void Reset();
 
   /**
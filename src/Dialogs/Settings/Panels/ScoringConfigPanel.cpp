@@ -35,6 +35,7 @@ Copyright_License {
 enum ControlIndex {
   Contests,
   PREDICT_CONTEST,
+  EXACT_CONTEST,
   SPACER,
   SHOW_FAI_TRIANGLE_AREAS,
   FAI_TRIANGLE_THRESHOLD,
@@ -126,6 +127,14 @@ ScoringConfigPanel::Prepare(ContainerWindow &parent, const PixelRect &rc)
                "score calculation, assuming that you will reach it."),
              contest_settings.predict);
 
+  AddBoolean(_("Exact Contest"),
+             _("If enabled, then the score is recalculated from time to "
+               "time on a more detailed trace of the whole flight.  This "
+               "gets closer to the official score, but needs more CPU "
+               "time."),
+             contest_settings.exact);
+  SetExpertRow(EXACT_CONTEST);
+
   AddSpacer();
   SetExpertRow(SPACER);
 
@@ -156,6 +165,8 @@ ScoringConfigPanel::Save(bool &_changed)
                            contest_settings.contest);
   changed |= SaveValueEnum(PREDICT_CONTEST, ProfileKeys::PredictContest,
                            contest_settings.predict);
+  changed |= SaveValue(EXACT_CONTEST, ProfileKeys::ExactContest,
+                       contest_settings.exact);
 
   changed |= SaveValue(SHOW_FAI_TRIANGLE_AREAS,
                        ProfileKeys::ShowFAITriangleAreas,
@@ -231,6 +231,13 @@ public:
     days_of_operation = mask;
   }
 
+  /**
+   * Get the days of operation
+   */
+  AirspaceActivity GetDays() const {
+    return days_of_operation;
+  }
+
   /**
    * Get type of airspace
    *
@@ -364,7 +371,7 @@ public:
 
 protected:
   /** Project border */
-  void Project(const FlatProjection &tp);
+  virtual void Project(const FlatProjection &tp);
 
 private:
   /**
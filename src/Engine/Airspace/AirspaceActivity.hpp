@@ -103,6 +103,19 @@ public:
   bool Matches(AirspaceActivity _mask) const {
     return mask.value & _mask.mask.value;
   }
+
+  /**
+   * The raw bit mask, for storing in a file.
+   */
+  unsigned char GetRawMask() const {
+    return mask.value;
+  }
+
+  static AirspaceActivity FromRawMask(unsigned char value) {
+    AirspaceActivity activity;
+    activity.mask.value = value;
+    return activity;
+  }
 };
 
 static_assert(sizeof(AirspaceActivity) == 1, "Wrong size");
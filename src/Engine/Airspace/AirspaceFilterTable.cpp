@@ -0,0 +1,201 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "AirspaceFilterTable.hpp"
+#include "AbstractAirspace.hpp"
+#include "Navigation/Aircraft.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <assert.h>
+
+AirspaceFilterTable::Query
+AirspaceFilterTable::Query::Inside(const FlatBoundingBox &box,
+                                   const AltitudeState &state)
+{
+  Query query;
+  query.box = box;
+  query.terrain_offset = state.altitude - state.altitude_agl;
+  query.base_max = state.altitude;
+  query.base_always_below = BASE_TERRAIN;
+  query.top_min = state.altitude;
+  query.required = PRESENT;
+  return query;
+}
+
+AirspaceFilterTable::Query
+AirspaceFilterTable::Query::Below(const FlatBoundingBox &box,
+                                  const AltitudeState &state, fixed ceiling)
+{
+  Query query;
+  query.box = box;
+  query.terrain_offset = state.altitude - state.altitude_agl;
+  query.base_max = ceiling;
+  query.base_always_below = 0;
+  /* lower than any airspace top */
+  query.top_min = fixed(-1000000);
+  query.required = PRESENT | ACTIVE;
+  return query;
+}
+
+void
+AirspaceFilterTable::Clear()
+{
+  min_x.clear();
+  min_y.clear();
+  max_x.clear();
+  max_y.clear();
+  base.clear();
+  top.clear();
+  flags.clear();
+}
+
+void
+AirspaceFilterTable::Build(const AirspacesInterface::AirspaceTree &tree)
+{
+  Clear();
+
+  const unsigned n = tree.GetSlotCount();
+  min_x.reserve(n);
+  min_y.reserve(n);
+  max_x.reserve(n);
+  max_y.reserve(n);
+  base.reserve(n);
+  top.reserve(n);
+  flags.reserve(n);
+
+  for (unsigned i = 0; i < n; ++i) {
+    const Airspace &envelope = tree.GetSlot(i);
+    min_x.push_back(envelope.GetLowerLeft().longitude);
+    min_y.push_back(envelope.GetLowerLeft().latitude);
+    max_x.push_back(envelope.GetUpperRight().longitude);
+    max_y.push_back(envelope.GetUpperRight().latitude);
+
+    const AbstractAirspace &airspace = envelope.GetAirspace();
+    const AirspaceAltitude &b = airspace.GetBase();
+    const AirspaceAltitude &t = airspace.GetTop();
+
+    uint8_t f = 0;
+    if (!tree.IsRemoved(i))
+      f |= PRESENT;
+    if (airspace.IsActive())
+      f |= ACTIVE;
+
+    if (b.reference == AltitudeReference::AGL) {
+      f |= BASE_AGL;
+      base.push_back(b.altitude_above_terrain);
+    } else
+      base.push_back(b.altitude);
+
+    if (t.reference == AltitudeReference::AGL) {
+      f |= TOP_AGL;
+      top.push_back(t.altitude_above_terrain);
+    } else
+      top.push_back(t.altitude);
+
+    if (b.IsTerrain())
+      f |= BASE_TERRAIN;
+
+    flags.push_back(f);
+  }
+}
+
+inline bool
+AirspaceFilterTable::MatchesAltitude(const Query &query, unsigned i) const
+{
+  const uint8_t f = flags[i];
+
+  const fixed b = f & BASE_AGL ? base[i] + query.terrain_offset : base[i];
+  const fixed t = f & TOP_AGL ? top[i] + query.terrain_offset : top[i];
+
+  return (f & query.required) == query.required &&
+    (b <= query.base_max || (f & query.base_always_below) != 0) &&
+    t >= query.top_min;
+}
+
+inline bool
+AirspaceFilterTable::Matches(const Query &query, unsigned i) const
+{
+  return min_x[i] <= query.box.GetUpperRight().longitude &&
+    max_x[i] >= query.box.GetLowerLeft().longitude &&
+    min_y[i] <= query.box.GetUpperRight().latitude &&
+    max_y[i] >= query.box.GetLowerLeft().latitude &&
+    MatchesAltitude(query, i);
+}
+
+unsigned
+AirspaceFilterTable::Scan(const Query &query, unsigned first, unsigned last,
+                          unsigned *dest) const
+{
+  assert(first <= last);
+  assert(last <= size());
+
+  unsigned n = 0;
+
+#ifdef __SSE2__
+  /* compare four bounding boxes at a time; the altitudes are only
+     looked at for those which overlap the query box */
+  const __m128i box_min_x =
+    _mm_set1_epi32(query.box.GetLowerLeft().longitude);
+  const __m128i box_min_y =
+    _mm_set1_epi32(query.box.GetLowerLeft().latitude);
+  const __m128i box_max_x =
+    _mm_set1_epi32(query.box.GetUpperRight().longitude);
+  const __m128i box_max_y =
+    _mm_set1_epi32(query.box.GetUpperRight().latitude);
+
+  for (; first + 4 <= last; first += 4) {
+    const __m128i a_min_x =
+      _mm_loadu_si128((const __m128i *)&min_x[first]);
+    const __m128i a_min_y =
+      _mm_loadu_si128((const __m128i *)&min_y[first]);
+    const __m128i a_max_x =
+      _mm_loadu_si128((const __m128i *)&max_x[first]);
+    const __m128i a_max_y =
+      _mm_loadu_si128((const __m128i *)&max_y[first]);
+
+    const __m128i outside =
+      _mm_or_si128(_mm_or_si128(_mm_cmpgt_epi32(a_min_x, box_max_x),
+                                _mm_cmpgt_epi32(box_min_x, a_max_x)),
+                   _mm_or_si128(_mm_cmpgt_epi32(a_min_y, box_max_y),
+                                _mm_cmpgt_epi32(box_min_y, a_max_y)));
+
+    unsigned mask = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xf;
+    while (mask != 0) {
+      const unsigned i = first + __builtin_ctz(mask);
+      mask &= mask - 1;
+
+      if (MatchesAltitude(query, i))
+        dest[n++] = i;
+    }
+  }
+#endif
+
+  for (unsigned i = first; i < last; ++i)
+    if (Matches(query, i))
+      dest[n++] = i;
+
+  return n;
+}
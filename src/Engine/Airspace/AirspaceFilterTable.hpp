@@ -0,0 +1,143 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_AIRSPACE_FILTER_TABLE_HPP
+#define XCSOAR_AIRSPACE_FILTER_TABLE_HPP
+
+#include "AirspacesInterface.hpp"
+#include "Math/fixed.hpp"
+#include "Compiler.h"
+
+#include <vector>
+
+#include <stdint.h>
+
+struct AltitudeState;
+
+/**
+ * A flat copy of the properties which decide whether an airspace is a
+ * candidate for a query: its bounding box, the base and top
+ * altitudes and the activity.  It is stored column by column, so
+ * scanning it rejects most airspaces without touching the
+ * #AbstractAirspace objects, let alone their geometry.
+ *
+ * The rows are indexed by the slots of the airspace tree (see
+ * PackedRTree::GetSlot()), so the table must be rebuilt whenever the
+ * tree, the QNH or the activity changes.
+ */
+class AirspaceFilterTable {
+public:
+  enum Flags : uint8_t {
+    /** the slot holds an airspace which has not been removed */
+    PRESENT = 0x1,
+
+    /** AbstractAirspace::IsActive() */
+    ACTIVE = 0x2,
+
+    /** the base is AGL-referenced */
+    BASE_AGL = 0x4,
+
+    /** the top is AGL-referenced */
+    TOP_AGL = 0x8,
+
+    /** AbstractAirspace::IsBaseTerrain() */
+    BASE_TERRAIN = 0x10,
+  };
+
+  /**
+   * The conditions a candidate must meet.  The altitudes are
+   * resolved like AirspaceAltitude::GetAltitude() does.
+   */
+  struct Query {
+    FlatBoundingBox box;
+
+    /**
+     * The terrain height at the aircraft, which is added to
+     * AGL-referenced altitudes.
+     */
+    fixed terrain_offset;
+
+    /** the base must be at or below this altitude... */
+    fixed base_max;
+
+    /** ...unless one of these flags is set */
+    uint8_t base_always_below;
+
+    /** the top must be at or above this altitude */
+    fixed top_min;
+
+    /** all of these flags must be set */
+    uint8_t required;
+
+    /**
+     * Airspaces enclosing the aircraft, see
+     * AbstractAirspace::Inside(const AircraftState &).
+     */
+    gcc_pure
+    static Query Inside(const FlatBoundingBox &box,
+                        const AltitudeState &state);
+
+    /**
+     * Active airspaces whose base is not above the given ceiling.
+     */
+    gcc_pure
+    static Query Below(const FlatBoundingBox &box,
+                       const AltitudeState &state, fixed ceiling);
+  };
+
+private:
+  std::vector<int> min_x, min_y, max_x, max_y;
+  std::vector<fixed> base, top;
+  std::vector<uint8_t> flags;
+
+public:
+  unsigned size() const {
+    return flags.size();
+  }
+
+  void Clear();
+
+  /**
+   * Copy the properties of all slots of the tree.
+   */
+  void Build(const AirspacesInterface::AirspaceTree &tree);
+
+  /**
+   * Find the candidates among the slots first to last-1.
+   *
+   * @param dest receives the candidate slot numbers in ascending
+   * order; must have room for last-first entries
+   * @return the number of candidates
+   */
+  unsigned Scan(const Query &query, unsigned first, unsigned last,
+                unsigned *dest) const;
+
+private:
+  gcc_pure
+  bool Matches(const Query &query, unsigned i) const;
+
+  gcc_pure
+  bool MatchesAltitude(const Query &query, unsigned i) const;
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include "AirspacePolygon.hpp"
 #include "Geo/Flat/FlatProjection.hpp"
 #include "Geo/Flat/FlatRay.hpp"
+#include "Geo/Flat/FlatBoundingBox.hpp"
 #include "AirspaceIntersectSort.hpp"
 #include "AirspaceIntersectionVector.hpp"
 
@@ -51,6 +52,18 @@ AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts,
   } else {
     is_convex = TriState::UNKNOWN;
   }
+
+  if (PolygonEdgeIndex::IsWorthwhile(m_border))
+    edge_index.Build(m_border);
+}
+
+void
+AirspacePolygon::Project(const FlatProjection &tp)
+{
+  AbstractAirspace::Project(tp);
+
+  if (edge_index.IsDefined())
+    edge_index.Project(m_border);
 }
 
 const GeoPoint
@@ -82,7 +95,9 @@ AirspacePolygon::GetCenter() const
 bool
 AirspacePolygon::Inside(const GeoPoint &loc) const
 {
-  return m_border.IsInside(loc);
+  return edge_index.IsDefined()
+    ? edge_index.IsInside(m_border, loc)
+    : m_border.IsInside(loc);
 }
 
 AirspaceIntersectionVector
@@ -94,6 +109,32 @@ AirspacePolygon::Intersects(const GeoPoint &start, const GeoPoint &end,
 
   AirspaceIntersectSort sorter(start, *this);
 
+  if (edge_index.IsProjected()) {
+    const FlatGeoPoint &a = ray.point;
+    const FlatGeoPoint b = ray.point + ray.vector;
+    const FlatBoundingBox box(FlatGeoPoint(std::min(a.longitude, b.longitude),
+                                           std::min(a.latitude, b.latitude)),
+                              FlatGeoPoint(std::max(a.longitude, b.longitude),
+                                           std::max(a.latitude, b.latitude)));
+
+    std::vector<unsigned> edges;
+    edge_index.FindEdges(box, edges);
+
+    for (const unsigned i : edges) {
+      // like the linear scan, skip the closing edge
+      if (i + 1 == m_border.size())
+        continue;
+
+      const FlatRay r_seg(m_border[i].GetFlatLocation(),
+                          m_border[i + 1].GetFlatLocation());
+      fixed t = ray.DistinctIntersection(r_seg);
+      if (!negative(t))
+        sorter.add(t, projection.Unproject(ray.Parametric(t)));
+    }
+
+    return sorter.all();
+  }
+
   for (auto it = m_border.begin(); it + 1 != m_border.end(); ++it) {
 
     const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
@@ -110,6 +151,8 @@ AirspacePolygon::ClosestPoint(const GeoPoint &loc,
                               const FlatProjection &projection) const
 {
   const FlatGeoPoint p = projection.ProjectInteger(loc);
-  const FlatGeoPoint pb = m_border.NearestPoint(p);
+  const FlatGeoPoint pb = edge_index.IsProjected()
+    ? edge_index.NearestPoint(m_border, p)
+    : m_border.NearestPoint(p);
   return projection.Unproject(pb);
 }
@@ -27,7 +27,6 @@
 #include "AirspaceIntersectionVisitor.hpp"
 #include "AirspaceAircraftPerformance.hpp"
 #include "Task/Stats/TaskStats.hpp"
-#include "Predicate/AirspacePredicateAircraftInside.hpp"
 
 #define CRUISE_FILTER_FACT fixed(0.5)
 
@@ -171,7 +170,6 @@ class AirspaceIntersectionWarningVisitor final
   const AirspaceWarning::State warning_state;
   const fixed max_time;
   bool found;
-  const fixed max_alt;
   bool mode_inside;
 
 public:
@@ -183,7 +181,6 @@ public:
    * @param warning_manager Warning manager to add items to
    * @param warning_state Type of warning
    * @param max_time Time limit of intercept
-   * @param max_alt Maximum height of base to allow (optional)
    *
    * @return Initialised object
    */
@@ -191,15 +188,13 @@ public:
                                      const AirspaceAircraftPerformance &_perf,
                                      AirspaceWarningManager &_warning_manager,
                                      const AirspaceWarning::State _warning_state,
-                                     const fixed _max_time,
-                                     const fixed _max_alt = fixed(-1)):
+                                     const fixed _max_time):
     state(_state),
     perf(_perf),
     warning_manager(_warning_manager),
     warning_state(_warning_state),
     max_time(_max_time),
     found(false),
-    max_alt(_max_alt),
     mode_inside(false)
     {      
     };
@@ -207,14 +202,12 @@ public:
   /**
    * Check whether this intersection should be added to, or updated in, the warning manager
    *
-   * @param airspace Airspace corresponding to current intersection
+   * @param airspace Airspace corresponding to current intersection;
+   * inactive airspaces and those above the ceiling have already been
+   * filtered by the #Airspaces query
    */
   void Intersection(const AbstractAirspace& airspace) {
-    if (!airspace.IsActive())
-      return; // ignore inactive airspaces completely
-
-    if (!warning_manager.GetConfig().IsClassEnabled(airspace.GetType()) ||
-        ExcludeAltitude(airspace))
+    if (!warning_manager.GetConfig().IsClassEnabled(airspace.GetType()))
       return;
 
     AirspaceWarning *warning = warning_manager.GetWarningPtr(airspace);
@@ -260,14 +253,6 @@ public:
   void SetMode(bool m) {
     mode_inside = m;
   }
-
-private:
-  bool ExcludeAltitude(const AbstractAirspace& airspace) {
-    if (!positive(max_alt))
-      return false;
-
-    return (airspace.GetBaseAltitude(state) > max_alt);
-  }
 };
 
 
@@ -297,13 +282,13 @@ AirspaceWarningManager::UpdatePredicted(const AircraftState& state,
 
   AirspaceIntersectionWarningVisitor visitor(state, perf, 
                                              *this, 
-                                             warning_state, max_time_limit,
-                                             ceiling);
+                                             warning_state, max_time_limit);
 
-  airspaces.VisitIntersecting(state.location, location_predicted, visitor);
+  airspaces.VisitIntersecting(state.location, location_predicted,
+                              state, ceiling, visitor);
 
   visitor.SetMode(true);
-  airspaces.VisitInside(state.location, visitor);
+  airspaces.VisitInside(state.location, state, ceiling, visitor);
 
   return visitor.Found();
 }
@@ -392,9 +377,7 @@ AirspaceWarningManager::UpdateInside(const AircraftState& state,
 
   bool found = false;
 
-  AirspacePredicateAircraftInside condition(state);
-
-  Airspaces::AirspaceVector results = airspaces.FindInside(state, condition);
+  Airspaces::AirspaceVector results = airspaces.FindInside(state);
   for (const auto &i : results) {
     const AbstractAirspace &airspace = i.GetAirspace();
 
@@ -29,6 +29,7 @@
 #include "Geo/Flat/FlatRay.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 
+#include <algorithm>
 #include <functional>
 
 #ifdef INSTRUMENT_TASK
@@ -36,6 +37,44 @@ extern unsigned n_queries;
 extern long count_intersections;
 #endif
 
+/**
+ * The box covering everything within the given projected range of
+ * the envelope.
+ */
+gcc_pure
+static FlatBoundingBox
+ExpandBox(const FlatBoundingBox &box, int range)
+{
+  return FlatBoundingBox(FlatGeoPoint(box.GetLowerLeft().longitude - range,
+                                      box.GetLowerLeft().latitude - range),
+                         FlatGeoPoint(box.GetUpperRight().longitude + range,
+                                      box.GetUpperRight().latitude + range));
+}
+
+template<typename V>
+void
+Airspaces::VisitCandidates(const AirspaceFilterTable::Query &query,
+                           V &&visitor) const
+{
+  assert(filter_table.size() == airspace_tree.GetSlotCount());
+
+  airspace_tree.VisitOverlappingSlots(query.box,
+                                      [this, &query, &visitor](unsigned first,
+                                                               unsigned last){
+    /* the overflow list may be longer than a leaf */
+    static constexpr unsigned CHUNK = 64;
+    unsigned candidates[CHUNK];
+
+    while (first < last) {
+      const unsigned end = std::min(first + CHUNK, last);
+      const unsigned n = filter_table.Scan(query, first, end, candidates);
+      for (unsigned i = 0; i < n; ++i)
+        visitor(airspace_tree.GetSlot(candidates[i]));
+      first = end;
+    }
+  });
+}
+
 class AirspacePredicateVisitorAdapter {
   const AirspacePredicate *predicate;
   AirspaceVisitor *visitor;
@@ -64,7 +103,8 @@ Airspaces::VisitWithinRange(const GeoPoint &location, fixed range,
   Airspace bb_target(location, task_projection);
   int projected_range = task_projection.ProjectRangeInteger(location, range);
   AirspacePredicateVisitorAdapter adapter(predicate, visitor);
-  airspace_tree.visit_within_range(bb_target, -projected_range, adapter);
+  airspace_tree.VisitOverlapping(ExpandBox(bb_target, projected_range),
+                                 adapter);
 
 #ifdef INSTRUMENT_TASK
   n_queries++;
@@ -105,7 +145,31 @@ Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
   Airspace bb_target(c, task_projection);
   int projected_range = task_projection.ProjectRangeInteger(c, loc.Distance(end) / 2);
   IntersectingAirspaceVisitorAdapter adapter(loc, end, task_projection, visitor);
-  airspace_tree.visit_within_range(bb_target, -projected_range, adapter);
+  airspace_tree.VisitOverlapping(ExpandBox(bb_target, projected_range),
+                                 adapter);
+
+#ifdef INSTRUMENT_TASK
+  n_queries++;
+#endif
+}
+
+void
+Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
+                             const AltitudeState &altitude, fixed ceiling,
+                             AirspaceIntersectionVisitor &visitor) const
+{
+  if (IsEmpty())
+    // nothing to do
+    return;
+
+  const GeoPoint c = loc.Middle(end);
+  Airspace bb_target(c, task_projection);
+  int projected_range = task_projection.ProjectRangeInteger(c, loc.Distance(end) / 2);
+  IntersectingAirspaceVisitorAdapter adapter(loc, end, task_projection, visitor);
+  VisitCandidates(AirspaceFilterTable::Query::Below(ExpandBox(bb_target,
+                                                              projected_range),
+                                                    altitude, ceiling),
+                  adapter);
 
 #ifdef INSTRUMENT_TASK
   n_queries++;
@@ -139,7 +203,8 @@ Airspaces::ScanRange(const GeoPoint &location, fixed range,
       res.push_back(v);
   };
 
-  airspace_tree.visit_within_range(bb_target, -projected_range, visitor);
+  airspace_tree.VisitOverlapping(ExpandBox(bb_target, projected_range),
+                                 visitor);
 
   return res;
 }
@@ -164,11 +229,12 @@ Airspaces::FindInside(const AircraftState &state,
 #endif
 
     if (condition(v.GetAirspace()) &&
-        v.IsInside(state))
+        v.IsInside(state.location))
       vectors.push_back(v);
   };
 
-  airspace_tree.visit_within_range(bb_target, 0, visitor);
+  VisitCandidates(AirspaceFilterTable::Query::Inside(bb_target, state),
+                  visitor);
 
   return vectors;
 }
@@ -185,18 +251,20 @@ Airspaces::Optimise()
     for (const auto &i : airspace_tree)
       tmp_as.push_back(&i.GetAirspace());
 
-    airspace_tree.clear();
+    airspace_tree.Clear();
   }
 
   if (!tmp_as.empty()) {
     while (!tmp_as.empty()) {
       Airspace as(*tmp_as.front(), task_projection);
-      airspace_tree.insert(as);
+      airspace_tree.Insert(as);
       tmp_as.pop_front();
     }
-    airspace_tree.optimise();
+    airspace_tree.Optimise();
   }
 
+  filter_table.Build(airspace_tree);
+
   ++serial;
 }
 
@@ -246,7 +314,8 @@ Airspaces::Clear()
   }
 
   // then delete the tree
-  airspace_tree.clear();
+  airspace_tree.Clear();
+  filter_table.Clear();
 }
 
 unsigned
@@ -269,6 +338,9 @@ Airspaces::SetFlightLevels(const AtmosphericPressure &press)
 
     for (auto &v : airspace_tree)
       v.SetFlightLevel(press);
+
+    filter_table.Build(airspace_tree);
+    ++levels_serial;
   }
 }
 
@@ -280,6 +352,9 @@ Airspaces::SetActivity(const AirspaceActivity mask)
 
     for (auto &v : airspace_tree)
       v.SetActivity(mask);
+
+    filter_table.Build(airspace_tree);
+    ++levels_serial;
   }
 }
 
@@ -299,59 +374,83 @@ Airspaces::SynchroniseInRange(const Airspaces &master,
 {
   qnh = master.qnh;
   activity_mask = master.activity_mask;
+
+  /* the envelopes in our tree are still valid only if the master has
+     not been modified (its airspace objects may have been replaced)
+     and the projection has not moved since the last call */
+  const bool rebuild = master.serial != synchronised_serial ||
+    !(task_projection.GetCenter() == master.task_projection.GetCenter());
+
+  /* our altitudes and activity flags live in the master's airspace
+     objects */
+  const bool levels_changed =
+    master.levels_serial != synchronised_levels_serial;
+
   task_projection = master.task_projection;
+  synchronised_serial = master.serial;
+  synchronised_levels_serial = master.levels_serial;
 
-  bool changed = false;
   const AirspaceVector contents_master = master.ScanRange(location, range, condition);
-  AirspaceVector contents_self;
-  contents_self.reserve(std::max(airspace_tree.size(), contents_master.size()));
 
-  task_projection = master.task_projection; // ensure these are up to date
-
-  for (const auto &v : airspace_tree)
-    contents_self.push_back(v);
+  wanted.clear();
+  wanted.reserve(contents_master.size());
+  for (const auto &v : contents_master)
+    wanted.insert(&v.GetAirspace());
+
+  // whatever is already in the tree is not new; the rest is obsolete
+  present.clear();
+  AirspaceVector removed;
+  for (const auto &v : airspace_tree) {
+    present.insert(&v.GetAirspace());
+    if (!wanted.contains(&v.GetAirspace()))
+      removed.push_back(v);
+  }
 
   // find items to add
-  for (const auto &v : contents_master) {
-    const AbstractAirspace &other = v.GetAirspace();
-
-    bool found = false;
-    for (auto s = contents_self.begin(); s != contents_self.end(); ++s) {
-      const AbstractAirspace &self = s->GetAirspace();
-      if (&self == &other) {
-        found = true;
-        contents_self.erase(s);
-        break;
-      }
-    }
-    if (!found && other.IsActive()) {
-      Add(&v.GetAirspace());
-      changed = true;
-    }
+  AirspaceVector added;
+  for (const auto &v : contents_master)
+    if (!present.contains(&v.GetAirspace()) &&
+        v.GetAirspace().IsActive())
+      added.push_back(v);
+
+  // delete items which were not in the query --- including the clearances!
+  for (const auto &v : removed) {
+    if (!rebuild)
+      airspace_tree.Remove(v);
+    v.ClearClearance();
   }
 
-  // anything left in the self list are items that were not in the query,
-  // so delete them --- including the clearances!
-  for (auto v = contents_self.begin(); v != contents_self.end();) {
-    gcc_unused bool found = false;
-    for (auto t = airspace_tree.begin(); t != airspace_tree.end(); ) {
-      if (&t->GetAirspace() == &v->GetAirspace()) {
-        AirspaceTree::const_iterator new_t = t;
-        ++new_t;
-        airspace_tree.erase_exact(*t);
-        t = new_t;
-        found = true;
-      } else {
-        ++t;
-      }
+  if (rebuild) {
+    /* re-create the tree from the master's envelopes, which have been
+       calculated with the projection we have just copied */
+    airspace_tree.Clear();
+    for (const auto &v : contents_master)
+      if (present.contains(&v.GetAirspace()) ||
+          v.GetAirspace().IsActive())
+        airspace_tree.Insert(v);
+
+    airspace_tree.Optimise();
+    unoptimised_changes = 0;
+    ++serial;
+  } else if (!removed.empty() || !added.empty()) {
+    for (const auto &v : added)
+      airspace_tree.Insert(v);
+
+    /* new items go to the R-tree's overflow list and removed ones
+       are only marked; repack after many changes */
+    unoptimised_changes += removed.size() + added.size();
+    if (unoptimised_changes > airspace_tree.size() / 2 + 16) {
+      airspace_tree.Optimise();
+      unoptimised_changes = 0;
     }
-    assert(found);
-    v->ClearClearance();
-    v = contents_self.erase(v);
-    changed = true;
+
+    ++serial;
   }
-  if (changed)
-    Optimise();
+
+  const bool changed = !removed.empty() || !added.empty();
+  if (rebuild || changed || levels_changed)
+    filter_table.Build(airspace_tree);
+
   return changed;
 }
 
@@ -370,5 +469,27 @@ Airspaces::VisitInside(const GeoPoint &loc, AirspaceVisitor &visitor) const
       visitor.Visit(v);
   };
 
-  airspace_tree.visit_within_range(bb_target, 0, visitor2);
+  airspace_tree.VisitOverlapping(bb_target, visitor2);
+}
+
+void
+Airspaces::VisitInside(const GeoPoint &loc,
+                       const AltitudeState &altitude, fixed ceiling,
+                       AirspaceVisitor &visitor) const
+{
+  if (IsEmpty())
+    // nothing to do
+    return;
+
+  Airspace bb_target(loc, task_projection);
+
+  std::function<void(const Airspace &)> visitor2 =
+    [&loc, &visitor](const Airspace &v){
+    if (v.IsInside(loc))
+      visitor.Visit(v);
+  };
+
+  VisitCandidates(AirspaceFilterTable::Query::Below(bb_target,
+                                                    altitude, ceiling),
+                  visitor2);
 }
@@ -25,8 +25,10 @@
 
 #include "AirspacesInterface.hpp"
 #include "AirspaceActivity.hpp"
+#include "AirspaceFilterTable.hpp"
 #include "Predicate/AirspacePredicate.hpp"
 #include "Util/Serial.hpp"
+#include "Util/DenseHashMap.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "Atmosphere/Pressure.hpp"
 #include "Compiler.h"
@@ -34,32 +36,31 @@
 #include <deque>
 
 class RasterTerrain;
+struct AltitudeState;
 class AirspaceVisitor;
 class AirspaceIntersectionVisitor;
 
 /**
- * Container for airspaces using kd-tree representation internally for
- * fast geospatial lookups.
+ * Container for airspaces using a packed R-tree representation
+ * internally for fast geospatial lookups.
  *
- * Complexity analysis (with kdtree):
+ * Complexity analysis (with R-tree):
  *
  *    Find within range (k points found):
- *     O(n^(3/4) + k)
+ *     O(log(n) + k) typically
  *
  *    Find intersecting:
- *     O(n^(3/4) + k)
+ *     O(log(n) + k) typically
  *
- *    Find nearest:
- *     O(log(n))
+ *    Items added or removed since the last Optimise() are handled
+ *    linearly.
  *
- *  Without kd-tree:
+ *  Without R-tree:
  *
  *    Find within range:
  *     O(n)
  *    Find intersecting:
  *     O(n)
- *    Find nearest:
- *     O(n)
  */
 
 class Airspaces : public AirspacesInterface {
@@ -71,6 +72,13 @@ class Airspaces : public AirspacesInterface {
   AirspaceTree airspace_tree;
   TaskProjection task_projection;
 
+  /**
+   * The bounding boxes, altitudes and activity of the airspaces in
+   * #airspace_tree, for pre-filtering queries which take them into
+   * account.
+   */
+  AirspaceFilterTable filter_table;
+
   std::deque<AbstractAirspace *> tmp_as;
 
   /**
@@ -79,6 +87,39 @@ class Airspaces : public AirspacesInterface {
    */
   Serial serial;
 
+  /**
+   * Keeps track of QNH and activity changes, which modify the
+   * airspace objects but not the tree.  Copies made by
+   * SynchroniseInRange() share these objects, and need to rebuild
+   * their #filter_table when this changes.
+   */
+  Serial levels_serial;
+
+  /**
+   * The serial of the master at the time of the last
+   * SynchroniseInRange() call.
+   */
+  Serial synchronised_serial;
+
+  /**
+   * The #levels_serial of the master at the time of the last
+   * SynchroniseInRange() call.
+   */
+  Serial synchronised_levels_serial;
+
+  /**
+   * The number of items inserted into or erased from the tree by
+   * SynchroniseInRange() since it was last optimised.
+   */
+  unsigned unoptimised_changes;
+
+  /**
+   * Scratch sets for SynchroniseInRange(): the master's airspaces in
+   * range, and the ones in our tree.  They are members so their
+   * memory is reused by the next call.
+   */
+  DenseHashSet<const AbstractAirspace *> wanted, present;
+
 public:
   /**
    * Constructor.
@@ -90,7 +131,8 @@ public:
    * @return empty Airspaces class.
    */
   Airspaces(bool _owns_children=true)
-    :qnh(AtmosphericPressure::Zero()), owns_children(_owns_children) {}
+    :qnh(AtmosphericPressure::Zero()), owns_children(_owns_children),
+     unoptimised_changes(0) {}
 
   Airspaces(const Airspaces &) = delete;
 
@@ -190,6 +232,19 @@ public:
   void VisitIntersecting(const GeoPoint &location, const GeoPoint &end,
                          AirspaceIntersectionVisitor &visitor) const;
 
+  /**
+   * Like VisitIntersecting(), but only for active airspaces whose
+   * base is not above the given ceiling.  These conditions are
+   * checked before any geometry.
+   *
+   * @param altitude altitude state used to resolve AGL-referenced
+   * bases
+   * @param ceiling maximum base altitude (m)
+   */
+  void VisitIntersecting(const GeoPoint &location, const GeoPoint &end,
+                         const AltitudeState &altitude, fixed ceiling,
+                         AirspaceIntersectionVisitor &visitor) const;
+
   /**
    * Call visitor class on airspaces this location is inside
    * Note that the visitor is not instantiated separately for each match
@@ -199,6 +254,19 @@ public:
    */
   void VisitInside(const GeoPoint &location, AirspaceVisitor &visitor) const;
 
+  /**
+   * Like VisitInside(), but only for active airspaces whose base is
+   * not above the given ceiling.  These conditions are checked
+   * before any geometry.
+   *
+   * @param altitude altitude state used to resolve AGL-referenced
+   * bases
+   * @param ceiling maximum base altitude (m)
+   */
+  void VisitInside(const GeoPoint &location,
+                   const AltitudeState &altitude, fixed ceiling,
+                   AirspaceVisitor &visitor) const;
+
   /**
    * Search for airspaces within range of the aircraft.
    *
@@ -215,6 +283,7 @@ public:
 
   /**
    * Find airspaces the aircraft is inside (taking altitude into account)
+   * The altitude is checked before the condition and the geometry.
    *
    * @param state state of aircraft for which to search
    * @param condition condition to be applied to matches
@@ -256,7 +325,11 @@ public:
   void ClearClearances();
 
   /**
-   * Copy/delete objects in this database based on query of master
+   * Copy/delete objects in this database based on query of master.
+   * The master's envelopes are inserted into and erased from the tree
+   * one by one; it is rebuilt only if the master has been modified
+   * since the last call.  The #filter_table is rebuilt only if the
+   * tree or the master's QNH or activity have changed.
    *
    * @param master Airspaces object to copy from
    * @param location location of aircraft, from which to search
@@ -269,6 +342,15 @@ public:
                           const GeoPoint &location, fixed range,
                           const AirspacePredicate &condition =
                                 AirspacePredicate::always_true);
+
+private:
+  /**
+   * Call the visitor for each airspace envelope in the tree which
+   * passes the #filter_table query.
+   */
+  template<typename V>
+  void VisitCandidates(const AirspaceFilterTable::Query &query,
+                       V &&visitor) const;
 };
 
 #endif
@@ -23,17 +23,54 @@
 #include "Airspaces.hpp"
 #include "Terrain/RasterTerrain.hpp"
 
+/**
+ * The number of airspaces whose ground level is looked up in one
+ * RasterMap::GetHeights() call.
+ */
+static constexpr unsigned GROUND_LEVEL_BATCH = 64;
+
+static void
+FlushGroundLevels(const RasterMap &map, const Airspace *const*airspaces,
+                  const GeoPoint *centers, unsigned n)
+{
+  short heights[GROUND_LEVEL_BATCH];
+  map.GetHeights(ConstBuffer<GeoPoint>(centers, n), heights);
+
+  for (unsigned i = 0; i < n; ++i) {
+    short h = heights[i];
+    if (RasterBuffer::IsSpecial(h))
+      /* apply fallback, see RasterTerrain::GetTerrainHeightOr0() */
+      h = 0;
+
+    airspaces[i]->SetGroundLevel(fixed(h));
+  }
+}
+
 void 
 Airspaces::SetGroundLevels(const RasterTerrain &terrain)
 {
+  /* acquire the terrain lease only once, and look up the airspace
+     centers in batches */
+  RasterTerrain::Lease lease(terrain);
+  const RasterMap &map = lease;
+
+  const Airspace *airspaces[GROUND_LEVEL_BATCH];
+  GeoPoint centers[GROUND_LEVEL_BATCH];
+  unsigned n = 0;
+
   for (auto &v : airspace_tree) {
     // If we don't need the ground level we don't have to calculate it
     if (!v.NeedGroundLevel())
       continue;
 
-    FlatGeoPoint c_flat = v.GetCenter();
-    GeoPoint g = task_projection.Unproject(c_flat);
-    v.SetGroundLevel(fixed(terrain.GetTerrainHeightOr0(g)));
+    airspaces[n] = &v;
+    centers[n] = task_projection.Unproject(v.GetCenter());
+    if (++n == GROUND_LEVEL_BATCH) {
+      FlushGroundLevels(map, airspaces, centers, n);
+      n = 0;
+    }
   }
+
+  FlushGroundLevels(map, airspaces, centers, n);
 }
 
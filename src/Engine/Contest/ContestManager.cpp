@@ -23,6 +23,7 @@
 #include "ContestManager.hpp"
 #include "Trace/Trace.hpp"
 #include "Time/PeriodClock.hpp"
+#include "Util/ParallelExecutor.hpp"
 #include "LogFile.hpp"
 #include <tchar.h>
 
@@ -44,7 +45,9 @@ ContestManager::ContestManager(const Contest _contest,
    dhv_xc_triangle(trace_triangle, predict_triangle, true),
    sis_at(trace_full),
    net_coupe(trace_full),
-   discontinue_calculations(false)
+   discontinue_calculations(false),
+   timeout(900),
+   executor(nullptr)
 {
   Reset();
 }
@@ -64,6 +67,15 @@ ContestManager::SetIncremental(bool incremental)
   net_coupe.SetIncremental(incremental);
 }
 
+void
+ContestManager::SetExecutor(ParallelExecutor *_executor)
+{
+  executor = _executor;
+  olc_fai.SetExecutor(_executor);
+  xcontest_triangle.SetExecutor(_executor);
+  dhv_xc_triangle.SetExecutor(_executor);
+}
+
 void
 ContestManager::SetPredicted(const TracePoint &predicted)
 {
@@ -121,6 +133,35 @@ RunContest(AbstractContest &_contest,
   return true;
 }
 
+/**
+ * Run two solvers which do not depend on each other, concurrently if
+ * an executor is available.
+ *
+ * @return true if at least one of them has found a new solution
+ */
+static bool
+RunContests(ParallelExecutor *executor, bool exhaustive,
+            AbstractContest &contest_a,
+            ContestResult &result_a, ContestTraceVector &solution_a,
+            AbstractContest &contest_b,
+            ContestResult &result_b, ContestTraceVector &solution_b)
+{
+  if (executor == nullptr || executor->GetConcurrency() < 2) {
+    const bool a = RunContest(contest_a, result_a, solution_a, exhaustive);
+    const bool b = RunContest(contest_b, result_b, solution_b, exhaustive);
+    return a || b;
+  }
+
+  bool retval[2];
+  executor->ForEach(2, [&](unsigned i){
+      retval[i] = i == 0
+        ? RunContest(contest_a, result_a, solution_a, exhaustive)
+        : RunContest(contest_b, result_b, solution_b, exhaustive);
+    });
+
+  return retval[0] || retval[1];
+}
+
 bool
 ContestManager::UpdateIdle(bool exhaustive)
 {
@@ -128,7 +169,6 @@ ContestManager::UpdateIdle(bool exhaustive)
     return false;
 
   PeriodClock clock;
-  const unsigned timeout_threshold = 900;
   clock.Update();
 
   bool retval = false;
@@ -163,11 +203,9 @@ ContestManager::UpdateIdle(bool exhaustive)
     break;
 
   case Contest::OLC_PLUS:
-    retval = RunContest(olc_classic, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(olc_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContests(executor, exhaustive,
+                         olc_classic, stats.result[0], stats.solution[0],
+                         olc_fai, stats.result[1], stats.solution[1]);
 
     if (retval) {
       olc_plus.Feed(stats.result[0], stats.solution[0],
@@ -185,17 +223,15 @@ ContestManager::UpdateIdle(bool exhaustive)
     break;
 
   case Contest::XCONTEST:
-    retval = RunContest(xcontest_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(xcontest_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContests(executor, exhaustive,
+                         xcontest_free, stats.result[0], stats.solution[0],
+                         xcontest_triangle, stats.result[1], stats.solution[1]);
     break;
 
   case Contest::DHV_XC:
-    retval = RunContest(dhv_xc_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(dhv_xc_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContests(executor, exhaustive,
+                         dhv_xc_free, stats.result[0], stats.solution[0],
+                         dhv_xc_triangle, stats.result[1], stats.solution[1]);
     break;
 
   case Contest::SIS_AT:
@@ -210,7 +246,7 @@ ContestManager::UpdateIdle(bool exhaustive)
 
   };
 
-  if (clock.Check(timeout_threshold)) {
+  if (timeout > 0 && clock.Check(timeout)) {
     discontinue_calculations = true;
     LogFormat(_T("Contest Manager aborting because of excessive calculation expense"));
   }
@@ -37,6 +37,7 @@
 #include "ContestStatistics.hpp"
 
 class Trace;
+class ParallelExecutor;
 
 /**
  * Special task holder for Online Contest calculations
@@ -70,6 +71,17 @@ class ContestManager
    */
   bool discontinue_calculations;
 
+  /**
+   * The duration [ms] of one UpdateIdle() call which triggers
+   * #discontinue_calculations; 0 disables the check.
+   */
+  unsigned timeout;
+
+  /**
+   * Runs independent solvers concurrently (may be nullptr).
+   */
+  ParallelExecutor *executor;
+
 public:
   /**
    * Base constructor.
@@ -104,6 +116,27 @@ public:
 
   void SetHandicap(unsigned handicap);
 
+  /**
+   * Change the time limit for one UpdateIdle() call, after which the
+   * calculations are discontinued.  This is meant to protect the
+   * calling thread; callers which run in a background thread may
+   * pass 0 to disable the check.
+   */
+  void SetTimeout(unsigned _timeout) {
+    timeout = _timeout;
+  }
+
+  /**
+   * Use the specified executor to run solvers which do not depend on
+   * each other's results concurrently (e.g. the free flight and the
+   * triangle of XContest), and to search large triangles.  The
+   * results are the same as with serial execution.
+   *
+   * @param _executor the executor or nullptr to solve in the calling
+   * thread
+   */
+  void SetExecutor(ParallelExecutor *_executor);
+
   /**
    * Update internal states (non-essential) for housework,
    * or where functions are slow and would cause loss to real-time performance.
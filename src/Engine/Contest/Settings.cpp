@@ -28,6 +28,7 @@ ContestSettings::SetDefaults()
 {
   enable = true;
   predict = false;
+  exact = false;
   contest = IsKobo() ? Contest::NONE : Contest::OLC_PLUS;
   handicap = 100;
 }
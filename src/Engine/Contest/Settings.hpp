@@ -60,6 +60,13 @@ struct ContestSettings {
    */
   bool predict;
 
+  /**
+   * Occasionally run the solvers again on a high-resolution trace
+   * rebuilt from all recorded fixes, and use its results if they
+   * score better?
+   */
+  bool exact;
+
   /** Rule set to scan for in OLC */
   Contest contest;
 
@@ -25,6 +25,7 @@ Copyright_License {
 #include "../ContestResult.hpp"
 #include "Trace/Trace.hpp"
 #include "Cast.hpp"
+#include "Math/FastMath.h"
 
 #include <algorithm>
 #include <assert.h>
@@ -240,25 +241,26 @@ ContestDijkstra::AddEdges(const ScanTaskPoint origin,
 
   const unsigned weight = GetStageWeight(origin.GetStageNumber());
 
+  const unsigned first = destination.GetPointIndex();
+  if (first < n_points)
+    CalcEdgeDistances(origin.GetPointIndex(), first);
+
+  const int *const altitudes = GetAltitudes();
+
   bool previous_above = false;
   for (const ScanTaskPoint end(destination.GetStageNumber(), n_points);
        destination != end; destination.IncrementPointIndex()) {
-    bool above = GetPoint(destination).GetIntegerAltitude() >= min_altitude;
-
-    if (above) {
-      const unsigned d = weight * CalcEdgeDistance(origin, destination);
-      Link(destination, origin, d);
-    } else if (previous_above) {
-      /* After excessive thinning, the exact TracePoint that matches
-         the required altitude difference may be gone, and the
-         calculated result becomes overly pessimistic.  This code path
-         makes it optimistic, by checking if the previous point
-         matches. */
-
-      /* TODO: interpolate the distance */
-      const unsigned d = weight * CalcEdgeDistance(origin, destination);
-      Link(destination, origin, d);
-    }
+    const unsigned i = destination.GetPointIndex();
+    bool above = altitudes[i] >= min_altitude;
+
+    /* After excessive thinning, the exact TracePoint that matches
+       the required altitude difference may be gone, and the
+       calculated result becomes overly pessimistic.  Linking the
+       point after the last one which matches makes it optimistic. */
+
+    /* TODO: interpolate the distance */
+    if (above || previous_above)
+      Link(destination, origin, weight * edge_distances[i - first]);
 
     previous_above = above;
   }
@@ -270,6 +272,32 @@ ContestDijkstra::AddEdges(const ScanTaskPoint origin,
   }
 }
 
+void
+ContestDijkstra::CalcEdgeDistances(const unsigned origin,
+                                   const unsigned first)
+{
+  assert(origin < n_points);
+  assert(first < n_points);
+
+  const int origin_longitude = GetFlatLongitudes()[origin];
+  const int origin_latitude = GetFlatLatitudes()[origin];
+  const int *const longitudes = GetFlatLongitudes() + first;
+  const int *const latitudes = GetFlatLatitudes() + first;
+
+  const unsigned n = n_points - first;
+  if (edge_distances.size() < n)
+    edge_distances.resize(n);
+
+  /* same as FlatGeoPoint::Distance(), written as a plain loop over
+     the arrays so it can be vectorised */
+  unsigned *const distances = edge_distances.data();
+  for (unsigned i = 0; i < n; ++i) {
+    const unsigned dx = longitudes[i] - origin_longitude;
+    const unsigned dy = latitudes[i] - origin_latitude;
+    distances[i] = InlineIsqrt4(dx * dx + dy * dy);
+  }
+}
+
 void
 ContestDijkstra::AddEdges(const ScanTaskPoint origin)
 {
@@ -30,6 +30,8 @@ Copyright_License {
 #include "Trace/Vector.hpp"
 #include "TraceManager.hpp"
 
+#include <vector>
+
 #include <assert.h>
 
 class Trace;
@@ -68,6 +70,11 @@ class ContestDijkstra : public AbstractContest, protected NavDijkstra, public Tr
    */
   ContestTraceVector solution;
 
+  /**
+   * Scratch buffer for CalcEdgeDistances().
+   */
+  std::vector<unsigned> edge_distances;
+
 protected:
   /**
    * The index of the first finish candidate.  During incremental
@@ -128,6 +135,13 @@ protected:
     return stage_weights[index];
   }
 
+  /**
+   * Calculate the flat distances from one trace point to all trace
+   * points starting at the specified index, and store them in
+   * #edge_distances.
+   */
+  void CalcEdgeDistances(unsigned origin, unsigned first);
+
   /**
    * Distance function for edges
    *
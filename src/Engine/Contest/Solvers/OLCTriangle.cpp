@@ -24,7 +24,9 @@
 #include "Cast.hpp"
 #include "Trace/Trace.hpp"
 #include "Util/QuadTree.hpp"
+#include "Util/ParallelExecutor.hpp"
 
+#include <atomic>
 #include <limits>
 
 /*
@@ -57,6 +59,13 @@
  */
 static constexpr fixed max_distance(1000);
 
+/**
+ * The minimum number of trace points in a closing pair for searching
+ * it on multiple threads.  Smaller searches finish quickly, and the
+ * overhead of distributing them would dominate.
+ */
+static constexpr unsigned PARALLEL_THRESHOLD = 128;
+
 OLCTriangle::OLCTriangle(const Trace &_trace,
                          const bool _is_fai, bool _predict,
                          const unsigned _finish_alt_diff)
@@ -66,7 +75,8 @@ OLCTriangle::OLCTriangle(const Trace &_trace,
    is_closed(false),
    is_complete(false),
    max_iterations(1e6),
-   max_tree_size(5e5)
+   max_tree_size(5e5),
+   executor(nullptr)
 {
 }
 
@@ -307,6 +317,252 @@ OLCTriangle::SolveTriangle(bool exhaustive)
 }
 
 
+gcc_pure
+static std::tuple<unsigned, unsigned, unsigned>
+GetSortedIndices(unsigned tp1, unsigned tp2, unsigned tp3)
+{
+  if (tp1 > tp2) std::swap(tp1, tp2);
+  if (tp2 > tp3) std::swap(tp2, tp3);
+  if (tp1 > tp2) std::swap(tp1, tp2);
+
+  return std::make_tuple(tp1, tp2, tp3);
+}
+
+void
+OLCTriangle::Solution::Offer(const OLCTriangle &parent,
+                             const CandidateSet &other)
+{
+  if (valid) {
+    if (other.df_min != candidates.df_min) {
+      if (other.df_min < candidates.df_min)
+        return;
+    } else {
+      /* the projected distances are equal, which happens quite often
+         with nearby trace points; compare the real distances */
+      const auto a = GetSortedIndices(other.tp1.index_min,
+                                      other.tp2.index_min,
+                                      other.tp3.index_min);
+      const auto b = GetSortedIndices(candidates.tp1.index_min,
+                                      candidates.tp2.index_min,
+                                      candidates.tp3.index_min);
+
+      const auto distance = [&parent](const std::tuple<unsigned, unsigned, unsigned> &tps) {
+        const GeoPoint &p1 = parent.GetPoint(std::get<0>(tps)).GetLocation();
+        const GeoPoint &p2 = parent.GetPoint(std::get<1>(tps)).GetLocation();
+        const GeoPoint &p3 = parent.GetPoint(std::get<2>(tps)).GetLocation();
+        return p1.Distance(p2) + p2.Distance(p3) + p3.Distance(p1);
+      };
+
+      const fixed d_a = distance(a), d_b = distance(b);
+      if (d_a < d_b || (d_a == d_b && a >= b))
+        return;
+    }
+  }
+
+  candidates = other;
+  valid = true;
+}
+
+unsigned
+OLCTriangle::ProcessCandidate(const CandidateSet &node, unsigned worst_d,
+                              unsigned large_triangle_check,
+                              Solution &solution, CandidateSet *children)
+{
+  if (node.df_min >= worst_d &&
+      node.IsIntegral(this, is_fai, large_triangle_check)) {
+    // node is integral feasible -> a possible solution
+    solution.Offer(*this, node);
+    return 0;
+  }
+
+  // split largest bounding box of node and create child nodes
+
+  const unsigned tp1_diag = node.tp1.GetDiagnoal();
+  const unsigned tp2_diag = node.tp2.GetDiagnoal();
+  const unsigned tp3_diag = node.tp3.GetDiagnoal();
+
+  const unsigned max_diag = std::max({tp1_diag, tp2_diag, tp3_diag});
+
+  CandidateSet left, right;
+
+  if (tp1_diag == max_diag && node.tp1.GetSize() != 1) {
+    // split tp1 range
+    const unsigned split = (node.tp1.index_min + node.tp1.index_max) / 2;
+
+    if (split > node.tp2.index_max)
+      return 0;
+
+    left = CandidateSet(TurnPointRange(this, node.tp1.index_min, split),
+                        node.tp2, node.tp3, is_fai);
+
+    right = CandidateSet(TurnPointRange(this, split, node.tp1.index_max),
+                         node.tp2, node.tp3, is_fai);
+  } else if (tp2_diag == max_diag && node.tp2.GetSize() != 1) {
+    // split tp2 range
+    const unsigned split = (node.tp2.index_min + node.tp2.index_max) / 2;
+
+    if (split > node.tp3.index_max || split < node.tp1.index_min)
+      return 0;
+
+    left = CandidateSet(node.tp1,
+                        TurnPointRange(this, node.tp2.index_min, split),
+                        node.tp3, is_fai);
+
+    right = CandidateSet(node.tp1,
+                         TurnPointRange(this, split, node.tp2.index_max),
+                         node.tp3, is_fai);
+  } else if (node.tp3.GetSize() != 1) {
+    // split tp3 range
+    const unsigned split = (node.tp3.index_min + node.tp3.index_max) / 2;
+
+    if (split < node.tp2.index_min)
+      return 0;
+
+    left = CandidateSet(node.tp1, node.tp2,
+                        TurnPointRange(this, node.tp3.index_min, split),
+                        is_fai);
+
+    right = CandidateSet(node.tp1, node.tp2,
+                         TurnPointRange(this, split, node.tp3.index_max),
+                         is_fai);
+  } else
+    return 0;
+
+  // add the new candidate set only if it it's feasible and has d_max >= worst_d
+  unsigned n = 0;
+
+  if (left.df_max >= worst_d &&
+      left.IsFeasible(is_fai, large_triangle_check))
+    children[n++] = left;
+
+  if (right.df_max >= worst_d &&
+      right.IsFeasible(is_fai, large_triangle_check))
+    children[n++] = right;
+
+  return n;
+}
+
+bool
+OLCTriangle::PushChildren(CandidateHeap &heap, const CandidateSet *children,
+                          unsigned n, unsigned iterations,
+                          CandidateSet &dive) const
+{
+  /* this is a mixed depth-first/best-first approach, the latter
+   * being faster, but the first a lot more memory efficient. */
+  if (n > 0 && heap.size() > n_points * 4 && iterations % 16 != 0) {
+    const unsigned best = n == 2 && children[1].df_max > children[0].df_max;
+    dive = children[best];
+
+    if (n == 2)
+      heap.Push(children[1 - best]);
+
+    return true;
+  }
+
+  for (unsigned i = 0; i < n; ++i)
+    heap.Push(children[i]);
+
+  return false;
+}
+
+/**
+ * Raise the shared bound to the specified value (if it is larger).
+ */
+static void
+RaiseBound(std::atomic<unsigned> &bound, unsigned value)
+{
+  unsigned old = bound.load(std::memory_order_relaxed);
+  while (value > old &&
+         !bound.compare_exchange_weak(old, value, std::memory_order_relaxed)) {}
+}
+
+OLCTriangle::Solution
+OLCTriangle::RunParallelBranchAndBound(const CandidateSet &root,
+                                       unsigned worst_d,
+                                       unsigned large_triangle_check)
+{
+  const unsigned concurrency = executor->GetConcurrency();
+
+  /* expand the most promising candidate sets in this thread until
+     there are enough subtrees to keep all threads busy */
+  const unsigned n_subtrees = concurrency * 16;
+
+  Solution solution;
+  CandidateHeap frontier;
+  frontier.Push(root);
+
+  CandidateSet children[2];
+  unsigned n_expanded = 0;
+
+  while (!frontier.empty() && frontier.size() < n_subtrees &&
+         n_expanded < max_iterations) {
+    const CandidateSet node = frontier.Pop();
+    if (node.df_max < worst_d)
+      continue;
+
+    ++n_expanded;
+
+    const unsigned n = ProcessCandidate(node, worst_d, large_triangle_check,
+                                        solution, children);
+    if (solution.valid)
+      worst_d = std::max(worst_d, solution.candidates.df_min);
+
+    for (unsigned i = 0; i < n; ++i)
+      frontier.Push(children[i]);
+  }
+
+  /* the executor hands out the subtrees in order, so the most
+     promising ones are searched first */
+  std::vector<CandidateSet> subtrees;
+  subtrees.reserve(frontier.size());
+  while (!frontier.empty())
+    subtrees.push_back(frontier.Pop());
+
+  std::vector<Solution> solutions(subtrees.size());
+  std::atomic<unsigned> shared_worst_d(worst_d);
+
+  /* all threads draw from the same iteration budget as a serial
+     run */
+  std::atomic<unsigned> iterations(n_expanded);
+
+  executor->ForEach(subtrees.size(), [&](unsigned i){
+      Solution &local = solutions[i];
+      CandidateHeap heap;
+      CandidateSet dive = subtrees[i], children[2];
+      bool diving = true;
+
+      while ((diving || !heap.empty()) && heap.size() <= max_tree_size) {
+        const CandidateSet node = diving ? dive : heap.Pop();
+        diving = false;
+
+        const unsigned worst = shared_worst_d.load(std::memory_order_relaxed);
+        if (node.df_max < worst)
+          continue;
+
+        const unsigned n_iterations =
+          iterations.fetch_add(1, std::memory_order_relaxed);
+        if (n_iterations >= max_iterations)
+          break;
+
+        const unsigned n = ProcessCandidate(node, worst, large_triangle_check,
+                                            local, children);
+        if (local.valid)
+          RaiseBound(shared_worst_d, local.candidates.df_min);
+
+        diving = PushChildren(heap, children, n, n_iterations, dive);
+      }
+    });
+
+  /* merge in subtree order: Solution::Offer() keeps the first of
+     two equal triangles, so ties are broken by the branch index and
+     not by the order in which the threads finished */
+  for (const auto &i : solutions)
+    if (i.valid)
+      solution.Offer(*this, i.candidates);
+
+  return solution;
+}
+
 std::tuple<unsigned, unsigned, unsigned, unsigned>
 OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, bool exhaustive)
 {
@@ -326,11 +582,7 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
   if (fastskiprange_flat < worst_d)
     return std::tuple<unsigned, unsigned, unsigned, unsigned>(0, 0, 0, 0);
 
-  bool integral_feasible = false;
-  unsigned best_d = 0,
-           tp1 = 0,
-           tp2 = 0,
-           tp3 = 0;
+  Solution solution;
   unsigned iterations = 0;
 
   // note: this is _not_ the breakepoint between small and large triangles,
@@ -339,14 +591,23 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
     trace_master.ProjectRange(GetPoint(from).GetLocation(), fixed(500000)) * 0.99;
 
   if (!running) {
-    // initiate algorithm. otherwise continue unfinished run
-    running = true;
-
     // initialize bound-and-branch tree with root node (note: Candidate set interval is [min, max))
     CandidateSet root_candidates(this, from, to + 1);
     if (root_candidates.IsFeasible(is_fai, large_triangle_check) &&
-        root_candidates.df_max >= worst_d)
-      branch_and_bound.insert(std::pair<unsigned, CandidateSet>(root_candidates.df_max, root_candidates));
+        root_candidates.df_max >= worst_d) {
+      if (exhaustive && executor != nullptr &&
+          executor->GetConcurrency() > 1 &&
+          to - from >= PARALLEL_THRESHOLD)
+        /* large exhaustive search: the tree is searched completely
+           within this call, so there is no state to keep */
+        solution = RunParallelBranchAndBound(root_candidates, worst_d,
+                                             large_triangle_check);
+      else {
+        // initiate algorithm. otherwise continue unfinished run
+        running = true;
+        branch_and_bound.Push(root_candidates);
+      }
+    }
   }
 
   // set max_iterations only if non-exhaustive and predictive solving is enabled.
@@ -354,135 +615,52 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
   if (!exhaustive && predict)
     max_iterations = tick_iterations;
 
-  while (!branch_and_bound.empty()) {
+  CandidateSet dive, children[2];
+  bool diving = false;
+
+  while (diving || !branch_and_bound.empty()) {
     /* now loop over the tree, branching each found candidate set, adding the branch if it's feasible.
-     * remove all candidate sets with d_max smaller than d_min of the largest integral candidate set
-     * always work on the node with largest d_min
+     * skip all candidate sets with d_max smaller than d_min of the largest integral candidate set
+     * always work on the node with largest d_max, unless diving
      */
 
-    iterations++;
-
     // break loop if max_iterations or max_tree_size exceeded
-    if (iterations > max_iterations || branch_and_bound.size() > max_tree_size)
+    if (iterations >= max_iterations || branch_and_bound.size() > max_tree_size)
       break;
 
-    // first clean up tree, removeing all nodes with d_max < worst_d
-    branch_and_bound.erase(branch_and_bound.begin(), branch_and_bound.lower_bound(worst_d));
+    const CandidateSet node = diving ? dive : branch_and_bound.Pop();
+    diving = false;
 
-    // we might have cleaned up the whole tree. nothing to do then...
-    if (branch_and_bound.empty())
-      break;
-
-    /* get node to work on.
-     * change node selection strategy if the tree grows too big.
-     * this is a mixed depht-first/breadth-first approach, the latter
-     * beeing faster, but the first a lot more memory efficient.
-     */
-    std::multimap<unsigned, CandidateSet>::iterator node;
+    // candidate sets which can't beat the best solution are dropped
+    if (node.df_max < worst_d)
+      continue;
 
-    if (branch_and_bound.size() > n_points * 4 && iterations % 16 != 0) {
-      node = branch_and_bound.upper_bound(branch_and_bound.rbegin()->first / 2);
-      if (node == branch_and_bound.end()) --node;
-    } else {
-      node = --branch_and_bound.end();
-    }
-
-    if (node->second.df_min >= worst_d &&
-        node->second.IsIntegral(this, is_fai, large_triangle_check)) {
-      // node is integral feasible -> a possible solution
-
-      worst_d = node->second.df_min;
-
-      tp1 = node->second.tp1.index_min;
-      tp2 = node->second.tp2.index_min;
-      tp3 = node->second.tp3.index_min;
-      best_d = node->first;
-
-      integral_feasible = true;
-
-    } else {
-      // split largest bounding box of node and create child nodes
-
-      const unsigned tp1_diag = node->second.tp1.GetDiagnoal();
-      const unsigned tp2_diag = node->second.tp2.GetDiagnoal();
-      const unsigned tp3_diag = node->second.tp3.GetDiagnoal();
-
-      const unsigned max_diag = std::max({tp1_diag, tp2_diag, tp3_diag});
-
-      CandidateSet left, right;
-      bool add = false;
-
-      if (tp1_diag == max_diag && node->second.tp1.GetSize() != 1) {
-        // split tp1 range
-        const unsigned split = (node->second.tp1.index_min + node->second.tp1.index_max) / 2;
-
-        if (split <= node->second.tp2.index_max) {
-          add = true;
-
-          left = CandidateSet(TurnPointRange(this, node->second.tp1.index_min, split),
-                              node->second.tp2, node->second.tp3);
-
-          right = CandidateSet(TurnPointRange(this, split, node->second.tp1.index_max),
-                               node->second.tp2, node->second.tp3);
-        }
-      } else if (tp2_diag == max_diag && node->second.tp2.GetSize() != 1) {
-        // split tp2 range
-        const unsigned split = (node->second.tp2.index_min + node->second.tp2.index_max) / 2;
-
-        if (split <= node->second.tp3.index_max && split >= node->second.tp1.index_min) {
-          add = true;
-
-          left = CandidateSet(node->second.tp1,
-                              TurnPointRange(this, node->second.tp2.index_min, split),
-                              node->second.tp3);
-
-          right = CandidateSet(node->second.tp1,
-                               TurnPointRange(this, split, node->second.tp2.index_max),
-                               node->second.tp3);
-        }
-      } else if (node->second.tp3.GetSize() != 1) {
-        // split tp3 range
-        const unsigned split = (node->second.tp3.index_min + node->second.tp3.index_max) / 2;
-
-        if (split >= node->second.tp2.index_min) {
-          add = true;
-
-          left = CandidateSet(node->second.tp1, node->second.tp2,
-                              TurnPointRange(this, node->second.tp3.index_min, split));
-
-          right = CandidateSet(node->second.tp1, node->second.tp2,
-                               TurnPointRange(this, split, node->second.tp3.index_max));
-        }
-      }
+    iterations++;
 
-      if (add) {
-        // add the new candidate set only if it it's feasible and has d_min >= worst_d
-        if (left.df_max >= worst_d &&
-            left.IsFeasible(is_fai, large_triangle_check)) {
-          branch_and_bound.insert(std::pair<unsigned, CandidateSet>(left.df_max, left));
-        }
-
-        if (right.df_max >= worst_d &&
-            right.IsFeasible(is_fai, large_triangle_check)) {
-          branch_and_bound.insert(std::pair<unsigned, CandidateSet>(right.df_max, right));
-        }
-      }
-    }
+    const unsigned n = ProcessCandidate(node, worst_d, large_triangle_check,
+                                        solution, children);
+    if (solution.valid)
+      worst_d = std::max(worst_d, solution.candidates.df_min);
 
-    // remove current node
-    branch_and_bound.erase(node);
+    diving = PushChildren(branch_and_bound, children, n, iterations, dive);
   }
 
+  if (diving)
+    // suspended while diving: keep the node for the next call
+    branch_and_bound.Push(dive);
 
   if (branch_and_bound.empty())
     running = false;
 
-  if (integral_feasible) {
-    if (tp1 > tp2) std::swap(tp1, tp2);
-    if (tp2 > tp3) std::swap(tp2, tp3);
-    if (tp1 > tp2) std::swap(tp1, tp2);
+  if (solution.valid) {
+    const auto tps = GetSortedIndices(solution.candidates.tp1.index_min,
+                                      solution.candidates.tp2.index_min,
+                                      solution.candidates.tp3.index_min);
 
-    return std::tuple<unsigned, unsigned, unsigned, unsigned>(tp1, tp2, tp3, best_d);
+    return std::tuple<unsigned, unsigned, unsigned, unsigned>(std::get<0>(tps),
+                                                              std::get<1>(tps),
+                                                              std::get<2>(tps),
+                                                              solution.candidates.df_max);
   } else {
     return std::tuple<unsigned, unsigned, unsigned, unsigned>(0, 0, 0, 0);
   }
@@ -29,8 +29,12 @@
 #include "LogFile.hpp"
 
 #include <map>
+#include <vector>
+#include <algorithm>
 #include <cstdlib>
 
+class ParallelExecutor;
+
 /**
  * Specialisation of AbstractContest for OLC Triangle (triangle) rules
  */
@@ -158,15 +162,6 @@ private:
       Update(parent, min, max);
     }
 
-    TurnPointRange(const TurnPointRange &other) {
-      index_min = other.index_min;
-      index_max = other.index_max;
-      lon_min = other.lon_min;
-      lon_max = other.lon_max;
-      lat_min = other.lat_min;
-      lat_max = other.lat_max;
-    }
-
     bool operator==(TurnPointRange other) const {
       return (index_min == other.index_min && index_max == other.index_max);
     }
@@ -185,17 +180,18 @@ private:
     }
 
     // updates the bounding box by a given point range
-    void Update(OLCTriangle *parent, unsigned &_min, unsigned &_max) {
-      lon_min = parent->GetPoint(_min).GetFlatLocation().longitude;
-      lon_max = parent->GetPoint(_min).GetFlatLocation().longitude;
-      lat_min = parent->GetPoint(_min).GetFlatLocation().latitude;
-      lat_max = parent->GetPoint(_min).GetFlatLocation().latitude;
+    void Update(const OLCTriangle *parent, unsigned _min, unsigned _max) {
+      const int *const longitudes = parent->GetFlatLongitudes();
+      const int *const latitudes = parent->GetFlatLatitudes();
+
+      lon_min = lon_max = longitudes[_min];
+      lat_min = lat_max = latitudes[_min];
 
       for (unsigned i = _min + 1; i < _max; ++i) {
-        lon_min = std::min(lon_min, parent->GetPoint(i).GetFlatLocation().longitude);
-        lon_max = std::max(lon_max, parent->GetPoint(i).GetFlatLocation().longitude);
-        lat_min = std::min(lat_min, parent->GetPoint(i).GetFlatLocation().latitude);
-        lat_max = std::max(lat_max, parent->GetPoint(i).GetFlatLocation().latitude);
+        lon_min = std::min(lon_min, longitudes[i]);
+        lon_max = std::max(lon_max, longitudes[i]);
+        lat_min = std::min(lat_min, latitudes[i]);
+        lat_max = std::max(lat_max, latitudes[i]);
       }
 
       index_min = _min;
@@ -243,18 +239,25 @@ private:
       tp2.Update(parent, first, last);
       tp3.Update(parent, first, last);
 
-      UpdateDistances();
+      UpdateDistances(parent->is_fai);
     }
 
-    CandidateSet(TurnPointRange _tp1, TurnPointRange _tp2, TurnPointRange _tp3) {
+    CandidateSet(TurnPointRange _tp1, TurnPointRange _tp2, TurnPointRange _tp3,
+                 bool fai) {
       tp1 = _tp1;
       tp2 = _tp2;
       tp3 = _tp3;
 
-      UpdateDistances();
+      UpdateDistances(fai);
     }
 
-    void UpdateDistances() {
+    /**
+     * @param fai limit #df_max to four times the shortest leg; this
+     * bound holds only for FAI triangles, and applying it to other
+     * triangles would prune valid solutions depending on the order
+     * the tree is searched in
+     */
+    void UpdateDistances(bool fai) {
       const unsigned df_12_min = tp1.GetMinDistance(tp2),
                      df_23_min = tp2.GetMinDistance(tp3),
                      df_31_min = tp3.GetMinDistance(tp1);
@@ -269,8 +272,9 @@ private:
 
       df_min = std::max(df_12_min + df_23_min + df_31_min,
                         longest_min * 2);
-      df_max = std::min(df_12_max + df_23_max + df_31_max,
-                        shortest_max * 4);
+      df_max = df_12_max + df_23_max + df_31_max;
+      if (fai)
+        df_max = std::min(df_max, shortest_max * 4);
     }
 
     bool operator==(CandidateSet other) const {
@@ -361,7 +365,75 @@ private:
     }
   };
 
-  std::multimap<unsigned, CandidateSet> branch_and_bound;
+  /**
+   * A priority queue of candidate sets with the largest df_max on
+   * top.  It is a binary heap in a flat array, which avoids one
+   * allocation per node and keeps the nodes close together in memory.
+   */
+  class CandidateHeap {
+    struct Compare {
+      bool operator()(const CandidateSet &a, const CandidateSet &b) const {
+        return a.df_max < b.df_max;
+      }
+    };
+
+    std::vector<CandidateSet> heap;
+
+  public:
+    bool empty() const {
+      return heap.empty();
+    }
+
+    unsigned size() const {
+      return heap.size();
+    }
+
+    void clear() {
+      heap.clear();
+    }
+
+    const CandidateSet &Top() const {
+      return heap.front();
+    }
+
+    void Push(const CandidateSet &candidates) {
+      heap.push_back(candidates);
+      std::push_heap(heap.begin(), heap.end(), Compare());
+    }
+
+    CandidateSet Pop() {
+      std::pop_heap(heap.begin(), heap.end(), Compare());
+      const CandidateSet result = heap.back();
+      heap.pop_back();
+      return result;
+    }
+  };
+
+  /**
+   * The best integral candidate set found by a branch and bound run.
+   */
+  struct Solution {
+    CandidateSet candidates;
+    bool valid;
+
+    Solution():valid(false) {}
+
+    /**
+     * Keep the given integral candidate set if it is better than the
+     * current one.  Ties are broken by the real distance and then by
+     * the turn point indices, which makes the result independent of
+     * the order the tree was searched in.
+     */
+    void Offer(const OLCTriangle &parent, const CandidateSet &other);
+  };
+
+  CandidateHeap branch_and_bound;
+
+  /**
+   * Searches the subtrees of large exhaustive runs concurrently (may
+   * be nullptr).
+   */
+  ParallelExecutor *executor;
 
 public:
   OLCTriangle(const Trace &_trace,
@@ -373,6 +445,18 @@ public:
     incremental = _incremental;
   }
 
+  /**
+   * Use the specified executor for exhaustive searches on long
+   * traces.  All threads share the iteration limit; the tree size
+   * limit applies to each thread.
+   *
+   * @param _executor the executor or nullptr to search in the
+   * calling thread
+   */
+  void SetExecutor(ParallelExecutor *_executor) {
+    executor = _executor;
+  }
+
 protected:
   bool FindClosingPairs(unsigned old_size);
   void SolveTriangle(bool exhaustive);
@@ -380,6 +464,39 @@ protected:
   std::tuple<unsigned, unsigned, unsigned, unsigned>
   RunBranchAndBound(unsigned from, unsigned to, unsigned best_d, bool exhaustive);
 
+private:
+  /**
+   * Search the tree below the given root on the #executor.
+   */
+  Solution RunParallelBranchAndBound(const CandidateSet &root,
+                                     unsigned worst_d,
+                                     unsigned large_triangle_check);
+
+  /**
+   * Check one candidate set.  If it is an integral solution not worse
+   * than worst_d, offer it to the #Solution; otherwise split its
+   * largest range and store the feasible children which may beat
+   * worst_d.
+   *
+   * @return the number of children stored in the array
+   */
+  unsigned ProcessCandidate(const CandidateSet &node, unsigned worst_d,
+                            unsigned large_triangle_check,
+                            Solution &solution, CandidateSet *children);
+
+  /**
+   * Add the children returned by ProcessCandidate() to the heap.  If
+   * the heap has grown too big, the most promising child is returned
+   * in #dive instead, to be processed next; this depth-first descent
+   * finds integral solutions (and thus prunes the heap) quickly.
+   *
+   * @return true if #dive was set
+   */
+  bool PushChildren(CandidateHeap &heap, const CandidateSet *children,
+                    unsigned n, unsigned iterations, CandidateSet &dive) const;
+
+protected:
+
   void UpdateTrace(bool force) override;
   void ResetBranchAndBound();
 
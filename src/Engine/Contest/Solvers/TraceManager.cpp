@@ -98,6 +98,9 @@ TraceManager::ClearTrace()
   trace_dirty = true;
   trace.clear();
   n_points = 0;
+  flat_longitudes.clear();
+  flat_latitudes.clear();
+  altitudes.clear();
   predicted = TracePoint::Invalid();
 }
 
@@ -107,6 +110,7 @@ TraceManager::UpdateTraceFull()
   trace.reserve(trace_master.GetMaxSize());
   trace_master.GetPoints(trace);
   n_points = trace.size();
+  SyncColumns(0);
 
   if (n_points > 0 && predicted.IsDefined())
     predicted.Project(trace_master.GetProjection());
@@ -128,7 +132,9 @@ TraceManager::UpdateTraceTail()
     /* no new points */
     return false;
 
+  const unsigned old_size = n_points;
   n_points = trace.size();
+  SyncColumns(old_size);
 
   if (n_points > 0 && predicted.IsDefined())
     predicted.Project(trace_master.GetProjection());
@@ -137,6 +143,23 @@ TraceManager::UpdateTraceTail()
   return true;
 }
 
+void
+TraceManager::SyncColumns(unsigned first)
+{
+  assert(first <= n_points);
+
+  flat_longitudes.resize(n_points);
+  flat_latitudes.resize(n_points);
+  altitudes.resize(n_points);
+
+  for (unsigned i = first; i < n_points; ++i) {
+    const TracePoint &point = *trace[i];
+    flat_longitudes[i] = point.GetFlatLocation().longitude;
+    flat_latitudes[i] = point.GetFlatLocation().latitude;
+    altitudes[i] = point.GetIntegerAltitude();
+  }
+}
+
 void
 TraceManager::UpdateTrace(bool force)
 {
@@ -29,6 +29,8 @@ Copyright_License {
 #include "Trace/Vector.hpp"
 #include "Trace/Point.hpp"
 
+#include <vector>
+
 class TraceManager {
 protected:
   const Trace &trace_master;
@@ -59,6 +61,17 @@ protected:
   /** Number of points in current trace set */
   unsigned n_points;
 
+  /**
+   * The flat location and altitude of each point in #trace, stored
+   * in contiguous arrays (structure of arrays).  Inner loops use
+   * these instead of dereferencing the #trace pointers, which is
+   * friendlier to the cache and allows the compiler to vectorise
+   * them.  Unlike #trace, these remain valid when the master Trace
+   * gets thinned.
+   */
+  std::vector<int> flat_longitudes, flat_latitudes;
+  std::vector<int> altitudes;
+
   TracePoint predicted;
 
   static constexpr unsigned predicted_index = 0xffff;
@@ -98,6 +111,15 @@ protected:
    */
   bool UpdateTraceTail();
 
+private:
+  /**
+   * Copy the attributes of the points starting at the specified
+   * index from #trace to the arrays.
+   */
+  void SyncColumns(unsigned first);
+
+protected:
+
   gcc_pure
   const TracePoint &GetPoint(unsigned i) const {
     assert(i < n_points);
@@ -105,6 +127,21 @@ protected:
     return *trace[i];
   }
 
+  gcc_pure
+  const int *GetFlatLongitudes() const {
+    return flat_longitudes.data();
+  }
+
+  gcc_pure
+  const int *GetFlatLatitudes() const {
+    return flat_latitudes.data();
+  }
+
+  gcc_pure
+  const int *GetAltitudes() const {
+    return altitudes.data();
+  }
+
   gcc_pure
   bool IsMasterUpdated(bool continuous) const;
 
@@ -25,10 +25,9 @@ Copyright_License {
 #define ASTAR_HPP
 
 #include "Util/ReservablePriorityQueue.hpp"
+#include "Util/DenseHashMap.hpp"
 #include "Compiler.h"
 
-#include <unordered_map>
-
 #ifdef INSTRUMENT_TASK
 extern long count_astar_links;
 #endif
@@ -73,31 +72,40 @@ struct AStarPriorityValue
  * AStar search algorithm, based on Dijkstra algorithm
  * Modifications by John Wharington to track optimal solution
  * @see http://en.giswiki.net/wiki/Dijkstra%27s_algorithm
+ *
+ * The node values and predecessors are kept in one DenseHashMap,
+ * which retains its memory across Clear() calls, so repeated
+ * searches do not allocate once the map has grown to its working
+ * size.
  */
 template <class Node, class Hash=std::hash<Node>,
           class KeyEqual=std::equal_to<Node>,
           bool m_min=true>
 class AStar
 {
-  typedef std::unordered_map<Node, AStarPriorityValue, Hash, KeyEqual> node_value_map;
+  struct NodeData {
+    /** Best value found so far */
+    AStarPriorityValue value;
 
-  typedef typename node_value_map::iterator node_value_iterator;
-  typedef typename node_value_map::const_iterator node_value_const_iterator;
+    /** Predecessor on the best path found so far */
+    Node parent;
 
-  typedef std::unordered_map<Node, Node, Hash, KeyEqual> node_parent_map;
+    constexpr
+    NodeData(const AStarPriorityValue &_value, const Node &_parent)
+      :value(_value), parent(_parent) {}
+  };
 
-  typedef typename node_parent_map::iterator node_parent_iterator;
-  typedef typename node_parent_map::const_iterator node_parent_const_iterator;
+  typedef DenseHashMap<Node, NodeData, Hash, KeyEqual> node_map;
+  typedef typename node_map::size_type node_index;
 
   struct NodeValue {
     AStarPriorityValue priority;
 
-    node_value_iterator iterator;
+    node_index index;
 
     constexpr
-    NodeValue(const AStarPriorityValue &_priority,
-              node_value_iterator _iterator)
-      :priority(_priority), iterator(_iterator) {}
+    NodeValue(const AStarPriorityValue &_priority, node_index _index)
+      :priority(_priority), index(_index) {}
   };
 
   struct Rank: public std::binary_function<NodeValue, NodeValue, bool>
@@ -109,23 +117,18 @@ class AStar
   };
 
   /**
-   * Stores the value of each node.  It is updated by push(), if a
-   * value lower than the current one is found.
-   */
-  node_value_map node_values;
-
-  /**
-   * Stores the predecessor of each node.  It is maintained by
-   * set_predecessor().
+   * Stores the value and the predecessor of each node.  Both are
+   * updated by Push(), if a value lower than the current one is
+   * found.
    */
-  node_parent_map node_parents;
+  node_map nodes;
 
   /**
    * A sorted list of all possible node paths, lowest distance first.
    */
   reservable_priority_queue<NodeValue, std::vector<NodeValue>, Rank> q;
 
-  node_value_iterator cur;
+  node_index cur;
 
 public:
   static constexpr unsigned DEFAULT_QUEUE_SIZE = 1024;
@@ -136,6 +139,7 @@ public:
    * @param is_min Whether this algorithm will search for min or max distance
    */
   AStar(unsigned reserve_default = DEFAULT_QUEUE_SIZE)
+    :cur(node_map::NONE)
   {
     Reserve(reserve_default);
   }
@@ -147,6 +151,7 @@ public:
    * @param is_min Whether this algorithm will search for min or max distance
    */
   AStar(const Node &node, unsigned reserve_default = DEFAULT_QUEUE_SIZE)
+    :cur(node_map::NONE)
   {
     Reserve(reserve_default);
     Push(node, node, AStarPriorityValue(0));
@@ -167,10 +172,9 @@ public:
     // Clear the search queue
     q.clear();
 
-    // Clear the node_parent_map
-    node_parents.clear();
-    // Clear the node_value_map
-    node_values.clear();
+    // Clear the node map (keeping its memory)
+    nodes.clear();
+    cur = node_map::NONE;
   }
 
   /**
@@ -199,14 +203,15 @@ public:
    * @return Node for processing
    */
   const Node &Pop() {
-    cur = q.top().iterator;
+    cur = q.top().index;
 
     do { // remove this item
       q.pop();
-    } while (!q.empty() && (q.top().priority > q.top().iterator->second));
+    } while (!q.empty() &&
+             (q.top().priority > nodes[q.top().index].value.value));
     // and all lower rank than this
 
-    return cur->first;
+    return nodes[cur].key;
   }
 
   /**
@@ -234,9 +239,9 @@ public:
    */
   gcc_pure
   Node GetPredecessor(const Node &node) const {
-    // Try to find the given node in the node_parent_map
-    node_parent_const_iterator it = node_parents.find(node);
-    if (it == node_parents.end())
+    // Try to find the given node in the node map
+    const node_index i = nodes.find(node);
+    if (i == node_map::NONE)
       // first entry
       // If the node wasn't found
       // -> Return the given node itself
@@ -244,7 +249,7 @@ public:
 
     // If the node was found
     // -> Return the parent node
-    return it->second;
+    return nodes[i].value.parent;
   }
 
   /** Reserve queue size (if available) */
@@ -258,14 +263,14 @@ public:
    */
   gcc_pure
   AStarPriorityValue GetNodeValue(const Node &node) const {
-    node_value_const_iterator it = node_values.find(node);
-    if (cur->first == node)
-      return cur->second;
+    if (cur != node_map::NONE && KeyEqual()(nodes[cur].key, node))
+      return nodes[cur].value.value;
 
-    if (it == node_values.end())
+    const node_index i = nodes.find(node);
+    if (i == node_map::NONE)
       return AStarPriorityValue(0);
 
-    return it->second;
+    return nodes[i].value.value;
   }
 
 private:
@@ -278,39 +283,22 @@ private:
    */
   void Push(const Node &node, const Node &parent,
             const AStarPriorityValue &edge_value) {
-    // Try to find the given node n in the node_value_map
-    node_value_iterator it = node_values.find(node);
-    if (it == node_values.end()) {
-      // first entry
-      // If the node wasn't found
-      // -> Insert a new node into the node_value_map
-      it = node_values.insert(std::make_pair(node, edge_value)).first;
-
-      // Remember the parent node
-      SetPredecessor(node, parent);
-    } else if (it->second > edge_value) {
-      // If the node was found and the new value is smaller
-      // -> Replace the value with the new one
-      it->second = edge_value;
-      // replace, it's bigger
-
-      // Remember the new parent node
-      SetPredecessor(node, parent);
-    } else
-      // If the node was found but the value is higher or equal
-      // -> Don't use this new leg
-      return;
-
-    q.push(NodeValue(edge_value, it));
-  }
+    // Try to insert the given node n into the node map
+    const auto result = nodes.insert(node, NodeData(edge_value, parent));
+    if (!result.second) {
+      NodeData &data = nodes[result.first].value;
+      if (data.value > edge_value) {
+        // If the node was found and the new value is smaller
+        // -> Replace the value and the parent node with the new ones
+        data.value = edge_value;
+        data.parent = parent;
+      } else
+        // If the node was found but the value is higher or equal
+        // -> Don't use this new leg
+        return;
+    }
 
-  void SetPredecessor(const Node &node, const Node &parent) {
-    // Try to find the given node in the node_parent_map
-    auto result = node_parents.insert(std::make_pair(node, parent));
-    if (!result.second)
-      // If the node was found
-      // -> Replace the according parent node with the new one
-      result.first->second = parent;
+    q.push(NodeValue(edge_value, result.first));
   }
 };
 
@@ -26,6 +26,7 @@
 #include "ReachFanParms.hpp"
 #include "Util/GlobalSliceAllocator.hpp"
 #include "Geo/Flat/FlatProjection.hpp"
+#include "Util/ParallelExecutor.hpp"
 
 #define REACH_BUFFER 1
 #define REACH_SWEEP (ROUTEPOLAR_Q1-REACH_BUFFER)
@@ -164,8 +165,28 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
   assert(vs.empty());
   vs.reserve(index_high - index_low + 1);
   AddPoint(origin);
-  for (int index = index_low; index < index_high; ++index) {
-    const FlatGeoPoint x = parms.reach_intercept(index, ao);
+
+  const unsigned n = index_high - index_low;
+  FlatGeoPoint intercepts[ROUTEPOLAR_POINTS + 1];
+  assert(n <= ROUTEPOLAR_POINTS + 1);
+
+  if (parms.executor != nullptr && n > 1) {
+    /* each direction is an independent terrain intersection search;
+       these are the expensive part, so they are calculated
+       concurrently; the tree itself is only modified by this
+       thread */
+    const ReachFanParms &const_parms = parms;
+    parms.executor->ForEach(n, [&const_parms, &ao, &intercepts,
+                                index_low](unsigned i){
+        intercepts[i] = const_parms.reach_intercept(index_low + i, ao);
+      });
+  } else {
+    for (unsigned i = 0; i < n; ++i)
+      intercepts[i] = parms.reach_intercept(index_low + i, ao);
+  }
+
+  for (unsigned i = 0; i < n; ++i) {
+    const FlatGeoPoint &x = intercepts[i];
     /* hao: if reach_intercept() did not find anything reasonable it returns
      *      a FlatGeoPoint that is almost the same as origin, but differs
      *      +/- 1 due to conversion errors. The resulting polygon can have
@@ -211,17 +232,30 @@ FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint &o,
     return;
   }
 
-  for (const auto &x : vs) {
-    const FlatGeoPoint av = (o + x) * fixed(0.5);
-    const GeoPoint p = parms.projection.Unproject(av);
-    short h = parms.terrain->GetHeight(p);
-
-    if (RasterBuffer::IsWater(h))
-      /* water: assume 0m MSL */
-      parms.terrain_counter++;
-    else if (!RasterBuffer::IsInvalid(h)) {
-      parms.terrain_counter++;
-      parms.terrain_base += h;
+  /* query the terrain in batches; the vertices are ordered along
+     the fan, so most lookups hit the same tile as the previous one */
+  constexpr unsigned CHUNK_SIZE = 64;
+  GeoPoint points[CHUNK_SIZE];
+  short heights[CHUNK_SIZE];
+
+  for (auto i = vs.cbegin(), end = vs.cend(); i != end;) {
+    unsigned n = 0;
+    for (; i != end && n < CHUNK_SIZE; ++i, ++n) {
+      const FlatGeoPoint av = (o + *i) * fixed(0.5);
+      points[n] = parms.projection.Unproject(av);
+    }
+
+    parms.terrain->GetHeights(ConstBuffer<GeoPoint>(points, n), heights);
+
+    for (unsigned j = 0; j < n; ++j) {
+      const short h = heights[j];
+      if (RasterBuffer::IsWater(h))
+        /* water: assume 0m MSL */
+        parms.terrain_counter++;
+      else if (!RasterBuffer::IsInvalid(h)) {
+        parms.terrain_counter++;
+        parms.terrain_base += h;
+      }
     }
   }
 
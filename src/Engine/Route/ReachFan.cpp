@@ -33,21 +33,55 @@ ReachFan::Reset()
   terrain_base = 0;
 }
 
+/**
+ * The height available for gliding from the specified origin, see
+ * RoutePolars::ReachIntercept().
+ */
+static fixed
+GetGlideHeight(const AGeoPoint &origin, const RoutePolars &rpolars)
+{
+  const RoughAltitude height = origin.altitude - rpolars.GetSafetyHeight();
+  return std::max(fixed(height), fixed(0));
+}
+
+fixed
+ReachFan::GetStaleness(const AGeoPoint origin,
+                       const RoutePolars &rpolars) const
+{
+  assert(!root.IsEmpty());
+
+  const fixed height = GetGlideHeight(origin, rpolars);
+
+  fixed delta_range = fixed(0);
+  for (unsigned i = 0; i < ROUTEPOLAR_POINTS; ++i)
+    delta_range = std::max(delta_range,
+                           fabs(rpolars.GetGlideRange(i, height) -
+                                solved_range[i]));
+
+  return projection.GetCenter().DistanceS(origin) + delta_range;
+}
+
 bool
 ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
-                const RasterMap* terrain, const bool do_solve)
+                const RasterMap* terrain, const bool do_solve,
+                ParallelExecutor *executor)
 {
   Reset();
 
   // initialise projection
   projection = FlatProjection(origin);
 
+  const fixed glide_height = GetGlideHeight(origin, rpolars);
+  for (unsigned i = 0; i < ROUTEPOLAR_POINTS; ++i)
+    solved_range[i] = rpolars.GetGlideRange(i, glide_height);
+
   const short h = terrain
     ? terrain->GetHeight(origin)
     : RasterBuffer::TERRAIN_INVALID;
   const RoughAltitude h2(RasterBuffer::IsSpecial(h) ? 0 : h);
 
-  ReachFanParms parms(rpolars, projection, (int)terrain_base, terrain);
+  ReachFanParms parms(rpolars, projection, (int)terrain_base, terrain,
+                      executor);
   const AFlatGeoPoint ao(projection.ProjectInteger(origin), origin.altitude);
 
   if (!RasterBuffer::IsInvalid(h) &&
@@ -25,11 +25,13 @@
 
 #include "Geo/Flat/FlatProjection.hpp"
 #include "FlatTriangleFanTree.hpp"
+#include "Route/RoutePolar.hpp"
 #include "Rough/RoughAltitude.hpp"
 
 class RoutePolars;
 class RasterMap;
 class GeoBounds;
+class ParallelExecutor;
 struct ReachResult;
 
 class ReachFan
@@ -38,6 +40,12 @@ class ReachFan
   FlatTriangleFanTree root;
   RoughAltitude terrain_base;
 
+  /**
+   * The terrain-independent glide range in each polar direction at
+   * the time of the last Solve() call; used by GetStaleness().
+   */
+  fixed solved_range[ROUTEPOLAR_POINTS];
+
 public:
   ReachFan():terrain_base(0) {}
 
@@ -49,12 +57,31 @@ public:
 
   void Reset();
 
+  /**
+   * @param executor if not nullptr, then the fan directions are
+   * calculated concurrently with this object
+   */
   bool Solve(const AGeoPoint origin, const RoutePolars &rpolars,
-             const RasterMap *terrain, const bool do_solve = true);
+             const RasterMap *terrain, const bool do_solve = true,
+             ParallelExecutor *executor = nullptr);
 
   bool FindPositiveArrival(const AGeoPoint dest, const RoutePolars &rpolars,
                            ReachResult &result_r) const;
 
+  /**
+   * Estimate how far (in metres) the boundary of the current solution
+   * may be off for the specified origin and polar: the horizontal
+   * displacement of the origin plus the largest change of the glide
+   * range in any direction.  This allows the caller to skip Solve()
+   * while the solution is still good enough.  Terrain which is
+   * cleared (or hit) only due to the change is not accounted for, so
+   * the caller should still re-solve periodically.
+   *
+   * Must not be called when the fan is empty.
+   */
+  gcc_pure
+  fixed GetStaleness(const AGeoPoint origin, const RoutePolars &rpolars) const;
+
   bool IsInside(const GeoPoint origin, const bool turning = true) const;
 
   void AcceptInRange(const GeoBounds& bounds,
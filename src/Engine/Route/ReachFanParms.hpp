@@ -27,11 +27,19 @@
 
 class FlatProjection;
 class RasterMap;
+class ParallelExecutor;
 
 struct ReachFanParms {
   const RoutePolars &rpolars;
   const FlatProjection &projection;
   const RasterMap* terrain;
+
+  /**
+   * If not nullptr, then the fan directions are calculated
+   * concurrently with this object.
+   */
+  ParallelExecutor *executor;
+
   int terrain_base;
   unsigned terrain_counter;
   unsigned fan_counter;
@@ -41,8 +49,10 @@ struct ReachFanParms {
   ReachFanParms(const RoutePolars& _rpolars,
                 const FlatProjection &_projection,
                 const short _terrain_base,
-                const RasterMap* _terrain=NULL):
+                const RasterMap* _terrain=NULL,
+                ParallelExecutor *_executor=nullptr):
     rpolars(_rpolars), projection(_projection), terrain(_terrain),
+    executor(_executor),
     terrain_base(_terrain_base),
     terrain_counter(0),
     fan_counter(0),
@@ -25,7 +25,7 @@
 #include "Geo/Flat/FlatProjection.hpp"
 
 RoutePlanner::RoutePlanner()
-  :terrain(NULL), planner(0),
+  :terrain(NULL), executor(nullptr), planner(0),
    unique_links(50000),
    reach_polar_mode(RoutePlannerConfig::Polar::TASK)
 {
@@ -61,7 +61,7 @@ RoutePlanner::SolveReach(const AGeoPoint &origin,
   rpolars_reach.SetConfig(config, origin.altitude, h_ceiling);
   reach_polar_mode = config.reach_polar_mode;
 
-  return reach.Solve(origin, rpolars_reach, terrain, do_solve);
+  return reach.Solve(origin, rpolars_reach, terrain, do_solve, executor);
 }
 
 bool
@@ -277,7 +277,7 @@ RoutePlanner::LinkCleared(const RouteLink &e)
 bool
 RoutePlanner::IsSetUnique(const RouteLinkBase &e)
 {
-  const bool inserted = unique_links.insert(e).second;
+  const bool inserted = unique_links.insert(e);
   if (inserted)
     return true;
 
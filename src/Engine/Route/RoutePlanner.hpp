@@ -30,12 +30,13 @@
 #include "Geo/Flat/FlatProjection.hpp"
 #include "Geo/SearchPointVector.hpp"
 #include "ReachFan.hpp"
+#include "Util/DenseHashMap.hpp"
 
 #include <utility>
 #include <algorithm>
-#include <unordered_set>
 
 class GlidePolar;
+class ParallelExecutor;
 
 /**
  * RoutePlanner is an abstract class for planning paths (routes) through
@@ -109,6 +110,8 @@ protected:
   RoutePolars rpolars_reach;
   /** Terrain raster */
   const RasterMap *terrain;
+  /** Calculates the reach fan concurrently (may be nullptr) */
+  ParallelExecutor *executor;
   /** Minimum height scanned during solution (m) */
   RoughAltitude h_min;
   /** Maxmimum height scanned during solution (m) */
@@ -124,7 +127,7 @@ private:
    */
   SearchPointVector search_hull;
 
-  typedef std::unordered_set<RouteLinkBase, RouteLinkBaseHasher> RouteLinkSet;
+  typedef DenseHashSet<RouteLinkBase, RouteLinkBaseHasher> RouteLinkSet;
 
   /** Links that have been visited during solution */
   RouteLinkSet unique_links;
@@ -171,10 +174,30 @@ public:
     terrain = _terrain;
   }
 
+  /**
+   * Set the executor which is used to calculate the reach fan
+   * concurrently.  It must be thread-safe to access the terrain
+   * concurrently from all threads of this executor while
+   * SolveReach() runs.
+   */
+  void SetExecutor(ParallelExecutor *_executor) {
+    executor = _executor;
+  }
+
   bool IsReachEmpty() const {
     return reach.IsEmpty();
   }
 
+  /**
+   * Estimate how far the reach solution is off for the specified
+   * origin, see ReachFan::GetStaleness().  Must not be called when
+   * the reach is empty.
+   */
+  gcc_pure
+  fixed GetReachStaleness(const AGeoPoint &origin) const {
+    return reach.GetStaleness(origin, rpolars_reach);
+  }
+
   /**
    * Delete all reach fans.
    */
@@ -232,6 +232,18 @@ public:
     return RoughAltitude(config.safety_height_terrain);
   }
 
+  /**
+   * Calculate the distance which can be covered by gliding in the
+   * specified polar direction with the specified loss of height,
+   * ignoring terrain.
+   *
+   * @param index the polar direction (0..ROUTEPOLAR_POINTS-1)
+   */
+  gcc_pure
+  fixed GetGlideRange(unsigned index, fixed height) const {
+    return height * polar_glide.GetPoint(index).inv_gradient;
+  }
+
   FlatGeoPoint ReachIntercept(const int index, const AGeoPoint& p,
                               const RasterMap* map,
                               const FlatProjection &proj) const;
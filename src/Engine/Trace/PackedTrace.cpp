@@ -0,0 +1,241 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "PackedTrace.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Math/FastMath.h"
+
+#include <assert.h>
+
+/**
+ * The resolution of the stored locations [1/degrees].
+ */
+static constexpr double LOCATION_SCALE = 1e7;
+
+/* bits of the first byte of each fix; the low bits contain the time
+   delta, or DT_ESCAPE if a full varint follows */
+static constexpr unsigned DT_BITS = 5;
+static constexpr unsigned DT_ESCAPE = (1u << DT_BITS) - 1;
+static constexpr uint8_t VARIO_CHANGED = 0x20;
+static constexpr uint8_t NOISE_CHANGED = 0x40;
+static constexpr uint8_t DRIFT_CHANGED = 0x80;
+
+static void
+WriteVarint(std::vector<uint8_t> &data, unsigned value)
+{
+  while (value >= 0x80) {
+    data.push_back(uint8_t(value | 0x80));
+    value >>= 7;
+  }
+
+  data.push_back(uint8_t(value));
+}
+
+static const uint8_t *
+ReadVarint(const uint8_t *p, unsigned &value)
+{
+  value = 0;
+  unsigned shift = 0;
+  uint8_t byte;
+  do {
+    byte = *p++;
+    value |= unsigned(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+
+  return p;
+}
+
+/**
+ * Map signed to unsigned integers, so small negative values get short
+ * encodings.
+ */
+gcc_const
+static unsigned
+ZigZagEncode(int value)
+{
+  return (unsigned(value) << 1) ^ unsigned(value >> 31);
+}
+
+gcc_const
+static int
+ZigZagDecode(unsigned value)
+{
+  return int(value >> 1) ^ -int(value & 1);
+}
+
+static void
+WriteSigned(std::vector<uint8_t> &data, int value)
+{
+  WriteVarint(data, ZigZagEncode(value));
+}
+
+static const uint8_t *
+ReadSigned(const uint8_t *p, int &value)
+{
+  unsigned encoded;
+  p = ReadVarint(p, encoded);
+  value += ZigZagDecode(encoded);
+  return p;
+}
+
+PackedTrace::State
+PackedTrace::State::Import(const TracePoint &point)
+{
+  const GeoPoint &location = point.GetLocation();
+
+  State state;
+  state.time = point.GetTime();
+  state.longitude = iround(location.longitude.Degrees() * LOCATION_SCALE);
+  state.latitude = iround(location.latitude.Degrees() * LOCATION_SCALE);
+  state.altitude = point.GetIntegerAltitude();
+  state.vario = iround(point.GetVario() * 256);
+  state.engine_noise_level = point.GetEngineNoiseLevel();
+  state.drift_factor = point.GetDriftFactor();
+  return state;
+}
+
+TracePoint
+PackedTrace::State::Export() const
+{
+  const GeoPoint location(Angle::Degrees(fixed(longitude / LOCATION_SCALE)),
+                          Angle::Degrees(fixed(latitude / LOCATION_SCALE)));
+
+  TracePoint point(location, time, altitude, fixed(vario) / 256,
+                   drift_factor);
+  point.SetEngineNoiseLevel(engine_noise_level);
+  return point;
+}
+
+void
+PackedTrace::Encode(const State &state)
+{
+  const unsigned dt = state.time - last.time;
+
+  uint8_t flags = dt < DT_ESCAPE ? uint8_t(dt) : uint8_t(DT_ESCAPE);
+  if (state.vario != last.vario)
+    flags |= VARIO_CHANGED;
+  if (state.engine_noise_level != last.engine_noise_level)
+    flags |= NOISE_CHANGED;
+  if (state.drift_factor != last.drift_factor)
+    flags |= DRIFT_CHANGED;
+
+  data.push_back(flags);
+  if (dt >= DT_ESCAPE)
+    WriteVarint(data, dt);
+
+  WriteSigned(data, state.longitude - last.longitude);
+  WriteSigned(data, state.latitude - last.latitude);
+  WriteSigned(data, state.altitude - last.altitude);
+
+  if (flags & VARIO_CHANGED)
+    WriteSigned(data, state.vario - last.vario);
+  if (flags & NOISE_CHANGED)
+    WriteVarint(data, state.engine_noise_level);
+  if (flags & DRIFT_CHANGED)
+    WriteVarint(data, state.drift_factor);
+
+  last = state;
+}
+
+const uint8_t *
+PackedTrace::Decode(const uint8_t *p, State &state)
+{
+  const uint8_t flags = *p++;
+
+  unsigned dt = flags & DT_ESCAPE;
+  if (dt == DT_ESCAPE)
+    p = ReadVarint(p, dt);
+  state.time += dt;
+
+  p = ReadSigned(p, state.longitude);
+  p = ReadSigned(p, state.latitude);
+  p = ReadSigned(p, state.altitude);
+
+  if (flags & VARIO_CHANGED)
+    p = ReadSigned(p, state.vario);
+  if (flags & NOISE_CHANGED)
+    p = ReadVarint(p, state.engine_noise_level);
+  if (flags & DRIFT_CHANGED)
+    p = ReadVarint(p, state.drift_factor);
+
+  return p;
+}
+
+TracePoint
+PackedTrace::const_iterator::operator*() const
+{
+  State state = previous;
+  Decode(position, state);
+  return state.Export();
+}
+
+PackedTrace::const_iterator &
+PackedTrace::const_iterator::operator++()
+{
+  position = Decode(position, previous);
+  return *this;
+}
+
+void
+PackedTrace::clear()
+{
+  data.clear();
+  count = 0;
+  last.Clear();
+  ++reset_serial;
+}
+
+void
+PackedTrace::push_back(const TracePoint &point)
+{
+  if (count > 0 && point.GetTime() <= last.time) {
+    if (point.GetTime() + 180 < last.time)
+      /* gone back in time; not fixable, restart from scratch */
+      clear();
+    else
+      return;
+  }
+
+  Encode(State::Import(point));
+  ++count;
+}
+
+bool
+PackedTrace::Sync(const PackedTrace &other)
+{
+  if (reset_serial == other.reset_serial && count <= other.count &&
+      data.size() <= other.data.size()) {
+    if (count == other.count)
+      return false;
+
+    data.insert(data.end(), other.data.begin() + data.size(),
+                other.data.end());
+  } else
+    data = other.data;
+
+  count = other.count;
+  last = other.last;
+  reset_serial = other.reset_serial;
+  return true;
+}
@@ -0,0 +1,193 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef PACKED_TRACE_HPP
+#define PACKED_TRACE_HPP
+
+#include "Point.hpp"
+#include "Util/Serial.hpp"
+
+#include <vector>
+#include <iterator>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * An append-only store of all fixes of a flight, unlike #Trace
+ * without thinning.  Each fix is delta-encoded against the previous
+ * one with variable-length integers, which takes about 7 bytes per
+ * fix.
+ *
+ * Time, altitude, vario, engine noise level and drift factor are
+ * stored without loss.  The location is rounded to 1e-7 degrees
+ * (about 1 cm), well below the GPS accuracy.  The flat projection of
+ * the points is not stored.
+ */
+class PackedTrace {
+  /**
+   * The attributes of a fix in the integer units used for encoding.
+   */
+  struct State {
+    unsigned time;
+    int longitude, latitude;
+    int altitude, vario;
+    unsigned engine_noise_level, drift_factor;
+
+    void Clear() {
+      time = 0;
+      longitude = latitude = 0;
+      altitude = vario = 0;
+      engine_noise_level = 0;
+      drift_factor = 0;
+    }
+
+    static State Import(const TracePoint &point);
+    TracePoint Export() const;
+  };
+
+  std::vector<uint8_t> data;
+
+  unsigned count;
+
+  /**
+   * The last fix, which the next one is encoded against.
+   */
+  State last;
+
+  /**
+   * Incremented by clear(); used by Sync() to find out whether the
+   * destination is a prefix of the source.
+   */
+  Serial reset_serial;
+
+public:
+  /**
+   * Decodes the fixes in chronological order.
+   */
+  class const_iterator {
+    friend class PackedTrace;
+
+    /**
+     * The beginning of the current fix.
+     */
+    const uint8_t *position;
+
+    /**
+     * The previous fix, which the current one is encoded against.
+     */
+    State previous;
+
+    explicit const_iterator(const uint8_t *_position)
+      :position(_position) {
+      previous.Clear();
+    }
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef TracePoint value_type;
+    typedef const TracePoint *pointer;
+    typedef TracePoint reference;
+    typedef ptrdiff_t difference_type;
+
+    TracePoint operator*() const;
+
+    const_iterator &operator++();
+
+    bool operator==(const const_iterator &other) const {
+      return position == other.position;
+    }
+
+    bool operator!=(const const_iterator &other) const {
+      return position != other.position;
+    }
+  };
+
+  PackedTrace():count(0) {
+    last.Clear();
+  }
+
+  unsigned size() const {
+    return count;
+  }
+
+  bool empty() const {
+    return count == 0;
+  }
+
+  /**
+   * Returns the time of the last fix.
+   */
+  unsigned GetLastTime() const {
+    assert(!empty());
+
+    return last.time;
+  }
+
+  /**
+   * Returns the number of bytes allocated for the encoded fixes.
+   */
+  size_t GetMemoryUsage() const {
+    return data.capacity();
+  }
+
+  void clear();
+
+  /**
+   * Append a fix.  Fixes which are not newer than the last one are
+   * ignored; if the time goes back by more than 3 minutes, the store
+   * is cleared and restarted, like #Trace does.
+   */
+  void push_back(const TracePoint &point);
+
+  /**
+   * Make this object a copy of the other one.  If this object
+   * contains a prefix of the other one (i.e. it was synchronised
+   * before, and the other one has not been cleared since), only the
+   * new fixes are copied.
+   *
+   * @return true if fixes were added or removed
+   */
+  bool Sync(const PackedTrace &other);
+
+  const_iterator begin() const {
+    return const_iterator(data.data());
+  }
+
+  const_iterator end() const {
+    return const_iterator(data.data() + data.size());
+  }
+
+private:
+  void Encode(const State &state);
+
+  /**
+   * Decode one fix, replacing the previous one in #state.
+   *
+   * @return the beginning of the next fix
+   */
+  static const uint8_t *Decode(const uint8_t *p, State &state);
+};
+
+#endif
@@ -140,6 +140,14 @@ public:
     return engine_noise_level;
   }
 
+  void SetEngineNoiseLevel(unsigned _level) {
+    engine_noise_level = _level;
+  }
+
+  unsigned GetDriftFactor() const {
+    return drift_factor;
+  }
+
   /**
    * Returns the altitude as an integer.  Some calculations may not
    * need the fractional part.
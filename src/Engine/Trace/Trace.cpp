@@ -23,41 +23,161 @@ Copyright_License {
 
 #include "Trace.hpp"
 #include "Vector.hpp"
-#include "Util/GlobalSliceAllocator.hpp"
 
 #include <algorithm>
 
 Trace::Trace(const unsigned _no_thin_time, const unsigned max_time,
              const unsigned max_size)
-  :cached_size(0),
+  :free_head(NONE),
+   cached_size(0),
    max_time(max_time),
    no_thin_time(_no_thin_time),
    max_size(max_size),
    opt_size((3 * max_size) / 4)
 {
   assert(max_size >= 4);
+
+  /* push_back() thins before the size reaches max_size, so there are
+     never more than max_size points plus the list head */
+  nodes.reserve(max_size + 1);
+  nodes.emplace_back(TracePoint::Invalid());
+
+  heap.reserve(max_size);
 }
 
 void
 Trace::clear()
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  assert(cached_size == heap.size());
 
   average_delta_distance = 0;
   average_delta_time = 0;
 
-  delta_list.clear();
-  chronological_list.clear_and_dispose(MakeDisposer());
+  nodes.erase(std::next(nodes.begin()), nodes.end());
+  nodes[HEAD].previous = nodes[HEAD].next = HEAD;
+  free_head = NONE;
+  heap.clear();
   cached_size = 0;
 
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-
   ++modify_serial;
   ++append_serial;
 }
 
+unsigned
+Trace::AllocateNode(const TracePoint &point)
+{
+  unsigned i;
+  if (free_head != NONE) {
+    i = free_head;
+    free_head = nodes[i].next;
+    nodes[i] = TraceDelta(point);
+  } else {
+    assert(nodes.size() < nodes.capacity());
+
+    i = nodes.size();
+    nodes.emplace_back(point);
+  }
+
+  return i;
+}
+
+void
+Trace::FreeNode(unsigned i)
+{
+  assert(i != HEAD);
+  assert(cached_size > 0);
+
+  TraceDelta &td = nodes[i];
+  nodes[td.previous].next = td.next;
+  nodes[td.next].previous = td.previous;
+
+  HeapRemove(i);
+
+  td.next = free_head;
+  free_head = i;
+
+  --cached_size;
+}
+
+void
+Trace::HeapSiftUp(unsigned position)
+{
+  const unsigned i = heap[position];
+  while (position > 0) {
+    const unsigned parent = (position - 1) / 2;
+    if (!HeapLess(i, heap[parent]))
+      break;
+
+    HeapSet(position, heap[parent]);
+    position = parent;
+  }
+
+  HeapSet(position, i);
+}
+
+void
+Trace::HeapSiftDown(unsigned position)
+{
+  const unsigned n = heap.size();
+  const unsigned i = heap[position];
+  while (true) {
+    unsigned child = 2 * position + 1;
+    if (child >= n)
+      break;
+
+    if (child + 1 < n && HeapLess(heap[child + 1], heap[child]))
+      ++child;
+
+    if (!HeapLess(heap[child], i))
+      break;
+
+    HeapSet(position, heap[child]);
+    position = child;
+  }
+
+  HeapSet(position, i);
+}
+
+void
+Trace::HeapPush(unsigned i)
+{
+  assert(nodes[i].heap_index == NONE);
+
+  heap.push_back(i);
+  HeapSiftUp(heap.size() - 1);
+}
+
+void
+Trace::HeapRemove(unsigned i)
+{
+  const unsigned position = nodes[i].heap_index;
+  if (position == NONE)
+    return;
+
+  nodes[i].heap_index = NONE;
+
+  const unsigned last = heap.back();
+  heap.pop_back();
+  if (last == i)
+    return;
+
+  HeapSet(position, last);
+  HeapUpdate(last);
+}
+
+void
+Trace::HeapUpdate(unsigned i)
+{
+  const unsigned position = nodes[i].heap_index;
+  if (position == NONE)
+    return;
+
+  if (position > 0 && HeapLess(i, heap[(position - 1) / 2]))
+    HeapSiftUp(position);
+  else
+    HeapSiftDown(position);
+}
+
 unsigned
 Trace::GetRecentTime(const unsigned t) const
 {
@@ -72,43 +192,30 @@ Trace::GetRecentTime(const unsigned t) const
 }
 
 void
-Trace::UpdateDelta(TraceDelta &td)
+Trace::UpdateDelta(unsigned i)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  assert(i != HEAD);
 
-  if (&td == &chronological_list.front() ||
-      &td == &chronological_list.back())
+  TraceDelta &td = nodes[i];
+  if (td.previous == HEAD || td.next == HEAD)
     return;
 
-  const auto ci = chronological_list.iterator_to(td);
-  const TraceDelta &previous = *std::prev(ci);
-  const TraceDelta &next = *std::next(ci);
-
-  delta_list.erase(delta_list.iterator_to(td));
-  td.Update(previous.point, next.point);
-  delta_list.insert(td);
+  td.Update(nodes[td.previous].point, nodes[td.next].point);
+  HeapUpdate(i);
 }
 
 void
-Trace::EraseInside(DeltaList::iterator it)
+Trace::EraseInside(unsigned i)
 {
   assert(cached_size > 0);
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-  assert(it != delta_list.end());
-
-  const TraceDelta &td = *it;
-  assert(!td.IsEdge());
+  assert(cached_size == heap.size() + suppressed.size());
+  assert(!nodes[i].IsEdge());
 
-  const auto ci = chronological_list.iterator_to(td);
-  TraceDelta &previous = const_cast<TraceDelta &>(*std::prev(ci));
-  TraceDelta &next = const_cast<TraceDelta &>(*std::next(ci));
+  const unsigned previous = nodes[i].previous;
+  const unsigned next = nodes[i].next;
 
   // now delete the item
-  chronological_list.erase(chronological_list.iterator_to(td));
-  delta_list.erase_and_dispose(it, MakeDisposer());
-  --cached_size;
+  FreeNode(i);
 
   // and update the deltas
   UpdateDelta(previous);
@@ -118,8 +225,7 @@ Trace::EraseInside(DeltaList::iterator it)
 bool
 Trace::EraseDelta(const unsigned target_size, const unsigned recent)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  assert(cached_size == heap.size());
 
   if (size() <= 2)
     return false;
@@ -128,40 +234,41 @@ Trace::EraseDelta(const unsigned target_size, const unsigned recent)
 
   const unsigned recent_time = GetRecentTime(recent);
 
-  auto candidate = delta_list.begin();
-  while (size() > target_size) {
-    const TraceDelta &td = *candidate;
+  /* nodes whose removal is suppressed are taken out of the heap
+     until the target size is reached, to uncover the next candidate;
+     their time does not change, so they remain suppressed */
+  assert(suppressed.empty());
+
+  while (size() > target_size && !heap.empty()) {
+    const unsigned i = heap.front();
+    const TraceDelta &td = nodes[i];
     if (!td.IsEdge() && td.point.GetTime() < recent_time) {
-      EraseInside(candidate);
-      candidate = delta_list.begin(); // find new top
+      EraseInside(i);
       modified = true;
     } else {
-      ++candidate;
       // suppressed removal, skip it.
+      HeapRemove(i);
+      suppressed.push_back(i);
     }
   }
 
+  for (unsigned i : suppressed)
+    HeapPush(i);
+  suppressed.clear();
+
   return modified;
 }
 
 bool
 Trace::EraseEarlierThan(const unsigned p_time)
 {
-  if (p_time == 0 || empty() || GetFront().point.GetTime() >= p_time)
+  if (p_time == 0 || empty() || front().GetTime() >= p_time)
     // there will be nothing to remove
     return false;
 
   do {
-    auto ci = chronological_list.begin();
-    TraceDelta &td = *ci;
-    chronological_list.erase(ci);
-
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase_and_dispose(i, MakeDisposer());
-
-    --cached_size;
-  } while (!empty() && GetFront().point.GetTime() < p_time);
+    FreeNode(GetFront());
+  } while (!empty() && front().GetTime() < p_time);
 
   // need to set deltas for first point, only one of these
   // will occur (have to search for this point)
@@ -179,17 +286,8 @@ Trace::EraseLaterThan(const unsigned min_time)
   assert(min_time > 0);
   assert(!empty());
 
-  while (!empty() && GetBack().point.GetTime() > min_time) {
-    TraceDelta &td = GetBack();
-
-    chronological_list.erase(chronological_list.iterator_to(td));
-
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase_and_dispose(i, MakeDisposer());
-
-    --cached_size;
-  }
+  while (!empty() && back().GetTime() > min_time)
+    FreeNode(GetBack());
 
   /* need to set deltas for first point, only one of these will occur
      (have to search for this point) */
@@ -201,21 +299,19 @@ Trace::EraseLaterThan(const unsigned min_time)
  * Update start node (and neighbour) after min time pruning
  */
 void
-Trace::EraseStart(TraceDelta &td)
+Trace::EraseStart(unsigned i)
 {
-  delta_list.erase(delta_list.iterator_to(td));
-
+  TraceDelta &td = nodes[i];
   td.elim_distance = null_delta;
   td.elim_time = null_time;
 
-  delta_list.insert(td);
+  HeapUpdate(i);
 }
 
 void
 Trace::push_back(const TracePoint &point)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  assert(cached_size == heap.size());
 
   if (empty()) {
     // first point determines origin for flat projection
@@ -244,17 +340,23 @@ Trace::push_back(const TracePoint &point)
 
   assert(size() < max_size);
 
-  TraceDelta *td = allocator.allocate(1);
-  allocator.construct(td, point);
-  td->point.Project(task_projection);
+  const unsigned i = AllocateNode(point);
+  TraceDelta &td = nodes[i];
+  td.point.Project(task_projection);
+
+  /* append to the chronological list */
+  const unsigned previous = nodes[HEAD].previous;
+  td.previous = previous;
+  td.next = HEAD;
+  nodes[previous].next = i;
+  nodes[HEAD].previous = i;
 
-  delta_list.insert(*td);
-  chronological_list.push_back(*td);
+  HeapPush(i);
 
   ++cached_size;
 
-  if (td != &chronological_list.front())
-    UpdateDelta(*std::prev(chronological_list.iterator_to(*td)));
+  if (previous != HEAD)
+    UpdateDelta(previous);
 
   ++append_serial;
 }
@@ -266,10 +368,10 @@ Trace::CalcAverageDeltaDistance(const unsigned no_thin) const
   unsigned acc = 0;
   unsigned counter = 0;
 
-  const auto end = chronological_list.end();
-  for (auto it = chronological_list.begin();
-       it != end && it->point.GetTime() < r; ++it, ++counter)
-    acc += it->delta_distance;
+  for (unsigned i = nodes[HEAD].next;
+       i != HEAD && nodes[i].point.GetTime() < r;
+       i = nodes[i].next, ++counter)
+    acc += nodes[i].delta_distance;
 
   if (counter)
     return acc / counter;
@@ -284,19 +386,19 @@ Trace::CalcAverageDeltaTime(const unsigned no_thin) const
   unsigned counter = 0;
 
   /* find the last item before the "r" timestamp */
-  const auto end = chronological_list.end();
-  ChronologicalList::const_iterator it;
-  for (it = chronological_list.begin(); it != end && it->point.GetTime() < r; ++it)
+  unsigned i;
+  for (i = nodes[HEAD].next; i != HEAD && nodes[i].point.GetTime() < r;
+       i = nodes[i].next)
     ++counter;
 
   if (counter < 2)
     return 0;
 
-  --it;
+  i = nodes[i].previous;
   --counter;
 
   unsigned start_time = front().GetTime();
-  unsigned end_time = it->point.GetTime();
+  unsigned end_time = nodes[i].point.GetTime();
   return (end_time - start_time) / counter;
 }
 
@@ -337,8 +439,7 @@ Trace::Thin2()
 void
 Trace::Thin()
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  assert(cached_size == heap.size());
   assert(size() == max_size);
 
   Thin2();
@@ -26,17 +26,16 @@ Copyright_License {
 
 #include "Point.hpp"
 #include "Util/NonCopyable.hpp"
-#include "Util/SliceAllocator.hpp"
 #include "Util/Serial.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "Compiler.h"
 
-#include <boost/intrusive/list.hpp>
-#include <boost/intrusive/set.hpp>
-
 #include <algorithm>
+#include <iterator>
+#include <vector>
 
 #include <assert.h>
+#include <stddef.h>
 #include <stdlib.h>
 
 class TracePointVector;
@@ -51,12 +50,27 @@ class TracePointerVector;
  * the candidate point removed.  In this version, time differences is also a
  * secondary factor, such that thinning attempts to remove points such that,
  * for equal distance ranking, smaller time step details are removed first.
+ *
+ * All nodes live in one slab which is allocated by the constructor;
+ * they are linked chronologically by index, and the elimination
+ * candidates are kept in an indexed binary heap.  Adding and
+ * thinning points does not allocate memory.
  */
 class Trace : private NonCopyable
 {
-  struct TraceDelta
-    : boost::intrusive::set_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>>,
-      boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>> {
+  /**
+   * A special node index: "no node" in the free list, and "not in the
+   * heap" in TraceDelta::heap_index.
+   */
+  static constexpr unsigned NONE = 0 - 1;
+
+  /**
+   * The index of the list head node in #nodes; it is its own
+   * predecessor and successor if the trace is empty.
+   */
+  static constexpr unsigned HEAD = 0;
+
+  struct TraceDelta {
 
     /**
      * Function used to points for sorting by deltas.
@@ -90,23 +104,28 @@ class Trace : private NonCopyable
       return false;
     }
 
-    struct DeltaRankOp {
-      gcc_pure
-      bool operator()(const TraceDelta &s1, const TraceDelta &s2) const {
-        return DeltaRank(s1, s2);
-      }
-    };
-
     TracePoint point;
 
     unsigned elim_time;
     unsigned elim_distance;
     unsigned delta_distance;
 
+    /**
+     * The chronological neighbours; #HEAD at the ends.  For free
+     * nodes, #next links the free list.
+     */
+    unsigned previous, next;
+
+    /**
+     * The position of this node in Trace::heap, or #NONE.
+     */
+    unsigned heap_index;
+
     explicit TraceDelta(const TracePoint &p)
       :point(p),
        elim_time(null_time), elim_distance(null_delta),
-       delta_distance(0) {}
+       delta_distance(0),
+       previous(HEAD), next(HEAD), heap_index(NONE) {}
 
     TraceDelta(const TracePoint &p_last, const TracePoint &p,
                const TracePoint &p_next)
@@ -168,19 +187,31 @@ class Trace : private NonCopyable
     }
   };
 
-  /* using multiset, not because we need multiple values (we don't),
-     but to avoid set's overhead for duplicate elimination */
-  typedef boost::intrusive::multiset<TraceDelta,
-                                     boost::intrusive::compare<TraceDelta::DeltaRankOp>,
-                                     boost::intrusive::constant_time_size<false>> DeltaList;
+  /**
+   * The slab of all nodes; #HEAD is the list head, the others are
+   * either in use or in the free list.  Its capacity is reserved in
+   * the constructor, therefore points never move.
+   */
+  std::vector<TraceDelta> nodes;
 
-  typedef boost::intrusive::list<TraceDelta,
-                                 boost::intrusive::constant_time_size<false>> ChronologicalList;
+  /**
+   * The first node of the free list, or #NONE.
+   */
+  unsigned free_head;
+
+  /**
+   * A binary min-heap of node indices, ordered by
+   * TraceDelta::DeltaRank(); the top is the next elimination
+   * candidate.
+   */
+  std::vector<unsigned> heap;
 
-  SliceAllocator<TraceDelta, 128u> allocator;
+  /**
+   * Nodes which were taken out of the heap by EraseDelta(); kept
+   * here to avoid allocating on each call.
+   */
+  std::vector<unsigned> suppressed;
 
-  DeltaList delta_list;
-  ChronologicalList chronological_list;
   unsigned cached_size;
 
   TaskProjection task_projection;
@@ -195,25 +226,6 @@ class Trace : private NonCopyable
 
   Serial append_serial, modify_serial;
 
-  template<typename Alloc>
-  struct Disposer {
-    Alloc &alloc;
-
-    void operator()(typename Alloc::pointer td) {
-      alloc.destroy(td);
-      alloc.deallocate(td, 1);
-    }
-  };
-
-  template<typename Alloc>
-  static Disposer<Alloc> MakeDisposer(Alloc &alloc) {
-    return {alloc};
-  }
-
-  Disposer<decltype(allocator)> MakeDisposer() {
-    return MakeDisposer(allocator);
-  }
-
 public:
   /**
    * Constructor.  Task projection is updated after first call to append().
@@ -227,10 +239,6 @@ public:
                  const unsigned max_time = null_time,
                  const unsigned max_size = 1000);
 
-  ~Trace() {
-    clear();
-  }
-
 protected:
   /**
    * Find recent time after which points should not be culled
@@ -244,25 +252,20 @@ protected:
   unsigned GetRecentTime(const unsigned t) const;
 
   /**
-   * Update delta values for specified item in the delta list and the
-   * tree.  This repositions the item after into its sorted position.
-   *
-   * @param it Item to update
-   * @param tree Tree containing leaf
+   * Update delta values for specified node and reposition it in the
+   * heap.
    *
-   * @return Iterator to updated item
+   * @param i Node to update
    */
-  void UpdateDelta(TraceDelta &td);
+  void UpdateDelta(unsigned i);
 
   /**
-   * Erase a non-edge item from delta list and tree, updating
-   * deltas in the process.  This Invalidates the calling iterator.
-   *
-   * @param it Item to erase
-   * @param tree Tree to remove from
+   * Erase a non-edge node, updating the deltas of its neighbours in
+   * the process.
    *
+   * @param i Node to erase
    */
-  void EraseInside(DeltaList::iterator it);
+  void EraseInside(unsigned i);
 
   /**
    * Erase elements based on delta metric until the size is
@@ -301,7 +304,7 @@ protected:
   /**
    * Update start node (and neighbour) after min time pruning
    */
-  void EraseStart(TraceDelta &td_start);
+  void EraseStart(unsigned i);
 
 public:
   /**
@@ -329,6 +332,14 @@ public:
     return max_size;
   }
 
+  unsigned GetMaxTime() const {
+    return max_time;
+  }
+
+  unsigned GetNoThinTime() const {
+    return no_thin_time;
+  }
+
   /**
    * Size of traces (in tree, not in temporary store) ---
    * must call optimise() before this for it to be accurate.
@@ -400,13 +411,13 @@ public:
   const TracePoint &front() const {
     assert(!empty());
 
-    return chronological_list.front().point;
+    return nodes[nodes[HEAD].next].point;
   }
 
   const TracePoint &back() const {
     assert(!empty());
 
-    return chronological_list.back().point;
+    return nodes[nodes[HEAD].previous].point;
   }
 
 private:
@@ -433,16 +444,50 @@ private:
    */
   void Thin();
 
-  TraceDelta &GetFront() {
+  unsigned GetFront() const {
     assert(!empty());
 
-    return chronological_list.front();
+    return nodes[HEAD].next;
   }
 
-  TraceDelta &GetBack() {
+  unsigned GetBack() const {
     assert(!empty());
 
-    return chronological_list.back();
+    return nodes[HEAD].previous;
+  }
+
+  /**
+   * Take a node from the free list (or from the reserved slab
+   * capacity) and initialise it.
+   */
+  unsigned AllocateNode(const TracePoint &point);
+
+  /**
+   * Unlink a node from the list and the heap, and return it to the
+   * free list.
+   */
+  void FreeNode(unsigned i);
+
+  gcc_pure
+  bool HeapLess(unsigned a, unsigned b) const {
+    return TraceDelta::DeltaRank(nodes[a], nodes[b]);
+  }
+
+  void HeapPush(unsigned i);
+  void HeapRemove(unsigned i);
+
+  /**
+   * Restore the heap order after the rank of the node has changed.
+   * No-op if the node is not in the heap.
+   */
+  void HeapUpdate(unsigned i);
+
+  void HeapSiftUp(unsigned position);
+  void HeapSiftDown(unsigned position);
+
+  void HeapSet(unsigned position, unsigned i) {
+    heap[position] = i;
+    nodes[i].heap_index = position;
   }
 
   gcc_pure
@@ -465,15 +510,18 @@ public:
   }
 
 public:
-  class const_iterator : public ChronologicalList::const_iterator {
+  class const_iterator {
     friend class Trace;
 
-    const_iterator(ChronologicalList::const_iterator &&_iterator)
-      :ChronologicalList::const_iterator(std::move(_iterator)) {}
+    const TraceDelta *nodes;
+    unsigned index;
+
+    const_iterator(const TraceDelta *_nodes, unsigned _index)
+      :nodes(_nodes), index(_index) {}
 
   public:
-    using ChronologicalList::const_iterator::iterator_category;
-    using ChronologicalList::const_iterator::difference_type;
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef ptrdiff_t difference_type;
     typedef const TracePoint value_type;
     typedef const TracePoint *pointer;
     typedef const TracePoint &reference;
@@ -481,13 +529,29 @@ public:
     const_iterator() = default;
 
     const TracePoint &operator*() const {
-      const TraceDelta &td = ChronologicalList::const_iterator::operator*();
-      return td.point;
+      return nodes[index].point;
     }
 
     const TracePoint *operator->() const {
-      const TraceDelta &td = ChronologicalList::const_iterator::operator*();
-      return &td.point;
+      return &nodes[index].point;
+    }
+
+    const_iterator &operator++() {
+      index = nodes[index].next;
+      return *this;
+    }
+
+    const_iterator &operator--() {
+      index = nodes[index].previous;
+      return *this;
+    }
+
+    bool operator==(const const_iterator &other) const {
+      return index == other.index;
+    }
+
+    bool operator!=(const const_iterator &other) const {
+      return index != other.index;
     }
 
     const_iterator &NextSquareRange(unsigned sq_resolution,
@@ -499,19 +563,18 @@ public:
         if (*this == end)
           return *this;
 
-        const TraceDelta &td = (const TraceDelta &)**this;
-        if (td.point.FlatSquareDistanceTo(previous) >= sq_resolution)
+        if ((**this).FlatSquareDistanceTo(previous) >= sq_resolution)
           return *this;
       }
     }
   };
 
   const_iterator begin() const {
-    return chronological_list.begin();
+    return const_iterator(nodes.data(), nodes[HEAD].next);
   }
 
   const_iterator end() const {
-    return chronological_list.end();
+    return const_iterator(nodes.data(), HEAD);
   }
 
   const TaskProjection &GetProjection() const {
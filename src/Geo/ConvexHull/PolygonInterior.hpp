@@ -29,6 +29,14 @@ struct GeoPoint;
 struct FlatGeoPoint;
 class SearchPoint;
 
+/**
+ * Contribution of the edge from a to b to the winding number of p:
+ * +1 for an upward crossing with p left of the edge, -1 for a
+ * downward crossing with p right of it, 0 otherwise.
+ */
+gcc_pure int
+PolygonWinding(const GeoPoint &p, const GeoPoint &a, const GeoPoint &b);
+
 /**
  * Note that this expects the vector to be closed, that is, starting point
  * and ending point are the same
@@ -29,6 +29,8 @@
 
 #include <type_traits>
 
+#include <stdint.h>
+
 /**
  * Integer projected (flat-earth) version of Geodetic coordinates
  */
@@ -84,6 +86,17 @@ struct FlatGeoPoint {
   gcc_pure
   unsigned DistanceSquared(const FlatGeoPoint &sp) const;
 
+  /**
+   * Like DistanceSquared(), but calculated with 64 bit integers, so
+   * it does not overflow for points which are far apart.
+   */
+  gcc_pure
+  uint64_t LongDistanceSquared(const FlatGeoPoint &sp) const {
+    const int64_t dx = int64_t(longitude) - sp.longitude;
+    const int64_t dy = int64_t(latitude) - sp.latitude;
+    return dx * dx + dy * dy;
+  }
+
   /**
    * Add one point to another
    *
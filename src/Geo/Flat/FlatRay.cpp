@@ -27,6 +27,17 @@
 
 #define sgn(x) (x >= 0 ? 1 : -1)
 
+/**
+ * The cross product with 64 bit precision; with 32 bit integers, it
+ * overflows for vectors longer than a few thousand kilometres.
+ */
+gcc_const
+static inline int64_t
+LongCrossProduct(const FlatGeoPoint a, const FlatGeoPoint b)
+{
+  return int64_t(a.longitude) * b.latitude - int64_t(a.latitude) * b.longitude;
+}
+
 int
 FlatRay::Magnitude() const
 {
@@ -38,25 +49,26 @@ FlatRay::Magnitude() const
  * @see http://local.wasp.uwa.edu.au/~pbourke/geometry/lineline2d/
  * adapted from line_line_intersection
  */
-std::pair<int, int>
+std::pair<int64_t, int64_t>
 FlatRay::IntersectsRatio(const FlatRay &that) const
 {
-  std::pair<int, int> r;
-  r.second = vector.CrossProduct(that.vector);
+  std::pair<int64_t, int64_t> r;
+  r.second = LongCrossProduct(vector, that.vector);
   if (r.second == 0)
     // lines are parallel
     return r;
 
   const FlatGeoPoint delta = that.point - point;
-  r.first = delta.CrossProduct(that.vector);
-  if ((sgn(r.first) * sgn(r.second) < 0) || (abs(r.first) > abs(r.second))) {
+  r.first = LongCrossProduct(delta, that.vector);
+  if ((sgn(r.first) * sgn(r.second) < 0) ||
+      (llabs(r.first) > llabs(r.second))) {
     // outside first line
     r.second = 0;
     return r;
   }
 
-  const int ub = delta.CrossProduct(vector);
-  if ((sgn(ub) * sgn(r.second) < 0) || (abs(ub) > abs(r.second))) {
+  const int64_t ub = LongCrossProduct(delta, vector);
+  if ((sgn(ub) * sgn(r.second) < 0) || (llabs(ub) > llabs(r.second))) {
     // outside second line
     r.second = 0;
     return r;
@@ -78,7 +90,7 @@ FlatRay::Parametric(const fixed t) const
 fixed
 FlatRay::Intersects(const FlatRay &that) const
 {
-  std::pair<int, int> r = IntersectsRatio(that);
+  std::pair<int64_t, int64_t> r = IntersectsRatio(that);
   if (r.second == 0)
     return fixed(-1);
   return ((fixed)r.first) / r.second;
@@ -87,19 +99,19 @@ FlatRay::Intersects(const FlatRay &that) const
 bool
 FlatRay::IntersectsDistinct(const FlatRay& that) const
 {
-  std::pair<int, int> r = IntersectsRatio(that);
+  std::pair<int64_t, int64_t> r = IntersectsRatio(that);
   return (r.second != 0) &&
          (sgn(r.second) * r.first > 0) &&
-         (abs(r.first) < abs(r.second));
+         (llabs(r.first) < llabs(r.second));
 }
 
 fixed
 FlatRay::DistinctIntersection(const FlatRay& that) const
 {
-  std::pair<int, int> r = IntersectsRatio(that);
+  std::pair<int64_t, int64_t> r = IntersectsRatio(that);
   if (r.second != 0 &&
       sgn(r.second) * r.first > 0 &&
-      abs(r.first) < abs(r.second)) {
+      llabs(r.first) < llabs(r.second)) {
     return fixed(r.first) / r.second;
   }
 
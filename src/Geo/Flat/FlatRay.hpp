@@ -25,6 +25,8 @@
 #include "FlatGeoPoint.hpp"
 #include "Math/fixed.hpp"
 #include <utility>
+
+#include <stdint.h>
 #include "Compiler.h"
 
 /** Projected ray (a point and vector) in 2-d cartesian integer coordinates */
@@ -92,7 +94,7 @@ public:
 
 private:
   gcc_pure
-  std::pair<int, int> IntersectsRatio(const FlatRay &that) const;
+  std::pair<int64_t, int64_t> IntersectsRatio(const FlatRay &that) const;
 };
 
 #endif
@@ -0,0 +1,424 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef PACKED_RTREE_HPP
+#define PACKED_RTREE_HPP
+
+#include "FlatBoundingBox.hpp"
+#include "Compiler.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * A static R-tree over objects derived from #FlatBoundingBox, packed
+ * into contiguous arrays with the Sort-Tile-Recursive algorithm.  The
+ * inner nodes are implicit: node i of a level covers the children
+ * i*FANOUT to (i+1)*FANOUT-1 of the level below, so only their
+ * bounding boxes are stored.
+ *
+ * The tree is meant for data sets which are mostly static after
+ * loading.  Insert() appends to an overflow list which is searched
+ * linearly, and Remove() only marks the item as removed; Optimise()
+ * merges both into a freshly packed tree.
+ */
+template<typename T, unsigned FANOUT = 16>
+class PackedRTree {
+  /** the packed items, grouped into leaves of #FANOUT items */
+  std::vector<T> items;
+
+  /** items which have been removed since the last Optimise() */
+  std::vector<bool> removed;
+  unsigned n_removed;
+
+  /** bounding boxes of all nodes, leaves first, root last */
+  std::vector<FlatBoundingBox> nodes;
+
+  /** index of the first node of each level in #nodes */
+  std::vector<unsigned> level_start;
+
+  /** items inserted since the last Optimise() */
+  std::vector<T> overflow;
+
+public:
+  class const_iterator
+    : public std::iterator<std::forward_iterator_tag, const T> {
+    friend class PackedRTree;
+
+    const PackedRTree *tree;
+    unsigned i;
+
+    const_iterator(const PackedRTree &_tree, unsigned _i)
+      :tree(&_tree), i(_i) {
+      SkipRemoved();
+    }
+
+    void SkipRemoved() {
+      while (i < tree->items.size() && tree->removed[i])
+        ++i;
+    }
+
+  public:
+    const T &operator*() const {
+      return i < tree->items.size()
+        ? tree->items[i]
+        : tree->overflow[i - tree->items.size()];
+    }
+
+    const T *operator->() const {
+      return &**this;
+    }
+
+    const_iterator &operator++() {
+      ++i;
+      SkipRemoved();
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    bool operator==(const const_iterator &other) const {
+      return i == other.i;
+    }
+
+    bool operator!=(const const_iterator &other) const {
+      return i != other.i;
+    }
+  };
+
+  typedef const_iterator iterator;
+
+  PackedRTree():n_removed(0) {}
+
+  unsigned size() const {
+    return items.size() - n_removed + overflow.size();
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  const_iterator begin() const {
+    return const_iterator(*this, 0);
+  }
+
+  const_iterator end() const {
+    return const_iterator(*this, items.size() + overflow.size());
+  }
+
+  /**
+   * The number of item slots: the packed items including removed
+   * ones, followed by the overflow list.  A slot index remains valid
+   * until the tree is modified.
+   */
+  unsigned GetSlotCount() const {
+    return items.size() + overflow.size();
+  }
+
+  const T &GetSlot(unsigned i) const {
+    assert(i < GetSlotCount());
+
+    return i < items.size() ? items[i] : overflow[i - items.size()];
+  }
+
+  /**
+   * Has the item in this slot been removed?
+   */
+  bool IsRemoved(unsigned i) const {
+    assert(i < GetSlotCount());
+
+    return i < items.size() && removed[i];
+  }
+
+  void Clear() {
+    items.clear();
+    removed.clear();
+    n_removed = 0;
+    nodes.clear();
+    level_start.clear();
+    overflow.clear();
+  }
+
+  /**
+   * Add an item.  It is searched linearly until the next Optimise().
+   */
+  void Insert(const T &item) {
+    overflow.push_back(item);
+  }
+
+  /**
+   * Remove the item which compares equal to the given one; its
+   * bounding box is used to find it.
+   *
+   * @return false if no such item was found
+   */
+  bool Remove(const T &item) {
+    auto i = std::find(overflow.begin(), overflow.end(), item);
+    if (i != overflow.end()) {
+      overflow.erase(i);
+      return true;
+    }
+
+    if (nodes.empty())
+      return false;
+
+    const unsigned top = level_start.size() - 2;
+    for (unsigned j = level_start[top]; j < level_start[top + 1]; ++j)
+      if (RemoveFrom(top, j - level_start[top], item))
+        return true;
+
+    return false;
+  }
+
+  /**
+   * Rebuild the packed tree from all items, including the overflow
+   * list.
+   */
+  void Optimise() {
+    if (n_removed > 0) {
+      unsigned n = 0;
+      for (unsigned i = 0; i < items.size(); ++i)
+        if (!removed[i])
+          items[n++] = items[i];
+      items.erase(std::next(items.begin(), n), items.end());
+    }
+
+    items.insert(items.end(), overflow.begin(), overflow.end());
+    overflow.clear();
+
+    removed.assign(items.size(), false);
+    n_removed = 0;
+
+    Pack();
+  }
+
+  /**
+   * Call the visitor for every item whose bounding box overlaps the
+   * given box (touching edges count as overlap).
+   */
+  template<typename V>
+  void VisitOverlapping(const FlatBoundingBox &box, V &&visitor) const {
+    if (!nodes.empty()) {
+      const unsigned top = level_start.size() - 2;
+      for (unsigned j = level_start[top]; j < level_start[top + 1]; ++j)
+        VisitNode(top, j - level_start[top], box, visitor);
+    }
+
+    for (const auto &i : overflow)
+      if (Overlaps(i, box))
+        visitor(i);
+  }
+
+  /**
+   * Like VisitOverlapping(), but call the visitor with the range of
+   * slots (first, last) of each leaf whose bounding box overlaps the
+   * given box, and with the overflow list.  The items in these
+   * slots have not been checked; they may be outside the box or
+   * removed.
+   */
+  template<typename V>
+  void VisitOverlappingSlots(const FlatBoundingBox &box, V &&visitor) const {
+    if (!nodes.empty()) {
+      const unsigned top = level_start.size() - 2;
+      for (unsigned j = level_start[top]; j < level_start[top + 1]; ++j)
+        VisitNodeSlots(top, j - level_start[top], box, visitor);
+    }
+
+    if (!overflow.empty())
+      visitor(items.size(), GetSlotCount());
+  }
+
+private:
+  gcc_pure
+  static bool Overlaps(const FlatBoundingBox &a, const FlatBoundingBox &b) {
+    return a.GetLowerLeft().longitude <= b.GetUpperRight().longitude &&
+      a.GetUpperRight().longitude >= b.GetLowerLeft().longitude &&
+      a.GetLowerLeft().latitude <= b.GetUpperRight().latitude &&
+      a.GetUpperRight().latitude >= b.GetLowerLeft().latitude;
+  }
+
+  /**
+   * The range of children of a node on the level below.
+   */
+  void GetChildren(unsigned level, unsigned i,
+                   unsigned &first, unsigned &last) const {
+    const unsigned n_children = level == 0
+      ? items.size()
+      : level_start[level] - level_start[level - 1];
+    first = i * FANOUT;
+    last = std::min(first + FANOUT, n_children);
+  }
+
+  template<typename V>
+  void VisitNode(unsigned level, unsigned i,
+                 const FlatBoundingBox &box, V &visitor) const {
+    if (!Overlaps(nodes[level_start[level] + i], box))
+      return;
+
+    unsigned first, last;
+    GetChildren(level, i, first, last);
+
+    if (level == 0) {
+      for (unsigned j = first; j < last; ++j)
+        if (!removed[j] && Overlaps(items[j], box))
+          visitor(items[j]);
+    } else {
+      for (unsigned j = first; j < last; ++j)
+        VisitNode(level - 1, j, box, visitor);
+    }
+  }
+
+  template<typename V>
+  void VisitNodeSlots(unsigned level, unsigned i,
+                      const FlatBoundingBox &box, V &visitor) const {
+    if (!Overlaps(nodes[level_start[level] + i], box))
+      return;
+
+    unsigned first, last;
+    GetChildren(level, i, first, last);
+
+    if (level == 0) {
+      visitor(first, last);
+    } else {
+      for (unsigned j = first; j < last; ++j)
+        VisitNodeSlots(level - 1, j, box, visitor);
+    }
+  }
+
+  bool RemoveFrom(unsigned level, unsigned i, const T &item) {
+    if (!Overlaps(nodes[level_start[level] + i], item))
+      return false;
+
+    unsigned first, last;
+    GetChildren(level, i, first, last);
+
+    if (level == 0) {
+      for (unsigned j = first; j < last; ++j) {
+        if (!removed[j] && items[j] == item) {
+          removed[j] = true;
+          ++n_removed;
+          return true;
+        }
+      }
+    } else {
+      for (unsigned j = first; j < last; ++j)
+        if (RemoveFrom(level - 1, j, item))
+          return true;
+    }
+
+    return false;
+  }
+
+  gcc_pure
+  static int64_t CenterX(const FlatBoundingBox &b) {
+    return int64_t(b.GetLowerLeft().longitude) + b.GetUpperRight().longitude;
+  }
+
+  gcc_pure
+  static int64_t CenterY(const FlatBoundingBox &b) {
+    return int64_t(b.GetLowerLeft().latitude) + b.GetUpperRight().latitude;
+  }
+
+  /**
+   * Sort the items into vertical slices of leaves, and sort each
+   * slice from south to north (alternating, so consecutive leaves
+   * stay close at slice boundaries), then build the node levels
+   * bottom up.
+   */
+  void Pack() {
+    nodes.clear();
+    level_start.clear();
+
+    const unsigned n = items.size();
+    if (n == 0)
+      return;
+
+    const unsigned n_leaves = (n + FANOUT - 1) / FANOUT;
+    const unsigned n_slices = (unsigned)ceil(sqrt((double)n_leaves));
+    const unsigned slice_size = n_slices * FANOUT;
+
+    std::sort(items.begin(), items.end(),
+              [](const T &a, const T &b) {
+                return CenterX(a) < CenterX(b);
+              });
+
+    for (unsigned first = 0, slice = 0; first < n;
+         first += slice_size, ++slice) {
+      const auto begin = std::next(items.begin(), first);
+      const auto end = std::next(items.begin(),
+                                 std::min(first + slice_size, n));
+      if (slice % 2 == 0)
+        std::sort(begin, end, [](const T &a, const T &b) {
+            return CenterY(a) < CenterY(b);
+          });
+      else
+        std::sort(begin, end, [](const T &a, const T &b) {
+            return CenterY(a) > CenterY(b);
+          });
+    }
+
+    /* leaves */
+    level_start.push_back(0);
+    for (unsigned first = 0; first < n; first += FANOUT)
+      nodes.push_back(MergeBoxes(items.begin() + first,
+                                 items.begin() + std::min(first + FANOUT, n)));
+
+    /* inner nodes, until there are few enough to scan at the top */
+    while (nodes.size() - level_start.back() > FANOUT) {
+      const unsigned level_first = level_start.back();
+      const unsigned level_end = nodes.size();
+      level_start.push_back(level_end);
+
+      for (unsigned first = level_first; first < level_end; first += FANOUT) {
+        const unsigned last = std::min(first + FANOUT, level_end);
+        FlatBoundingBox box = nodes[first];
+        for (unsigned j = first + 1; j < last; ++j)
+          box.Merge(nodes[j]);
+        nodes.push_back(box);
+      }
+    }
+
+    level_start.push_back(nodes.size());
+  }
+
+  template<typename I>
+  static FlatBoundingBox MergeBoxes(I begin, I end) {
+    assert(begin != end);
+
+    FlatBoundingBox box = *begin;
+    for (++begin; begin != end; ++begin)
+      box.Merge(*begin);
+    return box;
+  }
+};
+
+#endif
@@ -0,0 +1,321 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "PolygonEdgeIndex.hpp"
+#include "ConvexHull/PolygonInterior.hpp"
+#include "Flat/FlatBoundingBox.hpp"
+#include "GeoPoint.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include <assert.h>
+#include <math.h>
+
+typedef std::vector<std::pair<unsigned, unsigned>> BucketRanges;
+
+/**
+ * Fill a compressed row bucket table.  The function f(edge, ranges)
+ * appends the inclusive bucket ranges the edge belongs to; it is
+ * called twice per edge, once for counting and once for filling.
+ */
+template<typename F>
+static void
+BuildBuckets(unsigned n_edges, unsigned n_buckets,
+             std::vector<unsigned> &start, std::vector<unsigned> &edges,
+             F &&f)
+{
+  BucketRanges ranges;
+  start.assign(n_buckets + 1, 0);
+
+  for (unsigned i = 0; i < n_edges; ++i) {
+    ranges.clear();
+    f(i, ranges);
+    for (const auto &r : ranges)
+      for (unsigned b = r.first; b <= r.second; ++b)
+        ++start[b + 1];
+  }
+
+  for (unsigned b = 0; b < n_buckets; ++b)
+    start[b + 1] += start[b];
+
+  edges.resize(start[n_buckets]);
+
+  std::vector<unsigned> fill(start.begin(), start.end() - 1);
+  for (unsigned i = 0; i < n_edges; ++i) {
+    ranges.clear();
+    f(i, ranges);
+    for (const auto &r : ranges)
+      for (unsigned b = r.first; b <= r.second; ++b)
+        edges[fill[b]++] = i;
+  }
+}
+
+void
+PolygonEdgeIndex::Clear()
+{
+  n_bands = 0;
+  band_start.clear();
+  band_edges.clear();
+
+  n_columns = n_rows = 0;
+  cell_start.clear();
+  cell_edges.clear();
+}
+
+unsigned
+PolygonEdgeIndex::BandIndex(fixed latitude) const
+{
+  const fixed x = (latitude - band_origin) * band_scale;
+  if (!(x > fixed(0)))
+    return 0;
+
+  return std::min((unsigned)x, n_bands - 1);
+}
+
+void
+PolygonEdgeIndex::Build(const SearchPointVector &border)
+{
+  Clear();
+
+  if (border.size() < 3)
+    return;
+
+  fixed lat_min = border.front().GetLocation().latitude.Native();
+  fixed lat_max = lat_min;
+  for (const auto &i : border) {
+    const fixed lat = i.GetLocation().latitude.Native();
+    lat_min = std::min(lat_min, lat);
+    lat_max = std::max(lat_max, lat);
+  }
+
+  if (!(lat_max > lat_min))
+    return;
+
+  /* the point-in-polygon test iterates the open edges only, see
+     PolygonInterior() */
+  const unsigned n_edges = border.size() - 1;
+
+  n_bands = n_edges;
+  band_origin = lat_min;
+  band_scale = n_bands / (lat_max - lat_min);
+
+  BuildBuckets(n_edges, n_bands, band_start, band_edges,
+               [this, &border](unsigned i, BucketRanges &ranges) {
+                 const fixed a = border[i].GetLocation().latitude.Native();
+                 const fixed b = border[i + 1].GetLocation().latitude.Native();
+
+                 /* horizontal edges never contribute to the winding
+                    number */
+                 if (a != b)
+                   ranges.emplace_back(BandIndex(std::min(a, b)),
+                                       BandIndex(std::max(a, b)));
+               });
+}
+
+bool
+PolygonEdgeIndex::IsInside(const SearchPointVector &border,
+                           const GeoPoint &p) const
+{
+  assert(IsDefined());
+
+  const unsigned band = BandIndex(p.latitude.Native());
+
+  int wn = 0;
+  for (unsigned i = band_start[band], end = band_start[band + 1];
+       i != end; ++i) {
+    const unsigned edge = band_edges[i];
+    wn += PolygonWinding(p, border[edge].GetLocation(),
+                         border[edge + 1].GetLocation());
+  }
+
+  return wn != 0;
+}
+
+unsigned
+PolygonEdgeIndex::ColumnIndex(int longitude) const
+{
+  if (longitude <= grid_origin.longitude)
+    return 0;
+
+  return std::min(unsigned(longitude - grid_origin.longitude) / cell_size,
+                  n_columns - 1);
+}
+
+unsigned
+PolygonEdgeIndex::RowIndex(int latitude) const
+{
+  if (latitude <= grid_origin.latitude)
+    return 0;
+
+  return std::min(unsigned(latitude - grid_origin.latitude) / cell_size,
+                  n_rows - 1);
+}
+
+void
+PolygonEdgeIndex::Project(const SearchPointVector &border)
+{
+  n_columns = n_rows = 0;
+  cell_start.clear();
+  cell_edges.clear();
+
+  if (border.size() < 3)
+    return;
+
+  const FlatBoundingBox box = border.CalculateBoundingbox();
+  const FlatGeoPoint &ll = box.GetLowerLeft();
+  const FlatGeoPoint &ur = box.GetUpperRight();
+  const unsigned width = ur.longitude - ll.longitude + 1;
+  const unsigned height = ur.latitude - ll.latitude + 1;
+
+  /* all edges, including the one joining the last item to the first,
+     see SearchPointVector::NearestPoint() */
+  const unsigned n_edges = border.size();
+
+  /* aim for roughly one edge per cell */
+  grid_origin = ll;
+  cell_size = std::max(1, (int)ceil(sqrt(fixed(width) * height / n_edges)));
+  n_columns = (width + cell_size - 1) / cell_size;
+  n_rows = (height + cell_size - 1) / cell_size;
+
+  BuildBuckets(n_edges, n_columns * n_rows, cell_start, cell_edges,
+               [this, &border, n_edges](unsigned i, BucketRanges &ranges) {
+                 const FlatGeoPoint &a = border[i].GetFlatLocation();
+                 const FlatGeoPoint &b =
+                   border[i + 1 < n_edges ? i + 1 : 0].GetFlatLocation();
+
+                 const unsigned row_a = RowIndex(a.latitude);
+                 const unsigned row_b = RowIndex(b.latitude);
+                 if (row_a == row_b) {
+                   const unsigned first =
+                     ColumnIndex(std::min(a.longitude, b.longitude));
+                   const unsigned last =
+                     ColumnIndex(std::max(a.longitude, b.longitude));
+                   ranges.emplace_back(row_a * n_columns + first,
+                                       row_a * n_columns + last);
+                   return;
+                 }
+
+                 /* walk the rows, adding only the columns the edge
+                    actually crosses in each of them */
+                 const FlatGeoPoint &lo = a.latitude < b.latitude ? a : b;
+                 const FlatGeoPoint &hi = a.latitude < b.latitude ? b : a;
+                 const fixed slope = fixed(hi.longitude - lo.longitude) /
+                   (hi.latitude - lo.latitude);
+
+                 for (unsigned row = std::min(row_a, row_b),
+                        row_end = std::max(row_a, row_b);
+                      row <= row_end; ++row) {
+                   const int row_bottom = grid_origin.latitude +
+                     int(row) * cell_size;
+                   const int y0 = std::max(lo.latitude, row_bottom);
+                   const int y1 = std::min(hi.latitude,
+                                           row_bottom + cell_size);
+                   const fixed x0 = lo.longitude + (y0 - lo.latitude) * slope;
+                   const fixed x1 = lo.longitude + (y1 - lo.latitude) * slope;
+                   const unsigned first =
+                     ColumnIndex((int)floor(std::min(x0, x1)));
+                   const unsigned last =
+                     ColumnIndex((int)ceil(std::max(x0, x1)));
+                   ranges.emplace_back(row * n_columns + first,
+                                       row * n_columns + last);
+                 }
+               });
+}
+
+void
+PolygonEdgeIndex::FindEdges(const FlatBoundingBox &box,
+                            std::vector<unsigned> &dest) const
+{
+  assert(IsProjected());
+
+  dest.clear();
+  VisitCells(ColumnIndex(box.GetLowerLeft().longitude),
+             ColumnIndex(box.GetUpperRight().longitude),
+             RowIndex(box.GetLowerLeft().latitude),
+             RowIndex(box.GetUpperRight().latitude),
+             [&dest](unsigned edge) {
+               dest.push_back(edge);
+             });
+
+  std::sort(dest.begin(), dest.end());
+  dest.erase(std::unique(dest.begin(), dest.end()), dest.end());
+}
+
+FlatGeoPoint
+PolygonEdgeIndex::NearestPoint(const SearchPointVector &border,
+                               const FlatGeoPoint &p) const
+{
+  assert(IsProjected());
+
+  const int column = ColumnIndex(p.longitude);
+  const int row = RowIndex(p.latitude);
+  const int max_column = n_columns - 1, max_row = n_rows - 1;
+  const int max_ring = std::max(std::max(column, max_column - column),
+                                std::max(row, max_row - row));
+
+  uint64_t distance_min = UINT64_MAX;
+  unsigned best_edge = 0 - 1;
+  FlatGeoPoint point_best;
+
+  auto visit = [&](unsigned edge) {
+    const FlatGeoPoint pa =
+      border.SegmentNearestPoint(border.begin() + edge, p);
+    const uint64_t d = p.LongDistanceSquared(pa);
+    /* prefer the lowest edge index on ties, like the linear scan */
+    if (d < distance_min || (d == distance_min && edge < best_edge)) {
+      distance_min = d;
+      best_edge = edge;
+      point_best = pa;
+    }
+  };
+
+  for (int ring = 0; ring <= max_ring; ++ring) {
+    const int row_min = std::max(row - ring, 0);
+    const int row_max = std::min(row + ring, max_row);
+    const int column_min = std::max(column - ring, 0);
+    const int column_max = std::min(column + ring, max_column);
+
+    if (row - ring >= 0)
+      VisitCells(column_min, column_max, row - ring, row - ring, visit);
+    if (ring > 0 && row + ring <= max_row)
+      VisitCells(column_min, column_max, row + ring, row + ring, visit);
+
+    for (int r = std::max(row - ring + 1, row_min),
+           r_end = std::min(row + ring - 1, row_max); r <= r_end; ++r) {
+      if (column - ring >= 0)
+        VisitCells(column - ring, column - ring, r, r, visit);
+      if (ring > 0 && column + ring <= max_column)
+        VisitCells(column + ring, column + ring, r, r, visit);
+    }
+
+    /* every unvisited edge lies in cells at least ring+1 cells away
+       from the (clamped) query cell, i.e. at least ring*cell_size
+       away; allow for the rounding of the projected nearest point */
+    const int64_t bound = int64_t(ring) * cell_size - 2;
+    if (bound > 0 && distance_min < uint64_t(bound * bound))
+      break;
+  }
+
+  return point_best;
+}
@@ -0,0 +1,157 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef POLYGON_EDGE_INDEX_HPP
+#define POLYGON_EDGE_INDEX_HPP
+
+#include "SearchPointVector.hpp"
+#include "Math/fixed.hpp"
+#include "Compiler.h"
+
+#include <vector>
+
+struct GeoPoint;
+class FlatBoundingBox;
+
+/**
+ * An acceleration structure for the edges of a large closed polygon
+ * (a #SearchPointVector whose last item repeats the first one).
+ * Edge i joins item i to item i+1; the last edge wraps around to the
+ * first item.
+ *
+ * Two bucket tables are kept, both in compressed row form (an offset
+ * array into one flat array of edge indices), and each edge is
+ * entered into every bucket its bounding box touches:
+ *
+ * - latitude bands in geographic coordinates, built by Build() and
+ *   used for the point-in-polygon test;
+ *
+ * - a uniform grid in flat coordinates, built by Project() once the
+ *   border has been projected, used for ray intersection and nearest
+ *   point queries.
+ *
+ * All queries give exactly the results of the linear scans in
+ * #SearchPointVector.
+ */
+class PolygonEdgeIndex {
+  /** latitude of the lower edge of the first band (native units) */
+  fixed band_origin;
+  /** bands per native latitude unit */
+  fixed band_scale;
+  unsigned n_bands;
+  std::vector<unsigned> band_start;
+  std::vector<unsigned> band_edges;
+
+  FlatGeoPoint grid_origin;
+  int cell_size;
+  unsigned n_columns, n_rows;
+  std::vector<unsigned> cell_start;
+  std::vector<unsigned> cell_edges;
+
+public:
+  /**
+   * Polygons with fewer edges than this are not worth indexing; the
+   * linear scan is faster.
+   */
+  static constexpr unsigned MIN_EDGES = 64;
+
+  PolygonEdgeIndex():n_bands(0), n_columns(0), n_rows(0) {}
+
+  /**
+   * Does the polygon have enough edges to be indexed?
+   */
+  gcc_pure
+  static bool IsWorthwhile(const SearchPointVector &border) {
+    return border.size() >= MIN_EDGES;
+  }
+
+  void Clear();
+
+  /**
+   * Build the latitude bands from the geographic border locations.
+   */
+  void Build(const SearchPointVector &border);
+
+  /**
+   * Build the flat grid.  To be called after the border has been
+   * projected.
+   */
+  void Project(const SearchPointVector &border);
+
+  bool IsDefined() const {
+    return n_bands > 0;
+  }
+
+  bool IsProjected() const {
+    return n_columns > 0;
+  }
+
+  /**
+   * Same as SearchPointVector::IsInside(), only looking at the edges
+   * in the latitude band of the point.
+   */
+  gcc_pure
+  bool IsInside(const SearchPointVector &border, const GeoPoint &p) const;
+
+  /**
+   * Same as SearchPointVector::NearestPoint(), searching the grid
+   * cells in rings around the point until no unvisited edge can be
+   * closer.
+   */
+  gcc_pure
+  FlatGeoPoint NearestPoint(const SearchPointVector &border,
+                            const FlatGeoPoint &p) const;
+
+  /**
+   * Collect the indices of all edges which may intersect the given
+   * box, in ascending order and without duplicates.
+   */
+  void FindEdges(const FlatBoundingBox &box,
+                 std::vector<unsigned> &dest) const;
+
+private:
+  gcc_pure
+  unsigned BandIndex(fixed latitude) const;
+
+  gcc_pure
+  unsigned ColumnIndex(int longitude) const;
+
+  gcc_pure
+  unsigned RowIndex(int latitude) const;
+
+  /**
+   * Visit all edges in the cells of the given column and row range.
+   */
+  template<typename V>
+  void VisitCells(unsigned column_min, unsigned column_max,
+                  unsigned row_min, unsigned row_max, V &&visitor) const {
+    for (unsigned row = row_min; row <= row_max; ++row) {
+      const unsigned *start = &cell_start[row * n_columns];
+      for (unsigned i = start[column_min],
+             end = start[column_max + 1]; i != end; ++i)
+        visitor(cell_edges[i]);
+    }
+  }
+};
+
+#endif
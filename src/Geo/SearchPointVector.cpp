@@ -99,13 +99,13 @@ gcc_pure
 static FlatGeoPoint
 NearestPointNonConvex(const SearchPointVector& spv, const FlatGeoPoint &p3)
 {
-  unsigned distance_min = 0-1;
+  uint64_t distance_min = UINT64_MAX;
   FlatGeoPoint point_best;
 
   for (auto i = spv.begin(); i!= spv.end(); ++i) {
 
     FlatGeoPoint pa = SegmentNearestPoint(spv,i,p3);
-    unsigned d_this = p3.DistanceSquared(pa);
+    uint64_t d_this = p3.LongDistanceSquared(pa);
     if (d_this<distance_min) {
       distance_min = d_this;
       point_best = pa;
@@ -132,6 +132,13 @@ SearchPointVector::NearestIndexConvex(const FlatGeoPoint &p3) const
   return i_best;
 }
 
+FlatGeoPoint
+SearchPointVector::SegmentNearestPoint(const_iterator i,
+                                       const FlatGeoPoint &p) const
+{
+  return ::SegmentNearestPoint(*this, i, p);
+}
+
 FlatGeoPoint
 SearchPointVector::NearestPoint(const FlatGeoPoint &p3) const
 {
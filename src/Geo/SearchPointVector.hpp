@@ -52,6 +52,14 @@ public:
   gcc_pure
   FlatGeoPoint NearestPoint(const FlatGeoPoint &p) const;
 
+  /**
+   * Find the point nearest to p on the segment starting at i (the
+   * last item is joined to the first one).
+   */
+  gcc_pure
+  FlatGeoPoint SegmentNearestPoint(const_iterator i,
+                                   const FlatGeoPoint &p) const;
+
   /** Find iterator of nearest point, assuming polygon is convex */
   gcc_pure
   const_iterator NearestIndexConvex(const FlatGeoPoint &p) const;
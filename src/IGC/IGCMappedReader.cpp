@@ -0,0 +1,112 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "IGCMappedReader.hpp"
+#include "IGCParser.hpp"
+#include "OS/ConvertPathName.hpp"
+#include "OS/FileUtil.hpp"
+
+#include <algorithm>
+
+#include <string.h>
+
+IGCMappedReader::IGCMappedReader(const TCHAR *path, bool _decode_extensions)
+  :mapping(path),
+   empty(mapping.error() && File::Exists(path) && File::GetSize(path) == 0),
+   decode_extensions(_decode_extensions)
+{
+  Rewind();
+}
+
+#ifdef _UNICODE
+
+IGCMappedReader::IGCMappedReader(const char *path, bool _decode_extensions)
+  :mapping(PathName(path)),
+   empty(mapping.error() && File::Exists(PathName(path)) &&
+         File::GetSize(PathName(path)) == 0),
+   decode_extensions(_decode_extensions)
+{
+  Rewind();
+}
+
+#endif
+
+void
+IGCMappedReader::Rewind()
+{
+  position = (const char *)mapping.data();
+  extensions.clear();
+}
+
+ConstBuffer<char>
+IGCMappedReader::ReadLine()
+{
+  if (position == nullptr)
+    return nullptr;
+
+  const char *const end = (const char *)mapping.end();
+  if (position >= end)
+    return nullptr;
+
+  const char *const line = position;
+  const char *newline = (const char *)memchr(line, '\n', end - line);
+  if (newline == nullptr) {
+    /* last line without terminator */
+    newline = end;
+    position = end;
+  } else
+    position = newline + 1;
+
+  const char *line_end = newline;
+  if (line_end > line && line_end[-1] == '\r')
+    --line_end;
+
+  return ConstBuffer<char>(line, line_end - line);
+}
+
+const char *
+IGCMappedReader::Terminate(ConstBuffer<char> line)
+{
+  const size_t length = std::min(line.size, sizeof(line_buffer) - 1);
+  std::copy_n(line.data, length, line_buffer);
+  line_buffer[length] = 0;
+  return line_buffer;
+}
+
+bool
+IGCMappedReader::ParseExtensions(ConstBuffer<char> line)
+{
+  if (line.IsEmpty() || line.data[0] != 'I')
+    return false;
+
+  if (decode_extensions)
+    IGCParseExtensions(Terminate(line), extensions);
+
+  return true;
+}
+
+bool
+IGCMappedReader::ParseFix(ConstBuffer<char> line, IGCFix &fix) const
+{
+  return IGCParseFix(line.data, line.size, extensions, fix);
+}
@@ -0,0 +1,138 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_IGC_MAPPED_READER_HPP
+#define XCSOAR_IGC_MAPPED_READER_HPP
+
+#include "IGCExtensions.hpp"
+#include "OS/FileMapping.hpp"
+#include "Util/ConstBuffer.hxx"
+#include "Compiler.h"
+
+#include <tchar.h>
+
+struct IGCFix;
+
+/**
+ * Reads an IGC file through a #FileMapping.  Lines are returned as
+ * pointers into the mapping, without copying, and "B" records are
+ * decoded in place with the fixed offset IGCParseFix() variant.
+ *
+ * "I" records are remembered by ParseExtensions(), unless extension
+ * decoding was disabled in the constructor; callers which only need
+ * time, location and altitudes can skip the per-fix extension work
+ * that way.
+ */
+class IGCMappedReader {
+  FileMapping mapping;
+
+  /**
+   * Is the file empty?  #FileMapping refuses to map empty files, but
+   * to this class, that is just a file without lines.
+   */
+  bool empty;
+
+  const char *position;
+
+  IGCExtensions extensions;
+
+  const bool decode_extensions;
+
+  /**
+   * Buffer for null-terminated copies of non-"B" records, see
+   * Terminate().
+   */
+  char line_buffer[256];
+
+public:
+  explicit IGCMappedReader(const TCHAR *path,
+                           bool _decode_extensions=true);
+
+#ifdef _UNICODE
+  explicit IGCMappedReader(const char *path,
+                           bool _decode_extensions=true);
+#endif
+
+  IGCMappedReader(const IGCMappedReader &) = delete;
+  IGCMappedReader &operator=(const IGCMappedReader &) = delete;
+
+  /**
+   * Has the constructor failed?
+   */
+  bool error() const {
+    return mapping.error() && !empty;
+  }
+
+  /**
+   * Returns the size of the file, in bytes.
+   */
+  long GetSize() const {
+    return mapping.error() ? 0 : mapping.size();
+  }
+
+  /**
+   * Returns the current read position, in bytes.
+   */
+  long Tell() const {
+    return position - (const char *)mapping.data();
+  }
+
+  /**
+   * Start reading from the beginning of the file again.  The
+   * extensions seen so far are forgotten.
+   */
+  void Rewind();
+
+  /**
+   * Returns the next line without its line terminator.  The buffer
+   * points into the file mapping and is not null-terminated; it is
+   * valid as long as this object exists.
+   *
+   * @return the line, or a "nulled" buffer at the end of the file
+   */
+  ConstBuffer<char> ReadLine();
+
+  /**
+   * Copy the given line to an internal buffer and null-terminate it,
+   * for the parsers which expect C strings.  Overlong lines are
+   * truncated.  The pointer is valid until the next call.
+   */
+  const char *Terminate(ConstBuffer<char> line);
+
+  /**
+   * Parse an "I" record and remember its extensions for subsequent
+   * ParseFix() calls.
+   *
+   * @return true if the line was an "I" record
+   */
+  bool ParseExtensions(ConstBuffer<char> line);
+
+  /**
+   * Parse a "B" record with the extensions seen so far.
+   *
+   * @return true on success, false if the line was not recognized
+   */
+  bool ParseFix(ConstBuffer<char> line, IGCFix &fix) const;
+};
+
+#endif
@@ -287,7 +287,7 @@ static void
 ParseExtensionValueN(const char *p, const char *end, size_t n,
                      int16_t &value_r)
 {
-  if (n > (size_t)(p - end))
+  if (n > (size_t)(end - p))
     /* string is too short */
     return;
 
@@ -296,23 +296,113 @@ ParseExtensionValueN(const char *p, const char *end, size_t n,
     value_r = value;
 }
 
+/**
+ * Parse a fixed number of decimal digits.
+ *
+ * @return the result, or -1 if a character is not a digit
+ */
+gcc_always_inline
+static inline int
+ParseDigits(const char *p, unsigned n)
+{
+  int value = 0;
+
+  for (const char *end = p + n; p != end; ++p) {
+    if (!IsDigitASCII(*p))
+      return -1;
+
+    value = value * 10 + (*p - '0');
+  }
+
+  return value;
+}
+
+/**
+ * Parse a fixed width altitude field, which may start with a minus
+ * sign.
+ */
+static bool
+ParseAltitude(const char *p, unsigned n, int &value_r)
+{
+  const bool negative = *p == '-';
+  if (negative) {
+    ++p;
+    --n;
+  }
+
+  int value = ParseDigits(p, n);
+  if (value < 0)
+    return false;
+
+  value_r = negative ? -value : value;
+  return true;
+}
+
+/**
+ * Fixed offset variant of IGCParseLocation().  Reads exactly 17
+ * characters (DDMMmmm[N/S]DDDMMmmm[E/W]).
+ */
+static bool
+ParseFixLocation(const char *buffer, GeoPoint &location)
+{
+  const int lat_degrees = ParseDigits(buffer, 2);
+  const int lat_minutes = ParseDigits(buffer + 2, 5);
+  const char lat_char = buffer[7];
+  const int lon_degrees = ParseDigits(buffer + 8, 3);
+  const int lon_minutes = ParseDigits(buffer + 11, 5);
+  const char lon_char = buffer[16];
+
+  if (lat_degrees < 0 || lat_degrees >= 90 ||
+      lat_minutes < 0 || lat_minutes >= 60000 ||
+      (lat_char != 'N' && lat_char != 'S'))
+    return false;
+
+  if (lon_degrees < 0 || lon_degrees >= 180 ||
+      lon_minutes < 0 || lon_minutes >= 60000 ||
+      (lon_char != 'E' && lon_char != 'W'))
+    return false;
+
+  location.latitude = Angle::Degrees(fixed(lat_degrees) +
+                                     fixed(lat_minutes) / 60000);
+  if (lat_char == 'S')
+    location.latitude.Flip();
+
+  location.longitude = Angle::Degrees(fixed(lon_degrees) +
+                                      fixed(lon_minutes) / 60000);
+  if (lon_char == 'W')
+    location.longitude.Flip();
+
+  return true;
+}
+
 bool
 IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
 {
   if (*buffer != 'B')
     return false;
 
-  BrokenTime time;
-  if (!IGCParseTime(buffer + 1, time))
+  return IGCParseFix(buffer, strlen(buffer), extensions, fix);
+}
+
+bool
+IGCParseFix(const char *buffer, size_t length,
+            const IGCExtensions &extensions, IGCFix &fix)
+{
+  /* B HHMMSS DDMMmmmN DDDMMmmmE V PPPPP GGGGG */
+  if (length < 35 || *buffer != 'B')
     return false;
 
-  char valid_char;
-  int gps_altitude, pressure_altitude;
+  const int hour = ParseDigits(buffer + 1, 2);
+  const int minute = ParseDigits(buffer + 3, 2);
+  const int second = ParseDigits(buffer + 5, 2);
+  if (hour < 0 || minute < 0 || second < 0)
+    return false;
 
-  if (sscanf(buffer + 24, "%c%05d%05d",
-             &valid_char, &pressure_altitude, &gps_altitude) != 3)
+  const BrokenTime time(hour, minute, second);
+  if (!time.IsPlausible())
     return false;
 
+  const char valid_char = buffer[24];
   if (valid_char == 'A')
     fix.gps_valid = true;
   else if (valid_char == 'V')
@@ -320,23 +410,23 @@ IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
   else
     return false;
 
-  fix.gps_altitude = gps_altitude;
-  fix.pressure_altitude = pressure_altitude;
+  if (!ParseAltitude(buffer + 25, 5, fix.pressure_altitude) ||
+      !ParseAltitude(buffer + 30, 5, fix.gps_altitude))
+    return false;
 
-  if (!IGCParseLocation(buffer + 7, fix.location))
+  if (!ParseFixLocation(buffer + 7, fix.location))
     return false;
 
   fix.time = time;
 
   fix.ClearExtensions();
 
-  const size_t line_length = strlen(buffer);
   for (auto i = extensions.begin(), end = extensions.end(); i != end; ++i) {
     const IGCExtension &extension = *i;
     assert(extension.start > 0);
     assert(extension.finish >= extension.start);
 
-    if (extension.finish > line_length)
+    if (extension.finish > length)
       /* exceeds the input line length */
       continue;
 
@@ -26,6 +26,8 @@ Copyright_License {
 
 #include "Util/StaticString.hxx"
 
+#include <stddef.h>
+
 struct IGCFix;
 struct IGCHeader;
 struct IGCExtensions;
@@ -106,6 +108,17 @@ IGCParseLocation(const char *buffer, GeoPoint &location);
 bool
 IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix);
 
+/**
+ * Parse an IGC "B" record of the given length.  The line does not
+ * need to be null-terminated (e.g. it may point into a file
+ * mapping); all mandatory fields are decoded at their fixed offsets.
+ *
+ * @return true on success, false if the line was not recognized
+ */
+bool
+IGCParseFix(const char *buffer, size_t length,
+            const IGCExtensions &extensions, IGCFix &fix);
+
 /**
  * Parse a time in IGC file format (HHMMSS).
  *
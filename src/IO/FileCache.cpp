@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "FileCache.hpp"
 #include "OS/FileUtil.hpp"
+#include "OS/FileMapping.hpp"
 #include "OS/PathName.hpp"
 #include "Compatibility/path.h"
 #include "Compiler.h"
@@ -191,6 +192,31 @@ FileCache::Load(const TCHAR *name, const TCHAR *original_path)
   return file;
 }
 
+FileMapping *
+FileCache::Map(const TCHAR *name, const TCHAR *original_path,
+               size_t &offset_r)
+{
+  /* let Load() validate the cache header */
+  FILE *file = Load(name, original_path);
+  if (file == nullptr)
+    return nullptr;
+
+  const long offset = ftell(file);
+  fclose(file);
+  if (offset <= 0)
+    return nullptr;
+
+  TCHAR path[PathBufferSize(name)];
+  FileMapping *mapping = new FileMapping(MakeCachePath(path, name));
+  if (mapping->error() || mapping->size() < (size_t)offset) {
+    delete mapping;
+    return nullptr;
+  }
+
+  offset_r = offset;
+  return mapping;
+}
+
 FILE *
 FileCache::Save(const TCHAR *name, const TCHAR *original_path)
 {
@@ -30,10 +30,12 @@ Copyright_License {
 #include "Time/PeriodClock.hpp"
 #include "Event/Idle.hpp"
 #include "Topography/Thread.hpp"
+#include "Terrain/Thread.hpp"
 
 GlueMapWindow::GlueMapWindow(const Look &look)
   :MapWindow(look.map, look.traffic),
    topography_thread(nullptr),
+   terrain_thread(nullptr),
 #ifdef ENABLE_OPENGL
    data_timer(*this),
 #endif
@@ -82,6 +84,25 @@ GlueMapWindow::SetTopography(TopographyStore *_topography)
                            });
 }
 
+void
+GlueMapWindow::SetTerrain(RasterTerrain *_terrain)
+{
+  if (terrain_thread != nullptr) {
+    terrain_thread->LockStop();
+    delete terrain_thread;
+    terrain_thread = nullptr;
+  }
+
+  MapWindow::SetTerrain(_terrain);
+
+  if (_terrain != nullptr)
+    terrain_thread =
+      new TerrainThread(*_terrain,
+                        [this](){
+                          SendUser(unsigned(Command::INVALIDATE));
+                        });
+}
+
 void
 GlueMapWindow::Create(ContainerWindow &parent, const PixelRect &rc)
 {
@@ -134,9 +155,8 @@ GlueMapWindow::ExchangeBlackboard()
 {
   /* copy device_blackboard to MapWindow */
 
-  device_blackboard->mutex.Lock();
-  ReadBlackboard(device_blackboard->Basic(), device_blackboard->Calculated());
-  device_blackboard->mutex.Unlock();
+  ReadBlackboard(device_blackboard->GetBasicSnapshot(),
+                 device_blackboard->GetCalculatedSnapshot());
 
 #ifndef ENABLE_OPENGL
   next_mutex.Lock();
@@ -240,7 +260,9 @@ GlueMapWindow::Idle()
   bool still_dirty;
 
   do {
-    still_dirty = UpdateWeather() || UpdateTerrain();
+    /* terrain tiles are loaded by the TerrainThread if available */
+    still_dirty = UpdateWeather() ||
+      (terrain_thread == nullptr && UpdateTerrain());
   } while (!clock.Check(700) && /* stop after 700ms */
 #ifndef ENABLE_OPENGL
            !draw_thread->IsTriggered() &&
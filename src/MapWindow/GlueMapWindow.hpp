@@ -42,6 +42,7 @@ Copyright_License {
 struct Look;
 struct GestureLook;
 class TopographyThread;
+class TerrainThread;
 class MaskedIcon;
 
 class OffsetHistory
@@ -67,6 +68,8 @@ class GlueMapWindow : public MapWindow {
 
   TopographyThread *topography_thread;
 
+  TerrainThread *terrain_thread;
+
 #ifdef ENABLE_OPENGL
   /**
    * A timer that triggers a redraw periodically until all data files
@@ -191,6 +194,7 @@ public:
   virtual ~GlueMapWindow();
 
   void SetTopography(TopographyStore *_topography);
+  void SetTerrain(RasterTerrain *_terrain);
 
   void SetMapSettings(const MapSettings &new_value);
   void SetComputerSettings(const ComputerSettings &new_value);
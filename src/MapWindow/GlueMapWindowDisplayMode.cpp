@@ -24,10 +24,12 @@ Copyright_License {
 #include "GlueMapWindow.hpp"
 #include "Terrain/RasterTerrain.hpp"
 #include "Topography/Thread.hpp"
+#include "Terrain/Thread.hpp"
 #include "Interface.hpp"
 #include "Profile/Profile.hpp"
 #include "Screen/Layout.hpp"
 #include "Util/Clamp.hpp"
+#include "Geo/GeoVector.hpp"
 
 void
 OffsetHistory::Reset()
@@ -107,6 +109,36 @@ GlueMapWindow::PanTo(const GeoPoint &location)
   FullRedraw();
 }
 
+/**
+ * Determine the locations where terrain tiles shall be loaded in
+ * advance: along the projected flight track and at the end of the
+ * current task leg.
+ */
+static unsigned
+GetTerrainPrefetch(const NMEAInfo &basic, const DerivedInfo &calculated,
+                   GeoPoint *prefetch)
+{
+  /**
+   * The flight track is projected this far into the future [s].
+   */
+  static constexpr unsigned PREFETCH_TIMES[] = { 300, 900 };
+
+  unsigned n = 0;
+
+  if (basic.location_available && basic.track_available &&
+      basic.MovementDetected())
+    for (unsigned t : PREFETCH_TIMES)
+      prefetch[n++] = GeoVector(basic.ground_speed * fixed(t), basic.track)
+        .EndPoint(basic.location);
+
+  const ElementStat &leg = calculated.task_stats.current_leg;
+  if (calculated.task_stats.task_valid && leg.location_remaining.IsValid())
+    prefetch[n++] = leg.location_remaining;
+
+  assert(n <= TerrainThread::MAX_PREFETCH);
+  return n;
+}
+
 void
 GlueMapWindow::UpdateScreenBounds()
 {
@@ -116,6 +148,21 @@ GlueMapWindow::UpdateScreenBounds()
       visible_projection.IsValid() &&
       CommonInterface::GetMapSettings().topography_enabled)
     topography_thread->Trigger(visible_projection);
+
+  if (terrain_thread != nullptr && visible_projection.IsValid()) {
+    // always service terrain even if it's not used by the map,
+    // because it's used by other calculations
+    const fixed radius = visible_projection.GetScreenWidthMeters() / 2;
+
+    GeoPoint prefetch[TerrainThread::MAX_PREFETCH];
+    const unsigned n_prefetch =
+      GetTerrainPrefetch(CommonInterface::Basic(),
+                         CommonInterface::Calculated(), prefetch);
+
+    terrain_thread->Trigger(visible_projection.GetGeoScreenCenter(), radius,
+                            ConstBuffer<GeoPoint>(prefetch, n_prefetch),
+                            radius / 2);
+  }
 }
 
 void
@@ -22,6 +22,7 @@ Copyright_License {
 */
 
 #include "MapWindowBlackboard.hpp"
+#include "Thread/SnapshotBuffer.hpp"
 
 void
 MapWindowBlackboard::ReadComputerSettings(const ComputerSettings
@@ -45,3 +46,11 @@ MapWindowBlackboard::ReadBlackboard(const MoreData &nmea_info,
   calculated_info = derived_info;
 }
 
+void
+MapWindowBlackboard::ReadBlackboard(const SnapshotBuffer<MoreData> &nmea_info,
+                                    const SnapshotBuffer<DerivedInfo> &derived_info)
+{
+  nmea_info.Read(gps_info);
+  derived_info.Read(calculated_info);
+}
+
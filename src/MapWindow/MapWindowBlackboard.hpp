@@ -30,6 +30,8 @@ Copyright_License {
 #include "Thread/Debug.hpp"
 #include "UIState.hpp"
 
+template<typename T> class SnapshotBuffer;
+
 /**
  * Blackboard used by map window: provides read-only access to local
  * copies of data required by map window
@@ -80,6 +82,8 @@ protected:
 
   void ReadBlackboard(const MoreData &nmea_info,
                       const DerivedInfo &derived_info);
+  void ReadBlackboard(const SnapshotBuffer<MoreData> &nmea_info,
+                      const SnapshotBuffer<DerivedInfo> &derived_info);
   void ReadComputerSettings(const ComputerSettings &settings);
   void ReadMapSettings(const MapSettings &settings);
 
@@ -121,6 +121,21 @@ isqrt4(unsigned val);
 }
 #endif
 
+/**
+ * Same as isqrt4(), but inline on platforms where it is a hardware
+ * square root, which allows the compiler to vectorise loops using it.
+ */
+gcc_const
+static inline unsigned
+InlineIsqrt4(unsigned val)
+{
+#if defined(__i386__) || defined(__x86_64__)
+  return (unsigned)sqrt((double)val);
+#else
+  return isqrt4(val);
+#endif
+}
+
 gcc_const
 static inline unsigned
 ihypot(int x, int y)
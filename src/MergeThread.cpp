@@ -55,6 +55,8 @@ MergeThread::Process()
   flarm_computer.Process(device_blackboard.SetBasic().flarm,
                          last_fix.flarm, basic);
   device_blackboard.MergeSimulatorComputed();
+
+  device_blackboard.PublishBasic();
 }
 
 void
@@ -189,6 +189,21 @@ public:
     return result;
   }
 
+  /**
+   * Parse the value of an option (e.g. the part after "--foo=") as
+   * a positive integer.
+   */
+  unsigned ParsePositive(const char *value) {
+    char *endptr;
+    unsigned long result = strtoul(value, &endptr, 10);
+    if (endptr == value || *endptr != 0 || result == 0) {
+      fputs("The parameter could not be parsed correctly.\n", stderr);
+      UsageError();
+    }
+
+    return (unsigned)result;
+  }
+
   tstring ExpectNextT() {
     const char *p = ExpectNext();
     assert(p != nullptr);
@@ -200,6 +200,7 @@ const char AutoMc[] = "AutoMc";
 const char EnableExternalTriggerCruise[] = "EnableExternalTriggerCruise";
 const char OLCRules[] = "OLCRules";
 const char PredictContest[] = "PredictContest";
+const char ExactContest[] = "ExactContest";
 const char Handicap[] = "Handicap";
 const char SnailWidthScale[] = "SnailWidthScale";
 const char SnailType[] = "SnailType";
@@ -218,6 +219,7 @@ const char DisableAutoLogger[] = "DisableAutoLogger";
 const char EnableFlightLogger[] = "EnableFlightLogger";
 const char EnableNMEALogger[] = "EnableNMEALogger";
 const char MapFile[] = "MapFile"; // pL
+const char TerrainTileStore[] = "TerrainTileStore";
 const char BallastSecsToEmpty[] = "BallastSecsToEmpty";
 const char StartupTipDeclineVersion[] = "StartupTipDeclineVersion";
 const char ShowWaypointListWarning[] = "ShowWaypointListWarning";
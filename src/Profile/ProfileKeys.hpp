@@ -194,6 +194,7 @@ extern const char AutoMc[];
 extern const char EnableExternalTriggerCruise[];
 extern const char OLCRules[];
 extern const char PredictContest[];
+extern const char ExactContest[];
 extern const char Handicap[];
 extern const char SnailWidthScale[];
 extern const char SnailType[];
@@ -213,6 +214,7 @@ extern const char DisableAutoLogger[];
 extern const char EnableFlightLogger[];
 extern const char EnableNMEALogger[];
 extern const char MapFile[];
+extern const char TerrainTileStore[];
 extern const char BallastSecsToEmpty[];
 extern const char ShowWaypointListWarning[];
 extern const char StartupTipId[];
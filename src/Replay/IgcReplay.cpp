@@ -22,17 +22,16 @@
 */
 
 #include "Replay/IgcReplay.hpp"
+#include "IGC/IGCMappedReader.hpp"
 #include "IGC/IGCParser.hpp"
 #include "IGC/IGCFix.hpp"
-#include "IO/LineReader.hpp"
 #include "NMEA/Info.hpp"
 #include "Units/System.hpp"
 
-IgcReplay::IgcReplay(NLineReader *_reader)
+IgcReplay::IgcReplay(IGCMappedReader *_reader)
   :AbstractReplay(),
    reader(_reader)
 {
-  extensions.clear();
 }
 
 IgcReplay::~IgcReplay()
@@ -41,16 +40,26 @@ IgcReplay::~IgcReplay()
 }
 
 inline bool
-IgcReplay::ScanBuffer(const char *buffer, IGCFix &fix, NMEAInfo &basic)
+IgcReplay::ScanBuffer(ConstBuffer<char> line, IGCFix &fix, NMEAInfo &basic)
 {
-  if (IGCParseFix(buffer, extensions, fix) && fix.gps_valid)
-    return true;
+  if (line.IsEmpty())
+    return false;
+
+  switch (line.data[0]) {
+  case 'B':
+    return reader->ParseFix(line, fix) && fix.gps_valid;
+
+  case 'H': {
+    BrokenDate date;
+    if (IGCParseDateRecord(reader->Terminate(line), date))
+      basic.ProvideDate(date);
+    break;
+  }
 
-  BrokenDate date;
-  if (IGCParseDateRecord(buffer, date))
-    basic.ProvideDate(date);
-  else
-    IGCParseExtensions(buffer, extensions);
+  case 'I':
+    reader->ParseExtensions(line);
+    break;
+  }
 
   return false;
 }
@@ -58,10 +67,10 @@ IgcReplay::ScanBuffer(const char *buffer, IGCFix &fix, NMEAInfo &basic)
 inline bool
 IgcReplay::ReadPoint(IGCFix &fix, NMEAInfo &basic)
 {
-  char *buffer;
+  ConstBuffer<char> line;
 
-  while ((buffer = reader->ReadLine()) != nullptr) {
-    if (ScanBuffer(buffer, fix, basic))
+  while (!(line = reader->ReadLine()).IsNull()) {
+    if (ScanBuffer(line, fix, basic))
       return true;
   }
 
@@ -25,20 +25,18 @@ Copyright_License {
 #define IGC_REPLAY_HPP
 
 #include "AbstractReplay.hpp"
-#include "IGC/IGCExtensions.hpp"
+#include "Util/ConstBuffer.hxx"
 #include "Compiler.h"
 
-class NLineReader;
+class IGCMappedReader;
 struct IGCFix;
 
 class IgcReplay: public AbstractReplay
 {
-  NLineReader *reader;
-
-  IGCExtensions extensions;
+  IGCMappedReader *reader;
 
 public:
-  IgcReplay(NLineReader *reader);
+  IgcReplay(IGCMappedReader *reader);
   ~IgcReplay() override;
 
   bool Update(NMEAInfo &data) override;
@@ -49,7 +47,7 @@ private:
    *
    * @return true if a new fix was found
    */
-  bool ScanBuffer(const char *buffer, IGCFix &fix, NMEAInfo &basic);
+  bool ScanBuffer(ConstBuffer<char> line, IGCFix &fix, NMEAInfo &basic);
 
   /**
    * Read from the IGC file until a new fix was found.
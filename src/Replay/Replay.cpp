@@ -29,6 +29,7 @@
 #include "Util/Clamp.hpp"
 #include "OS/PathName.hpp"
 #include "IO/FileLineReader.hpp"
+#include "IGC/IGCMappedReader.hpp"
 #include "Blackboard/DeviceBlackboard.hpp"
 #include "Logger/Logger.hpp"
 #include "Components.hpp"
@@ -86,7 +87,7 @@ Replay::Start(const TCHAR *_path)
   if (StringIsEmpty(path)) {
     replay = new DemoReplayGlue(task_manager);
   } else if (MatchesExtension(path, _T(".igc"))) {
-    auto reader = new FileLineReaderA(path);
+    auto reader = new IGCMappedReader(path);
     if (reader->error()) {
       delete reader;
       return false;
@@ -161,6 +161,17 @@ public:
 #endif
   }
 
+  /**
+   * Returns a pointer to the specified row, counting from the top.
+   */
+  BGRColor *GetRow(unsigned y) {
+#ifndef USE_GDI
+    return buffer + y * corrected_width;
+#else
+    return buffer + (height - 1 - y) * corrected_width;
+#endif
+  }
+
   /**
    * Returns a pointer to the row below the current one.
    */
@@ -39,6 +39,13 @@ public:
 
   void SetTerrain(const RasterTerrain *terrain);
 
+  /**
+   * @see RoutePlanner::SetExecutor()
+   */
+  void SetExecutor(ParallelExecutor *executor) {
+    planner.SetExecutor(executor);
+  }
+
   void UpdatePolar(const GlideSettings &settings,
                    const GlidePolar &polar,
                    const GlidePolar &safety_polar,
@@ -55,6 +62,11 @@ public:
     return planner.IsReachEmpty();
   }
 
+  gcc_pure
+  fixed GetReachStaleness(const AGeoPoint &origin) const {
+    return planner.GetReachStaleness(origin);
+  }
+
   void ClearReach() {
     planner.ClearReach();
   }
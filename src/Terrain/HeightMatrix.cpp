@@ -28,6 +28,12 @@ Copyright_License {
 #include "Geo/GeoBounds.hpp"
 #else
 #include "Projection/WindowProjection.hpp"
+#include "Screen/Point.hpp"
+
+#include <algorithm>
+
+#include <stdlib.h>
+#include <string.h>
 #endif
 
 #include <assert.h>
@@ -87,12 +93,54 @@ HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
   SetSize((screen_width + quantisation_pixels - 1) / quantisation_pixels,
           (screen_height + quantisation_pixels - 1) / quantisation_pixels);
 
-  short *p = data.begin();
-  for (unsigned y = 0; y < screen_height;
-       y += quantisation_pixels, p += width) {
-    map.ScanLine(projection.ScreenToGeo(0, y),
-                 projection.ScreenToGeo(screen_width, y),
-                 p, width, interpolate);
+  Fill(map, projection, quantisation_pixels, interpolate,
+       PixelRect(0, 0, width, height));
+}
+
+void
+HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
+                   unsigned quantisation_pixels, bool interpolate,
+                   const PixelRect &rc)
+{
+  assert(rc.left >= 0 && rc.left < rc.right && unsigned(rc.right) <= width);
+  assert(rc.top >= 0 && rc.top < rc.bottom && unsigned(rc.bottom) <= height);
+
+  const unsigned screen_width = projection.GetScreenWidth();
+  const int x0 = rc.left * screen_width / width;
+  const int x1 = rc.right * screen_width / width;
+  const unsigned n = rc.right - rc.left;
+
+  short *p = data.begin() + rc.top * width + rc.left;
+  for (int y = rc.top * quantisation_pixels,
+         y_end = rc.bottom * quantisation_pixels;
+       y < y_end; y += quantisation_pixels, p += width) {
+    map.ScanLine(projection.ScreenToGeo(x0, y),
+                 projection.ScreenToGeo(x1, y),
+                 p, n, interpolate);
+  }
+}
+
+void
+HeightMatrix::Scroll(int dx, int dy)
+{
+  assert(unsigned(abs(dx)) < width);
+  assert(unsigned(abs(dy)) < height);
+
+  const unsigned n = width - abs(dx);
+  const unsigned src_x = std::max(dx, 0), dest_x = std::max(-dx, 0);
+
+  const auto move_row = [this, dy, n, src_x, dest_x](unsigned y) {
+    memmove(data.begin() + y * width + dest_x,
+            data.begin() + (y + dy) * width + src_x,
+            n * sizeof(data[0]));
+  };
+
+  if (dy >= 0) {
+    for (unsigned y = 0, end = height - dy; y < end; ++y)
+      move_row(y);
+  } else {
+    for (unsigned y = height; y-- > unsigned(-dy);)
+      move_row(y);
   }
 }
 
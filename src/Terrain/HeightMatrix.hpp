@@ -34,6 +34,7 @@ class RasterMap;
 class GeoBounds;
 #else
 class WindowProjection;
+struct PixelRect;
 #endif
 
 class HeightMatrix : private NonCopyable {
@@ -61,6 +62,22 @@ public:
    */
   void Fill(const RasterMap &map, const WindowProjection &map_projection,
             unsigned quantisation_pixels, bool interpolate);
+
+  /**
+   * Copy values from the #RasterMap to the specified range of cells,
+   * keeping all others.  The size must have been set up already by
+   * the other Fill() method.
+   */
+  void Fill(const RasterMap &map, const WindowProjection &map_projection,
+            unsigned quantisation_pixels, bool interpolate,
+            const PixelRect &rc);
+
+  /**
+   * Move the values by the specified number of cells: the new cell
+   * (x, y) gets the value of the old cell (x+dx, y+dy).  The exposed
+   * cells are undefined and need to be filled by the caller.
+   */
+  void Scroll(int dx, int dy);
 #endif
 
   unsigned GetWidth() const {
@@ -0,0 +1,116 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_OPTIMISED_SLOPE_SHADING_HPP
+#define XCSOAR_TERRAIN_OPTIMISED_SLOPE_SHADING_HPP
+
+#include "SlopeShading.hpp"
+
+#ifndef FIXED_MATH
+
+#ifdef __ARM_NEON__
+#include "SlopeShadingNEON.hpp"
+#elif defined(__SSE2__)
+#include "SlopeShadingSSE2.hpp"
+#endif
+
+#endif
+
+/**
+ * This class hosts two base classes: one that is optimised (e.g. via
+ * SIMD) and one that is portable (but slow).  The optimised one will
+ * be used as much as possible, and for the odd remainder, we use the
+ * portable version.
+ */
+template<typename Optimised, unsigned N, typename Portable>
+class SelectOptimisedSlopeShading : protected Optimised, protected Portable {
+public:
+  static constexpr unsigned PORTABLE_MASK = N - 1;
+  static constexpr unsigned OPTIMISED_MASK = ~PORTABLE_MASK;
+
+  explicit SelectOptimisedSlopeShading(const SlopeShadingParameters &params)
+    :Optimised(params), Portable(params) {}
+
+  gcc_flatten
+  void ShadeRow(int8_t *gcc_restrict dest, const short *gcc_restrict src,
+                unsigned n,
+                unsigned row_minus_offset, unsigned row_plus_offset,
+                unsigned column_offset, unsigned p31) const {
+    const unsigned no = n & OPTIMISED_MASK;
+    const unsigned np = n & PORTABLE_MASK;
+
+    Optimised::ShadeRow(dest, src, no,
+                        row_minus_offset, row_plus_offset,
+                        column_offset, p31);
+    Portable::ShadeRow(dest + no, src + no, np,
+                       row_minus_offset, row_plus_offset,
+                       column_offset, p31);
+  }
+
+  gcc_flatten
+  static void ClassifyRow(uint8_t *gcc_restrict height_index,
+                          uint8_t *gcc_restrict contour,
+                          const short *gcc_restrict src, unsigned n,
+                          unsigned height_scale,
+                          unsigned contour_height_scale) {
+    const unsigned no = n & OPTIMISED_MASK;
+    const unsigned np = n & PORTABLE_MASK;
+
+    Optimised::ClassifyRow(height_index, contour, src, no,
+                           height_scale, contour_height_scale);
+    Portable::ClassifyRow(height_index + no, contour + no, src + no, np,
+                          height_scale, contour_height_scale);
+  }
+};
+
+#if defined(__ARM_NEON__) && !defined(FIXED_MATH)
+
+class SlopeShading
+  : public SelectOptimisedSlopeShading<NEONSlopeShading, 8,
+                                       PortableSlopeShading> {
+public:
+  explicit SlopeShading(const SlopeShadingParameters &params)
+    :SelectOptimisedSlopeShading(params) {}
+};
+
+#elif defined(__SSE2__) && !defined(FIXED_MATH)
+
+class SlopeShading
+  : public SelectOptimisedSlopeShading<SSE2SlopeShading, 8,
+                                       PortableSlopeShading> {
+public:
+  explicit SlopeShading(const SlopeShadingParameters &params)
+    :SelectOptimisedSlopeShading(params) {}
+};
+
+#else
+
+class SlopeShading : public PortableSlopeShading {
+public:
+  explicit constexpr SlopeShading(const SlopeShadingParameters &params)
+    :PortableSlopeShading(params) {}
+};
+
+#endif
+
+#endif
@@ -111,6 +111,10 @@ public:
     data.Reset();
   }
 
+  void Swap(RasterBuffer &other) {
+    data.Swap(other.data);
+  }
+
   void Resize(unsigned _width, unsigned _height);
 
   gcc_pure
@@ -24,6 +24,7 @@ Copyright_License {
 #include "Terrain/RasterMap.hpp"
 #include "Geo/GeoClip.hpp"
 #include "IO/FileCache.hpp"
+#include "OS/FileMapping.hpp"
 #include "Util/ConvertString.hpp"
 
 #include <algorithm>
@@ -38,6 +39,8 @@ static const TCHAR *const terrain_cache_name = _T("terrain_fixed");
 static const TCHAR *const terrain_cache_name = _T("terrain");
 #endif
 
+static const TCHAR *const terrain_tiles_cache_name = _T("terrain_tiles");
+
 static char *
 ToNarrowPath(const TCHAR *src)
 {
@@ -45,8 +48,9 @@ ToNarrowPath(const TCHAR *src)
 }
 
 RasterMap::RasterMap(const TCHAR *_path, const TCHAR *world_file,
-                     FileCache *cache, OperationEnvironment &operation)
-  :path(ToNarrowPath(_path))
+                     FileCache *cache, OperationEnvironment &operation,
+                     bool use_tile_store)
+  :path(ToNarrowPath(_path)), tile_store(nullptr)
 {
   bool cache_loaded = false;
   if (cache != NULL) {
@@ -74,15 +78,56 @@ RasterMap::RasterMap(const TCHAR *_path, const TCHAR *world_file,
     }
   }
 
+  if (cache != NULL && use_tile_store)
+    LoadTileStore(*cache, _path, operation);
+
   projection.Set(GetBounds(),
                  raster_tile_cache.GetFineWidth(),
                  raster_tile_cache.GetFineHeight());
 }
 
 RasterMap::~RasterMap() {
+  raster_tile_cache.ClearTileStore();
+  delete tile_store;
   free(path);
 }
 
+void
+RasterMap::LoadTileStore(FileCache &cache, const TCHAR *_path,
+                         OperationEnvironment &operation)
+{
+  assert(tile_store == nullptr);
+
+  size_t offset;
+  tile_store = cache.Map(terrain_tiles_cache_name, _path, offset);
+  if (tile_store == nullptr) {
+    /* not yet available: decode all tiles once and write the store */
+    FILE *file = cache.Save(terrain_tiles_cache_name, _path);
+    if (file == NULL)
+      return;
+
+    if (!raster_tile_cache.SaveTileStore(path, file, operation)) {
+      cache.Cancel(terrain_tiles_cache_name, file);
+      return;
+    }
+
+    if (!cache.Commit(terrain_tiles_cache_name, file))
+      return;
+
+    tile_store = cache.Map(terrain_tiles_cache_name, _path, offset);
+    if (tile_store == nullptr)
+      return;
+  }
+
+  if (!raster_tile_cache.SetTileStore(tile_store->at(offset),
+                                      tile_store->size() - offset)) {
+    /* stale or corrupt; discard it, it will be rebuilt next time */
+    delete tile_store;
+    tile_store = nullptr;
+    cache.Flush(terrain_tiles_cache_name);
+  }
+}
+
 static unsigned
 AngleToPixel(Angle value, Angle start, Angle end, unsigned width)
 {
@@ -107,6 +152,39 @@ RasterMap::SetViewCenter(const GeoPoint &location, fixed radius)
                                 projection.DistancePixelsCoarse(radius));
 }
 
+bool
+RasterMap::PrepareTiles(const GeoPoint &location, fixed radius,
+                        ConstBuffer<GeoPoint> prefetch, fixed prefetch_radius)
+{
+  if (!raster_tile_cache.GetInitialised())
+    return false;
+
+  const GeoBounds &bounds = GetBounds();
+
+  int x = AngleToPixel(location.longitude, bounds.GetWest(), bounds.GetEast(),
+                       raster_tile_cache.GetWidth());
+
+  int y = AngleToPixel(location.latitude, bounds.GetNorth(), bounds.GetSouth(),
+                       raster_tile_cache.GetHeight());
+
+  StaticArray<SignedRasterLocation, 16> prefetch_pixels;
+  for (const GeoPoint &p : prefetch) {
+    if (prefetch_pixels.full())
+      break;
+
+    if (p.IsValid() && IsInside(p))
+      prefetch_pixels.append(projection.ProjectCoarse(p));
+  }
+
+  const ConstBuffer<SignedRasterLocation>
+    prefetch_buffer(prefetch_pixels.begin(), prefetch_pixels.size());
+
+  return raster_tile_cache.PrepareTiles(x, y,
+                                        projection.DistancePixelsCoarse(radius),
+                                        prefetch_buffer,
+                                        projection.DistancePixelsCoarse(prefetch_radius));
+}
+
 short
 RasterMap::GetHeight(const GeoPoint &location) const
 {
@@ -121,6 +199,30 @@ RasterMap::GetInterpolatedHeight(const GeoPoint &location) const
   return raster_tile_cache.GetInterpolatedHeight(pt.x, pt.y);
 }
 
+void
+RasterMap::GetHeights(ConstBuffer<GeoPoint> locations, short *heights) const
+{
+  /* project in chunks to avoid a heap allocation */
+  constexpr unsigned CHUNK_SIZE = 64;
+  RasterLocation pixels[CHUNK_SIZE];
+
+  while (!locations.IsEmpty()) {
+    const unsigned n = std::min<size_t>(locations.size, CHUNK_SIZE);
+
+    for (unsigned i = 0; i < n; ++i)
+      /* negative (out of range) coordinates wrap around, and will be
+         rejected by the range check in RasterTileCache */
+      pixels[i] = projection.ProjectCoarse(locations.data[i]);
+
+    raster_tile_cache.GetHeights(ConstBuffer<RasterLocation>(pixels, n),
+                                 heights);
+
+    locations.data += n;
+    locations.size -= n;
+    heights += n;
+  }
+}
+
 void
 RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
                     short *buffer, unsigned size, bool interpolate) const
@@ -33,6 +33,7 @@ Copyright_License {
 #include <tchar.h>
 
 class FileCache;
+class FileMapping;
 class OperationEnvironment;
 
 class RasterMap : private NonCopyable {
@@ -40,11 +41,27 @@ class RasterMap : private NonCopyable {
   RasterTileCache raster_tile_cache;
   RasterProjection projection;
 
+  /**
+   * The memory-mapped pre-decoded tile store, see
+   * RasterTileCache::SetTileStore().  nullptr if disabled.
+   */
+  FileMapping *tile_store;
+
 public:
+  /**
+   * @param use_tile_store write (once) and use a pre-decoded tile
+   * store in the #FileCache; this trades disk space for much faster
+   * tile activation
+   */
   RasterMap(const TCHAR *path, const TCHAR *world_file, FileCache *cache,
-            OperationEnvironment &operation);
+            OperationEnvironment &operation, bool use_tile_store=false);
   ~RasterMap();
 
+private:
+  void LoadTileStore(FileCache &cache, const TCHAR *path,
+                     OperationEnvironment &operation);
+
+public:
   bool IsDefined() const {
     return raster_tile_cache.GetInitialised();
   }
@@ -65,6 +82,31 @@ public:
 
   void SetViewCenter(const GeoPoint &location, fixed radius);
 
+  /**
+   * Asynchronous alternative to SetViewCenter(), see
+   * RasterTileCache::PrepareTiles().
+   *
+   * @param prefetch locations where tiles shall be loaded in advance
+   * @param prefetch_radius the radius around each prefetch location
+   * [m]
+   */
+  bool PrepareTiles(const GeoPoint &location, fixed radius,
+                    ConstBuffer<GeoPoint> prefetch, fixed prefetch_radius);
+
+  /**
+   * @see RasterTileCache::DecodeTiles()
+   */
+  bool DecodeTiles() {
+    return raster_tile_cache.DecodeTiles(path);
+  }
+
+  /**
+   * @see RasterTileCache::CommitTiles()
+   */
+  void CommitTiles() {
+    raster_tile_cache.CommitTiles();
+  }
+
   /**
    * Determines if SetViewCenter() should be called again to continue
    * loading.
@@ -101,6 +143,17 @@ public:
   gcc_pure
   short GetInterpolatedHeight(const GeoPoint &location) const;
 
+  /**
+   * Determine the non-interpolated heights of many locations in one
+   * pass, see RasterTileCache::GetHeights().  This is cheaper than
+   * calling GetHeight() for each location, especially when the
+   * locations are close to each other.
+   *
+   * @param heights the destination array, with one element per
+   * location
+   */
+  void GetHeights(ConstBuffer<GeoPoint> locations, short *heights) const;
+
   /**
    * Scan a straight line and fill the buffer with the specified
    * number of samples along the line.
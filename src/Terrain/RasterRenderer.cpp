@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "Terrain/RasterRenderer.hpp"
 #include "Terrain/RasterMap.hpp"
+#include "Terrain/OptimisedSlopeShading.hpp"
 #include "Math/FastMath.h"
 #include "Util/Clamp.hpp"
 #include "Screen/Ramp.hpp"
@@ -34,6 +35,8 @@ Copyright_License {
 
 #include <assert.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 /**
  * Interpolate between x and y with i/128, i.e. i/(1 << 7).
@@ -97,7 +100,13 @@ RasterRenderer::RasterRenderer()
    bounds(GeoBounds::Invalid()),
 #endif
    image(NULL),
-   contour_column_base(NULL)
+#ifndef ENABLE_OPENGL
+   scan_projection_valid(false),
+   generate_all(true), scroll_x(0), scroll_y(0),
+#endif
+   contour_column_base(NULL),
+   height_index_row(NULL), contour_row(NULL),
+   illumination_row(NULL)
 {
   // scale quantisation_pixels so resolution is not too high on old hardware
   // with large displays
@@ -110,6 +119,9 @@ RasterRenderer::~RasterRenderer()
 {
   delete image;
   delete[] contour_column_base;
+  delete[] height_index_row;
+  delete[] contour_row;
+  delete[] illumination_row;
 }
 
 #ifdef ENABLE_OPENGL
@@ -186,9 +198,104 @@ RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection
   last_quantisation_pixels = quantisation_pixels;
 #else
   height_matrix.Fill(map, projection, quantisation_pixels, true);
+
+  scan_projection = projection;
+  scan_projection_valid = true;
+  generate_all = true;
+  scroll_x = scroll_y = 0;
 #endif
 }
 
+#ifndef ENABLE_OPENGL
+
+/**
+ * Round the quotient to the nearest integer.
+ */
+gcc_const
+static int
+RoundDivide(int a, int b)
+{
+  assert(b > 0);
+
+  return a >= 0
+    ? (a + b / 2) / b
+    : -((-a + b / 2) / b);
+}
+
+bool
+RasterRenderer::ScrollMap(const RasterMap &map,
+                          const WindowProjection &projection)
+{
+  if (!scan_projection_valid ||
+      projection.GetScreenWidth() != scan_projection.GetScreenWidth() ||
+      projection.GetScreenHeight() != scan_projection.GetScreenHeight())
+    return false;
+
+  const int q = quantisation_pixels;
+  const int width = height_matrix.GetWidth();
+  const int height = height_matrix.GetHeight();
+
+  /* how far (in cells) did the screen center move? */
+  const RasterPoint center = projection.GetScreenCenter();
+  const RasterPoint old_center =
+    scan_projection.GeoToScreen(projection.ScreenToGeo(center));
+  const int dx = RoundDivide(old_center.x - center.x, q);
+  const int dy = RoundDivide(old_center.y - center.y, q);
+  if (abs(dx) >= width || abs(dy) >= height)
+    return false;
+
+  /* move the old projection by whole cells, and check whether it
+     matches the new one; this fails if the map was zoomed or
+     rotated */
+  WindowProjection moved = scan_projection;
+  const RasterPoint origin = scan_projection.GetScreenOrigin();
+  moved.SetGeoLocation(scan_projection.ScreenToGeo(origin.x + dx * q,
+                                                   origin.y + dy * q));
+
+  const RasterPoint corners[] = {
+    { 0, 0 },
+    { int(projection.GetScreenWidth()), 0 },
+    { 0, int(projection.GetScreenHeight()) },
+    { int(projection.GetScreenWidth()), int(projection.GetScreenHeight()) },
+  };
+
+  for (const RasterPoint &corner : corners) {
+    const RasterPoint p = projection.GeoToScreen(moved.ScreenToGeo(corner));
+    if (abs(p.x - corner.x) > q || abs(p.y - corner.y) > q)
+      return false;
+  }
+
+  if (dx == 0 && dy == 0)
+    /* close enough, keep the current image */
+    return true;
+
+  scan_projection = moved;
+
+  height_matrix.Scroll(dx, dy);
+
+  if (dy != 0)
+    height_matrix.Fill(map, scan_projection, quantisation_pixels, true,
+                       dy > 0
+                       ? PixelRect(0, height - dy, width, height)
+                       : PixelRect(0, 0, width, -dy));
+
+  if (dx != 0) {
+    /* the rows filled above are skipped here */
+    const int top = std::max(-dy, 0), bottom = height - std::max(dy, 0);
+    if (top < bottom)
+      height_matrix.Fill(map, scan_projection, quantisation_pixels, true,
+                         dx > 0
+                         ? PixelRect(width - dx, top, width, bottom)
+                         : PixelRect(0, top, -dx, bottom));
+  }
+
+  scroll_x += dx;
+  scroll_y += dy;
+  return true;
+}
+
+#endif
+
 void
 RasterRenderer::GenerateImage(bool do_shading,
                               unsigned height_scale,
@@ -196,6 +303,14 @@ RasterRenderer::GenerateImage(bool do_shading,
                               const Angle sunazimuth,
                               bool do_contour)
 {
+  bool all = true;
+#ifndef ENABLE_OPENGL
+  all = generate_all;
+  generate_all = false;
+  const int dx = scroll_x, dy = scroll_y;
+  scroll_x = scroll_y = 0;
+#endif
+
   if (image == NULL ||
       height_matrix.GetWidth() > image->GetWidth() ||
       height_matrix.GetHeight() > image->GetHeight()) {
@@ -204,6 +319,15 @@ RasterRenderer::GenerateImage(bool do_shading,
 
     delete[] contour_column_base;
     contour_column_base = new unsigned char[height_matrix.GetWidth()];
+
+    delete[] height_index_row;
+    height_index_row = new unsigned char[height_matrix.GetWidth()];
+    delete[] contour_row;
+    contour_row = new unsigned char[height_matrix.GetWidth()];
+    delete[] illumination_row;
+    illumination_row = new int8_t[height_matrix.GetWidth()];
+
+    all = true;
   }
 
   if (quantisation_effective == 0) {
@@ -213,49 +337,150 @@ RasterRenderer::GenerateImage(bool do_shading,
 
   const unsigned contour_height_scale = do_contour? height_scale * 2 : 16;
 
-  ContourStart(contour_height_scale);
+#ifndef ENABLE_OPENGL
+  if (!all) {
+    ScrollImage(dx, dy, do_shading, height_scale, contrast, brightness,
+                sunazimuth, contour_height_scale);
+    return;
+  }
+#endif
+
+  GenerateImage(do_shading, height_scale, contrast, brightness,
+                sunazimuth, contour_height_scale,
+                PixelRect(0, 0,
+                          height_matrix.GetWidth(),
+                          height_matrix.GetHeight()));
+}
+
+void
+RasterRenderer::GenerateImage(bool do_shading, unsigned height_scale,
+                              int contrast, int brightness,
+                              const Angle sunazimuth,
+                              unsigned contour_height_scale,
+                              const PixelRect &rc)
+{
+  assert(rc.left >= 0 && rc.left < rc.right);
+  assert(unsigned(rc.right) <= height_matrix.GetWidth());
+  assert(rc.top >= 0 && rc.top < rc.bottom);
+  assert(unsigned(rc.bottom) <= height_matrix.GetHeight());
+
+  ContourStart(contour_height_scale, rc);
 
   if (do_shading)
     GenerateSlopeImage(height_scale, contrast, brightness,
-                       sunazimuth, contour_height_scale);
+                       sunazimuth, contour_height_scale, rc);
   else
-    GenerateUnshadedImage(height_scale, contour_height_scale);
+    GenerateUnshadedImage(height_scale, contour_height_scale, rc);
 
   image->SetDirty();
 }
 
+#ifndef ENABLE_OPENGL
+
+void
+RasterRenderer::ScrollImage(int dx, int dy,
+                            bool do_shading, unsigned height_scale,
+                            int contrast, int brightness,
+                            const Angle sunazimuth,
+                            unsigned contour_height_scale)
+{
+  if (dx == 0 && dy == 0)
+    return;
+
+  const int width = height_matrix.GetWidth();
+  const int height = height_matrix.GetHeight();
+
+  assert(abs(dx) < width);
+  assert(abs(dy) < height);
+
+  /* move the existing image */
+
+  const unsigned n = width - abs(dx);
+  const unsigned src_x = std::max(dx, 0), dest_x = std::max(-dx, 0);
+
+  const auto move_row = [this, dy, n, src_x, dest_x](unsigned y) {
+    memmove(image->GetRow(y) + dest_x, image->GetRow(y + dy) + src_x,
+            n * sizeof(BGRColor));
+  };
+
+  if (dy >= 0) {
+    for (unsigned y = 0, end = height - dy; y < end; ++y)
+      move_row(y);
+  } else {
+    for (unsigned y = height; y-- > unsigned(-dy);)
+      move_row(y);
+  }
+
+  /* render the exposed strips; pixels near the old and the new
+     edges are rendered again, because slope shading and contour
+     lines depend on their neighbours */
+
+  const int margin = std::max(quantisation_effective, 1u);
+
+  const auto generate = [&](int left, int top, int right, int bottom) {
+    left = std::max(left, 0);
+    top = std::max(top, 0);
+    right = std::min(right, width);
+    bottom = std::min(bottom, height);
+    if (left < right && top < bottom)
+      GenerateImage(do_shading, height_scale, contrast, brightness,
+                    sunazimuth, contour_height_scale,
+                    PixelRect(left, top, right, bottom));
+  };
+
+  if (dy > 0) {
+    generate(0, height - dy - margin, width, height);
+    generate(0, 0, width, margin);
+  } else if (dy < 0) {
+    generate(0, 0, width, -dy + margin);
+    generate(0, height - margin, width, height);
+  }
+
+  if (dx > 0) {
+    generate(width - dx - margin, 0, width, height);
+    generate(0, 0, margin, height);
+  } else if (dx < 0) {
+    generate(0, 0, -dx + margin, height);
+    generate(width - margin, 0, width, height);
+  }
+}
+
+#endif
+
 void
 RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
-                                      const unsigned contour_height_scale)
+                                      const unsigned contour_height_scale,
+                                      const PixelRect &rc)
 {
-  const short *src = height_matrix.GetData();
+  const unsigned n = rc.right - rc.left;
   const BGRColor *oColorBuf = color_table + 64 * 256;
-  BGRColor *dest = image->GetTopRow();
 
-  for (unsigned y = height_matrix.GetHeight(); y > 0; --y) {
-    BGRColor *p = dest;
-    dest = image->GetNextRow(dest);
+  for (int y = rc.top; y < rc.bottom; ++y) {
+    const short *src = height_matrix.GetRow(y);
+    BGRColor *p = image->GetRow(y) + rc.left;
 
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    SlopeShading::ClassifyRow(height_index_row + rc.left,
+                              contour_row + rc.left, src + rc.left, n,
+                              height_scale, contour_height_scale);
 
-    for (unsigned x = height_matrix.GetWidth(); x > 0; --x) {
-      int h = *src++;
-      if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
-        if (h < 0)
-          h = 0;
+    unsigned contour_row_base =
+      ContourInterval(src[rc.left > 0 ? rc.left - 1 : 0],
+                      contour_height_scale);
+    unsigned char *contour_this_column_base = contour_column_base + rc.left;
 
-        const unsigned contour_interval =
-          ContourInterval(h, contour_height_scale);
+    for (unsigned x = rc.left; x < unsigned(rc.right); ++x) {
+      const int h = src[x];
+      if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
+        const unsigned h_index = height_index_row[x];
+        const unsigned contour_interval = contour_row[x];
 
-        h = std::min(254, h >> height_scale);
         if (gcc_unlikely((contour_interval != contour_row_base)
                          || (contour_interval != *contour_this_column_base))) {
 
-          *p++ = oColorBuf[h - 64 * 256];
+          *p++ = oColorBuf[h_index - 64 * 256];
           *contour_this_column_base = contour_row_base = contour_interval;
         } else {
-          *p++ = oColorBuf[h];
+          *p++ = oColorBuf[h_index];
         }
       } else if (RasterBuffer::IsWater(h)) {
         // we're in the water, so look up the color for water
@@ -270,19 +495,6 @@ RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
   }
 }
 
-/**
- * Clip the difference between two adjacent terrain height values to
- * sane bounds.  This works around integer overflows in the
- * GenerateSlopeImage() formula when the map file is broken, avoiding
- * the sqrt() call with a negative argument.
- */
-gcc_const
-static int
-ClipHeightDelta(int d)
-{
-  return Clamp(d, -512, 512);
-}
-
 // JMW: if zoomed right in (e.g. one unit is larger than terrain
 // grid), then increase the step size to be equal to the terrain
 // grid for purposes of calculating slope, to avoid shading problems
@@ -292,7 +504,8 @@ void
 RasterRenderer::GenerateSlopeImage(unsigned height_scale,
                                    int contrast,
                                    const int sx, const int sy, const int sz,
-                                   const unsigned contour_height_scale)
+                                   const unsigned contour_height_scale,
+                                   const PixelRect &rc)
 {
   assert(quantisation_effective > 0);
 
@@ -309,73 +522,95 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
              square will not overflow */
           8192u / (quantisation_effective * quantisation_effective));
 
-  const short *src = height_matrix.GetData();
+  const unsigned width = height_matrix.GetWidth();
   const BGRColor *oColorBuf = color_table + 64 * 256;
 
-  BGRColor *dest = image->GetTopRow();
+  const SlopeShadingParameters params{
+    sx, sy, sz, contrast, height_slope_factor,
+  };
+  const SlopeShading shading(params);
+
+  /* the slope of these columns is calculated by the SIMD kernel; the
+     border columns have clipped neighbours and are done one by one */
+  const unsigned interior_begin =
+    Clamp(std::min(quantisation_effective, width),
+          unsigned(rc.left), unsigned(rc.right));
+  const unsigned interior_end =
+    Clamp((unsigned)std::max(border.right, 0),
+          interior_begin, unsigned(rc.right));
+
+  for (unsigned y = rc.top; y < unsigned(rc.bottom); ++y) {
+    const short *src = height_matrix.GetRow(y);
 
-  for (unsigned y = 0; y < height_matrix.GetHeight(); ++y) {
     const unsigned row_plus_index = y < (unsigned)border.bottom
       ? quantisation_effective
       : height_matrix.GetHeight() - 1 - y;
-    const unsigned row_plus_offset = height_matrix.GetWidth() * row_plus_index;
+    const unsigned row_plus_offset = width * row_plus_index;
 
     const unsigned row_minus_index = y >= quantisation_effective
       ? quantisation_effective : y;
-    const unsigned row_minus_offset = height_matrix.GetWidth() * row_minus_index;
+    const unsigned row_minus_offset = width * row_minus_index;
 
     const unsigned p31 = row_plus_index + row_minus_index;
 
-    BGRColor *p = dest;
-    dest = image->GetNextRow(dest);
+    // Y direction
+    assert(src - row_minus_offset >= height_matrix.GetData());
+    assert(src + row_plus_offset + width <= height_matrix.GetDataEnd());
 
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    BGRColor *p = image->GetRow(y) + rc.left;
 
-    for (unsigned x = 0; x < height_matrix.GetWidth(); ++x, ++src) {
-      int h = *src;
-      if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
-        if (h < 0)
-          h = 0;
+    shading.ClassifyRow(height_index_row + rc.left, contour_row + rc.left,
+                        src + rc.left, rc.right - rc.left,
+                        height_scale, contour_height_scale);
 
-        const unsigned contour_interval =
-          ContourInterval(h, contour_height_scale);
+    const auto shade_border = [&](unsigned x) {
+      // X direction
 
-        h = std::min(254, h >> height_scale);
+      const unsigned column_plus_index = x < (unsigned)border.right
+        ? quantisation_effective
+        : width - 1 - x;
+      const unsigned column_minus_index = x >= (unsigned)border.left
+        ? quantisation_effective : x;
 
-        // no need to calculate slope if undefined height or sea level
+      assert(x >= column_minus_index);
+      assert(x + column_plus_index < width);
 
-        // Y direction
-        assert(src - row_minus_offset >= height_matrix.GetData());
-        assert(src + row_plus_offset >= height_matrix.GetData());
-        assert(src - row_minus_offset < height_matrix.GetDataEnd());
-        assert(src + row_plus_offset < height_matrix.GetDataEnd());
+      const short *s = src + x;
+      illumination_row[x] =
+        CalculateSlopeShading(params,
+                              s[-(int)row_minus_offset], s[row_plus_offset],
+                              s[-(int)column_minus_index],
+                              s[column_plus_index],
+                              column_plus_index + column_minus_index, p31);
+    };
 
-        // X direction
+    for (unsigned x = rc.left; x < interior_begin; ++x)
+      shade_border(x);
 
-        const unsigned column_plus_index = x < (unsigned)border.right
-          ? quantisation_effective
-          : height_matrix.GetWidth() - 1 - x;
-        const unsigned column_minus_index = x >= (unsigned)border.left
-          ? quantisation_effective : x;
+    shading.ShadeRow(illumination_row + interior_begin, src + interior_begin,
+                     interior_end - interior_begin,
+                     row_minus_offset, row_plus_offset,
+                     quantisation_effective, p31);
 
-        assert(src - column_minus_index >= height_matrix.GetData());
-        assert(src + column_plus_index >= height_matrix.GetData());
-        assert(src - column_minus_index < height_matrix.GetDataEnd());
-        assert(src + column_plus_index < height_matrix.GetDataEnd());
+    for (unsigned x = interior_end; x < unsigned(rc.right); ++x)
+      shade_border(x);
 
-        const int h_above = src[-(int)row_minus_offset];
-        const int h_below = src[row_plus_offset];
-        const int h_left = src[-(int)column_minus_index];
-        const int h_right = src[column_plus_index];
+    unsigned contour_row_base =
+      ContourInterval(src[rc.left > 0 ? rc.left - 1 : 0],
+                      contour_height_scale);
+    unsigned char *contour_this_column_base = contour_column_base + rc.left;
+
+    for (unsigned x = rc.left; x < unsigned(rc.right); ++x) {
+      const int h = src[x];
+      if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
+        const unsigned h_index = height_index_row[x];
+        const unsigned contour_interval = contour_row[x];
 
-        if (gcc_unlikely(RasterBuffer::IsSpecial(h_above) ||
-                         RasterBuffer::IsSpecial(h_below) ||
-                         RasterBuffer::IsSpecial(h_left) ||
-                         RasterBuffer::IsSpecial(h_right))) {
+        const int illumination = illumination_row[x];
+        if (gcc_unlikely(illumination == SLOPE_SHADING_SPECIAL)) {
           /* some "special" terrain value surrounding us (water or
-             invalid), skip slope calculation */
-          *p++ = oColorBuf[h];
+             invalid), skip slope shading */
+          *p++ = oColorBuf[h_index];
           contour_this_column_base++;
           continue;
         }
@@ -384,33 +619,11 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
                          || (contour_interval != *contour_this_column_base))) {
 
           *contour_this_column_base++ = contour_row_base = contour_interval;
-          *p++ = oColorBuf[h-64*256];
+          *p++ = oColorBuf[h_index - 64 * 256];
           continue;
         }
 
-        const int p32 = ClipHeightDelta(h_above - h_below);
-        const int p22 = ClipHeightDelta(h_right - h_left);
-
-        const unsigned p20 = column_plus_index + column_minus_index;
-
-        const int dd0 = p22 * int(p31);
-        const int dd1 = int(p20) * p32;
-        const unsigned dd2 = p20 * p31 * height_slope_factor;
-        const int num = (int(dd2) * sz + dd0 * sx + dd1 * sy);
-        const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
-#ifdef FIXED_MATH
-        const unsigned mag = isqrt4(square_mag);
-#else
-        const unsigned mag = (unsigned)sqrt((fixed)square_mag);
-#endif
-        /* this is a workaround for a SIGFPE (division by zero)
-           observed by our users on some Android devices (e.g. Nexus
-           7), even though we did our best to make sure that the
-           integer arithmetics above can't overflow */
-        /* TODO: debug this problem and replace this workaround */
-        const int sval = num / int(mag|1);
-        const int sindex = (sval - sz) * contrast / 128;
-        *p++ = oColorBuf[h + 256 * Clamp(sindex, -63, 63)];
+        *p++ = oColorBuf[h_index + 256 * illumination];
       } else if (RasterBuffer::IsWater(h)) {
         // we're in the water, so look up the color for water
         *p++ = oColorBuf[255];
@@ -428,7 +641,8 @@ void
 RasterRenderer::GenerateSlopeImage(unsigned height_scale,
                                    int contrast, int brightness,
                                    const Angle sunazimuth,
-                                   const unsigned contour_height_scale)
+                                   const unsigned contour_height_scale,
+                                   const PixelRect &rc)
 {
   const Angle fudgeelevation = Angle::Degrees(10) +
     Angle::Degrees(80.0 / 255.0) * brightness;
@@ -438,7 +652,7 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
   const int sz = (int)(255 * fudgeelevation.fastsine());
 
   GenerateSlopeImage(height_scale, contrast,
-                     sx, sy, sz, contour_height_scale);
+                     sx, sy, sz, contour_height_scale, rc);
 }
 
 void
@@ -473,11 +687,11 @@ RasterRenderer::PrepareColorTable(const ColorRamp *color_ramp, bool do_water,
 }
 
 void
-RasterRenderer::ContourStart(const unsigned contour_height_scale)
+RasterRenderer::ContourStart(const unsigned contour_height_scale,
+                             const PixelRect &rc)
 {
-  // initialise column to first row
-  const short *src = height_matrix.GetData();
-  unsigned char *col_base = contour_column_base;
-  for (unsigned x = height_matrix.GetWidth(); x > 0; --x)
-    *col_base++ = ContourInterval(*src++, contour_height_scale);
+  // initialise column to the row above (or the first row)
+  const short *src = height_matrix.GetRow(rc.top > 0 ? rc.top - 1 : 0);
+  for (int x = rc.left; x < rc.right; ++x)
+    contour_column_base[x] = ContourInterval(src[x], contour_height_scale);
 }
@@ -29,8 +29,12 @@ Copyright_License {
 #include "Math/fixed.hpp"
 #include "Util/NonCopyable.hpp"
 
+#include <stdint.h>
+
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
+#else
+#include "Projection/WindowProjection.hpp"
 #endif
 
 #define NUM_COLOR_RAMP_LEVELS 13
@@ -40,6 +44,7 @@ class Canvas;
 class RasterMap;
 class WindowProjection;
 struct ColorRamp;
+struct PixelRect;
 
 class RasterRenderer : private NonCopyable {
   /** screen dimensions in coarse pixels */
@@ -71,8 +76,33 @@ class RasterRenderer : private NonCopyable {
   HeightMatrix height_matrix;
   RawBitmap *image;
 
+#ifndef ENABLE_OPENGL
+  /**
+   * The projection which matches the contents of the #HeightMatrix.
+   * ScrollMap() moves it by whole cells.  Only valid if
+   * #scan_projection_valid is set.
+   */
+  WindowProjection scan_projection;
+  bool scan_projection_valid;
+
+  /**
+   * Shall the next GenerateImage() call render the whole image?  If
+   * not, the previous image is moved by #scroll_x / #scroll_y cells,
+   * and only the exposed strips are rendered.
+   */
+  bool generate_all;
+
+  int scroll_x, scroll_y;
+#endif
+
   unsigned char *contour_column_base;
 
+  /**
+   * Per-row scratch buffers filled by the #SlopeShading kernels.
+   */
+  unsigned char *height_index_row, *contour_row;
+  int8_t *illumination_row;
+
   fixed pixel_size;
 
   BGRColor color_table[256 * 128];
@@ -93,11 +123,16 @@ public:
     return height_matrix.GetHeight();
   }
 
-#ifdef ENABLE_OPENGL
   void Invalidate() {
+#ifdef ENABLE_OPENGL
     bounds.SetInvalid();
+#else
+    scan_projection_valid = false;
+#endif
   }
 
+#ifdef ENABLE_OPENGL
+
   /**
    * Calculate a new #quantisation_pixels value.
    *
@@ -128,6 +163,19 @@ public:
    */
   void ScanMap(const RasterMap &map, const WindowProjection &projection);
 
+#ifndef ENABLE_OPENGL
+  /**
+   * Attempt to reuse the previous #HeightMatrix after the map was
+   * panned, and scan only the newly exposed cells.  The following
+   * GenerateImage() call will then move the image and render only the
+   * exposed strips.
+   *
+   * @return false if the projection was zoomed or rotated (or there
+   * is no previous #HeightMatrix), and the caller must call ScanMap()
+   */
+  bool ScrollMap(const RasterMap &map, const WindowProjection &projection);
+#endif
+
   /**
    * Convert the height matrix into the image.
    */
@@ -142,29 +190,56 @@ public:
 
 protected:
   /**
-   * Convert the height matrix into the image, without shading.
+   * Convert the specified range of the height matrix into the image,
+   * without shading.
    */
   void GenerateUnshadedImage(unsigned height_scale,
-                             const unsigned contour_height_scale);
+                             const unsigned contour_height_scale,
+                             const PixelRect &rc);
 
   /**
-   * Convert the height matrix into the image, with slope shading.
+   * Convert the specified range of the height matrix into the image,
+   * with slope shading.
    */
   void GenerateSlopeImage(unsigned height_scale, int contrast,
                           const int sx, const int sy, const int sz,
-                          const unsigned contour_height_scale);
+                          const unsigned contour_height_scale,
+                          const PixelRect &rc);
 
   /**
-   * Convert the height matrix into the image, with slope shading.
+   * Convert the specified range of the height matrix into the image,
+   * with slope shading.
    */
   void GenerateSlopeImage(unsigned height_scale,
                           int contrast, int brightness,
                           const Angle sunazimuth,
-                          const unsigned contour_height_scale);
+                          const unsigned contour_height_scale,
+                          const PixelRect &rc);
 
 private:
+  void GenerateImage(bool do_shading, unsigned height_scale,
+                     int contrast, int brightness,
+                     const Angle sunazimuth,
+                     unsigned contour_height_scale,
+                     const PixelRect &rc);
 
-  void ContourStart(const unsigned contour_height_scale);
+#ifndef ENABLE_OPENGL
+  /**
+   * Move the image by the specified number of cells (see
+   * HeightMatrix::Scroll()) and render the exposed strips.
+   */
+  void ScrollImage(int dx, int dy, bool do_shading, unsigned height_scale,
+                   int contrast, int brightness,
+                   const Angle sunazimuth,
+                   unsigned contour_height_scale);
+#endif
+
+  /**
+   * Initialise #contour_column_base for rendering the specified
+   * range.
+   */
+  void ContourStart(const unsigned contour_height_scale,
+                    const PixelRect &rc);
 };
 
 #endif
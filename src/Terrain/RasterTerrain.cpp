@@ -47,7 +47,11 @@ RasterTerrain::OpenTerrain(FileCache *cache, OperationEnvironment &operation)
   } else
     return NULL;
 
-  RasterTerrain *rt = new RasterTerrain(szFile, world_file, cache, operation);
+  bool use_tile_store = false;
+  Profile::Get(ProfileKeys::TerrainTileStore, use_tile_store);
+
+  RasterTerrain *rt = new RasterTerrain(szFile, world_file, cache, operation,
+                                        use_tile_store);
   if (!rt->map.IsDefined()) {
     delete rt;
     return NULL;
@@ -55,3 +59,28 @@ RasterTerrain::OpenTerrain(FileCache *cache, OperationEnvironment &operation)
 
   return rt;
 }
+
+bool
+RasterTerrain::UpdateTiles(const GeoPoint &location, fixed radius,
+                           ConstBuffer<GeoPoint> prefetch,
+                           fixed prefetch_radius)
+{
+  const ScopeLock protect(update_mutex);
+
+  {
+    ExclusiveLease lease(*this);
+    if (!lease->PrepareTiles(location, radius, prefetch, prefetch_radius))
+      return lease->IsDirty();
+  }
+
+  /* the expensive part runs without the lock; it does not modify
+     anything that is visible to readers */
+  const bool decoded = map.DecodeTiles();
+
+  /* if the file could not be opened (e.g. it has been deleted),
+     nothing was decoded; CommitTiles() disables the requested tiles,
+     and there is no point in calling us again soon */
+  ExclusiveLease lease(*this);
+  lease->CommitTiles();
+  return decoded && lease->IsDirty();
+}
@@ -27,6 +27,7 @@ Copyright_License {
 #include "RasterMap.hpp"
 #include "Geo/GeoPoint.hpp"
 #include "Thread/Guard.hpp"
+#include "Thread/Mutex.hpp"
 #include "Compiler.h"
 
 #include <tchar.h>
@@ -51,6 +52,12 @@ public:
 protected:
   RasterMap map;
 
+  /**
+   * Serialises UpdateTiles() calls, because only one thread may
+   * decode tiles at a time.
+   */
+  Mutex update_mutex;
+
 public:
 
 /** 
@@ -58,8 +65,9 @@ public:
  * 
  */
   RasterTerrain(const TCHAR *path, const TCHAR *world_file, FileCache *cache,
-                OperationEnvironment &operation)
-    :Guard<RasterMap>(map), map(path, world_file, cache, operation) {}
+                OperationEnvironment &operation, bool use_tile_store=false)
+    :Guard<RasterMap>(map),
+     map(path, world_file, cache, operation, use_tile_store) {}
 
   const Serial &GetSerial() const {
     return map.GetSerial();
@@ -100,6 +108,21 @@ public:
     return map.GetMapCenter();
   }
 
+  /**
+   * Load the tiles around the specified location (and the prefetch
+   * locations).  Unlike RasterMap::SetViewCenter(), the exclusive
+   * lock is only held while selecting and publishing tiles, not
+   * while decoding them, so readers (e.g. the calculation thread) are
+   * not blocked.  May be called from any thread.
+   *
+   * @return true if there are more tiles to be loaded, and this
+   * method should be called again soon; false if the map file could
+   * not be read
+   */
+  bool UpdateTiles(const GeoPoint &location, fixed radius,
+                   ConstBuffer<GeoPoint> prefetch=nullptr,
+                   fixed prefetch_radius=fixed(0));
+
 };
 
 #endif
@@ -75,6 +75,13 @@ public:
     return width > 0 && height > 0;
   }
 
+  /**
+   * Does this tile contain the specified pixel location?
+   */
+  bool IsInside(unsigned x, unsigned y) const {
+    return x - xstart < width && y - ystart < height;
+  }
+
   int GetDistance() const {
     return distance;
   }
@@ -94,8 +101,33 @@ public:
   bool SaveCache(FILE *file) const;
   bool LoadCache(FILE *file);
 
+  /**
+   * Calculate the (approximate) distance of the specified pixel
+   * location to this tile.
+   */
+  gcc_pure
+  unsigned CalcDistance(int x, int y) const;
+
   bool CheckTileVisibility(int view_x, int view_y, unsigned view_radius);
 
+  /**
+   * Check whether this tile is close to the specified prefetch
+   * location.  Unlike CheckTileVisibility(), it does not update
+   * #distance unless the tile is in range.
+   *
+   * @param penalty a value to be added to the distance; this ranks
+   * prefetched tiles behind the visible ones
+   */
+  bool CheckPrefetch(int x, int y, unsigned radius, unsigned penalty);
+
+  /**
+   * Swap the buffer with the specified one, which has been filled
+   * asynchronously.
+   */
+  void SwapBuffer(RasterBuffer &other) {
+    buffer.Swap(other);
+  }
+
   void Disable() {
     buffer.Reset();
   }
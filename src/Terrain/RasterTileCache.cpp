@@ -28,23 +28,58 @@ Copyright_License {
 #include "IO/ZipLineReader.hpp"
 #include "Operation/Operation.hpp"
 #include "Math/FastMath.h"
+#include "Util/AllocatedArray.hpp"
 
 #include <string.h>
 #include <algorithm>
 
+short *
+RasterTileCache::GetTileBuffer(unsigned index)
+{
+  RasterTile &tile = tiles.GetLinear(index);
+
+  if (!decoding) {
+    tile.Enable();
+    return tile.IsEnabled()
+      ? tile.GetImageBuffer()
+      : NULL;
+  }
+
+  /* asynchronous mode: don't touch the tile, because readers may be
+     accessing it concurrently */
+
+  for (unsigned i = 0; i < n_pending_tiles; ++i)
+    if (pending_tiles[i].index == index)
+      return pending_tiles[i].buffer.GetData();
+
+  if (n_pending_tiles >= pending_tiles.size() ||
+      tile.width == 0 || tile.height == 0)
+    return NULL;
+
+  PendingTile &pending = pending_tiles[n_pending_tiles++];
+  pending.index = index;
+  pending.buffer.Resize(tile.width, tile.height);
+  return pending.buffer.GetData();
+}
+
 short*
 RasterTileCache::GetImageBuffer(unsigned index)
 {
-  if (TileRequest(index))
-    return tiles.GetLinear(index).GetImageBuffer();
+  if (!tiles.GetLinear(index).IsRequested())
+    return NULL;
 
-  return NULL;
+  return GetTileBuffer(index);
 }
 
 void
 RasterTileCache::SetTile(unsigned index,
                          int xstart, int ystart, int xend, int yend)
 {
+  if (decoding)
+    /* the tile geometry is already known; don't modify it while
+       readers may be accessing it */
+    return;
+
   if (!segments.empty() && !segments.last().IsTileSegment())
     /* link current marker segment with this tile */
     segments.last().tile = index;
@@ -66,7 +101,9 @@ struct RTDistanceSort {
 };
 
 bool
-RasterTileCache::PollTiles(int x, int y, unsigned radius)
+RasterTileCache::PollTiles(int x, int y, unsigned radius,
+                           ConstBuffer<SignedRasterLocation> prefetch,
+                           unsigned prefetch_radius)
 {
   if (scan_overview)
     return false;
@@ -77,21 +114,22 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
      the screen will be loaded in advance */
   radius += 256;
 
-  /**
-   * Maximum number of tiles loaded at a time, to reduce system load
-   * peaks.
-   */
-  constexpr unsigned MAX_ACTIVATE = MAX_ACTIVE_TILES > 32
-    ? 16
-    : MAX_ACTIVE_TILES / 2;
-
-  /* query all tiles; all tiles which are either in range or already
-     loaded are added to RequestTiles */
+  /* query all tiles; all tiles which are either in range (of the
+     view center or of a prefetch location) or already loaded are
+     added to RequestTiles */
 
   request_tiles.clear();
-  for (int i = tiles.GetSize() - 1; i >= 0 && !request_tiles.full(); --i)
-    if (tiles.GetLinear(i).VisibilityChanged(x, y, radius))
+  for (int i = tiles.GetSize() - 1; i >= 0 && !request_tiles.full(); --i) {
+    RasterTile &tile = tiles.GetLinear(i);
+    bool wanted = tile.VisibilityChanged(x, y, radius);
+
+    for (const auto &p : prefetch)
+      if (tile.CheckPrefetch(p.x, p.y, prefetch_radius, radius))
+        wanted = true;
+
+    if (wanted)
       request_tiles.append(i);
+  }
 
   /* reduce if there are too many */
 
@@ -130,18 +168,6 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
   return num_activate > 0;
 }
 
-bool
-RasterTileCache::TileRequest(unsigned index)
-{
-  RasterTile &tile = tiles.GetLinear(index);
-
-  if (!tile.IsRequested())
-    return false;
-
-  tile.Enable();
-  return true; // want to load this one!
-}
-
 short
 RasterTileCache::GetHeight(unsigned px, unsigned py) const
 {
@@ -158,6 +184,29 @@ RasterTileCache::GetHeight(unsigned px, unsigned py) const
                                    py << (SUBPIXEL_BITS - OVERVIEW_BITS));
 }
 
+void
+RasterTileCache::GetHeights(ConstBuffer<RasterLocation> locations,
+                            short *heights) const
+{
+  const RasterTile *tile = nullptr;
+
+  for (const RasterLocation &p : locations) {
+    if (p.x >= width || p.y >= height) {
+      // outside overall bounds
+      *heights++ = RasterBuffer::TERRAIN_INVALID;
+      continue;
+    }
+
+    if (tile == nullptr || !tile->IsInside(p.x, p.y))
+      tile = &tiles.Get(p.x / tile_width, p.y / tile_height);
+
+    *heights++ = tile->IsEnabled()
+      ? tile->GetHeight(p.x, p.y)
+      : overview.GetInterpolated(p.x << (SUBPIXEL_BITS - OVERVIEW_BITS),
+                                 p.y << (SUBPIXEL_BITS - OVERVIEW_BITS));
+  }
+}
+
 short
 RasterTileCache::GetInterpolatedHeight(unsigned int lx, unsigned int ly) const
 {
@@ -183,6 +232,10 @@ RasterTileCache::SetSize(unsigned _width, unsigned _height,
                          unsigned _tile_width, unsigned _tile_height,
                          unsigned tile_columns, unsigned tile_rows)
 {
+  if (decoding)
+    /* see SetTile() */
+    return;
+
   width = _width;
   height = _height;
   tile_width = _tile_width;
@@ -199,6 +252,10 @@ void
 RasterTileCache::SetLatLonBounds(double _lon_min, double _lon_max,
                                  double _lat_min, double _lat_max)
 {
+  if (decoding)
+    /* see SetTile() */
+    return;
+
   const Angle lon_min(Angle::Degrees(_lon_min));
   const Angle lon_max(Angle::Degrees(_lon_max));
   const Angle lat_min(Angle::Degrees(_lat_min));
@@ -223,6 +280,8 @@ RasterTileCache::Reset()
 
   overview.Reset();
 
+  ClearTileStore();
+
   for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
     it->Disable();
 }
@@ -324,7 +383,7 @@ RasterTileCache::MarkerSegment(long file_offset, unsigned id)
 
 extern RasterTileCache *raster_tile_current;
 
-void
+bool
 RasterTileCache::LoadJPG2000(const char *jp2_filename)
 {
   jas_stream_t *in;
@@ -333,8 +392,11 @@ RasterTileCache::LoadJPG2000(const char *jp2_filename)
 
   in = jas_stream_fopen(jp2_filename, "rb");
   if (!in) {
-    Reset();
-    return;
+    if (!decoding)
+      Reset();
+    /* else: readers may be accessing the published tiles; leave
+       them alone */
+    return false;
   }
 
   if (operation != NULL)
@@ -342,6 +404,7 @@ RasterTileCache::LoadJPG2000(const char *jp2_filename)
 
   jp2_decode(in, scan_overview ? "xcsoar=2" : "xcsoar=1");
   jas_stream_close(in);
+  return true;
 }
 
 bool
@@ -429,15 +492,65 @@ RasterTileCache::LoadOverview(const char *path, const TCHAR *world_file,
   return initialised;
 }
 
+inline bool
+RasterTileCache::LoadStoredTile(unsigned index)
+{
+  assert(tile_store != nullptr);
+
+  uint32_t offset;
+  memcpy(&offset, tile_store + sizeof(TileStoreHeader)
+         + index * sizeof(offset), sizeof(offset));
+  if (offset == 0)
+    return false;
+
+  const RasterTile &tile = tiles.GetLinear(index);
+  const size_t size = tile.width * tile.height * sizeof(short);
+  if (offset > tile_store_size || size > tile_store_size - offset)
+    return false;
+
+  short *dest = GetTileBuffer(index);
+  if (dest == NULL)
+    return false;
+
+  memcpy(dest, tile_store + offset, size);
+  return true;
+}
+
+bool
+RasterTileCache::LoadStoredTiles()
+{
+  if (tile_store == nullptr)
+    return true;
+
+  bool missing = false;
+  for (auto it = request_tiles.begin(), end = request_tiles.end();
+       it != end; ++it) {
+    RasterTile &tile = tiles.GetLinear(*it);
+    if (!tile.IsRequested())
+      continue;
+
+    if (LoadStoredTile(*it))
+      tile.ClearRequest();
+    else
+      missing = true;
+  }
+
+  return missing;
+}
+
 void
 RasterTileCache::UpdateTiles(const char *path, int x, int y, unsigned radius)
 {
   if (!PollTiles(x, y, radius))
     return;
 
-  remaining_segments = 0;
+  /* serve as many tiles as possible from the tile store; only the
+     remaining ones need to be decoded */
+  if (LoadStoredTiles()) {
+    remaining_segments = 0;
 
-  LoadJPG2000(path);
+    LoadJPG2000(path);
+  }
 
   /* permanently disable the requested tiles which are still not
      loaded, to prevent trying to reload them over and over in a busy
@@ -452,6 +565,63 @@ RasterTileCache::UpdateTiles(const char *path, int x, int y, unsigned radius)
   ++serial;
 }
 
+bool
+RasterTileCache::PrepareTiles(int x, int y, unsigned radius,
+                              ConstBuffer<SignedRasterLocation> prefetch,
+                              unsigned prefetch_radius)
+{
+  assert(!decoding);
+  assert(n_pending_tiles == 0);
+
+  return PollTiles(x, y, radius, prefetch, prefetch_radius);
+}
+
+bool
+RasterTileCache::DecodeTiles(const char *path)
+{
+  assert(!decoding);
+  assert(n_pending_tiles == 0);
+
+  decoding = true;
+
+  bool success = true;
+  if (LoadStoredTiles()) {
+    remaining_segments = 0;
+
+    success = LoadJPG2000(path);
+  }
+
+  decoding = false;
+  return success;
+}
+
+void
+RasterTileCache::CommitTiles()
+{
+  assert(!decoding);
+
+  for (unsigned i = 0; i < n_pending_tiles; ++i) {
+    PendingTile &pending = pending_tiles[i];
+    tiles.GetLinear(pending.index).SwapBuffer(pending.buffer);
+
+    /* free the (usually empty) old tile buffer */
+    pending.buffer.Reset();
+  }
+
+  n_pending_tiles = 0;
+
+  /* permanently disable the requested tiles which are still not
+     loaded, see UpdateTiles() */
+  for (auto it = request_tiles.begin(), end = request_tiles.end();
+      it != end; ++it) {
+    RasterTile &tile = tiles.GetLinear(*it);
+    if (tile.IsRequested() && !tile.IsEnabled())
+      tile.Clear();
+  }
+
+  ++serial;
+}
+
 bool
 RasterTileCache::SaveCache(FILE *file) const
 {
@@ -558,3 +728,134 @@ RasterTileCache::LoadCache(FILE *file)
   scan_overview = false;
   return true;
 }
+
+bool
+RasterTileCache::SaveTileStore(const char *path, FILE *file,
+                               OperationEnvironment &env)
+{
+  if (!initialised)
+    return false;
+
+  assert(operation == NULL);
+
+  /**
+   * The number of tiles decoded at a time; this limits the amount of
+   * memory needed while writing the store.
+   */
+  constexpr unsigned BATCH_SIZE = MAX_ACTIVE_TILES > 32
+    ? 16
+    : MAX_ACTIVE_TILES / 2;
+
+  /**
+   * The maximum size of the tile store; this is the limit of
+   * FileMapping.
+   */
+  constexpr size_t MAX_STORE_SIZE = 1024 * 1024 * 1024;
+
+  const long base = ftell(file);
+  if (base < 0)
+    return false;
+
+  const unsigned n_tiles = tiles.GetSize();
+
+  TileStoreHeader header;
+  memset(&header, 0, sizeof(header));
+  header.version = TileStoreHeader::VERSION;
+  header.width = width;
+  header.height = height;
+  header.tile_width = tile_width;
+  header.tile_height = tile_height;
+  header.tile_columns = tiles.GetWidth();
+  header.tile_rows = tiles.GetHeight();
+
+  /* write a zeroed tile index first, it will be overwritten when all
+     offsets are known */
+  AllocatedArray<uint32_t> index(n_tiles);
+  std::fill(index.begin(), index.end(), 0);
+
+  if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+      fwrite(index.begin(), sizeof(*index.begin()), n_tiles,
+             file) != n_tiles)
+    return false;
+
+  size_t offset = sizeof(header) + n_tiles * sizeof(*index.begin());
+
+  for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
+    it->ClearRequest();
+
+  env.SetProgressRange(n_tiles);
+
+  bool success = true;
+  for (unsigned first = 0; first < n_tiles && success; first += BATCH_SIZE) {
+    const unsigned last = std::min(first + BATCH_SIZE, n_tiles);
+
+    bool any = false;
+    for (unsigned i = first; i < last; ++i) {
+      RasterTile &tile = tiles.GetLinear(i);
+      if (tile.IsDefined() && tile.IsDisabled()) {
+        tile.SetRequest();
+        any = true;
+      }
+    }
+
+    if (any) {
+      remaining_segments = 0;
+      LoadJPG2000(path);
+    }
+
+    for (unsigned i = first; i < last; ++i) {
+      RasterTile &tile = tiles.GetLinear(i);
+      if (!tile.IsRequested())
+        continue;
+
+      if (success && tile.IsEnabled()) {
+        const size_t n = tile.width * tile.height;
+        if (n * sizeof(short) > MAX_STORE_SIZE - offset ||
+            fwrite(tile.GetImageBuffer(), sizeof(short), n, file) != n)
+          success = false;
+        else {
+          index[i] = offset;
+          offset += n * sizeof(short);
+        }
+      }
+
+      tile.ClearRequest();
+      tile.Disable();
+    }
+
+    env.SetProgressPosition(last);
+  }
+
+  /* now write the real tile index */
+  return success &&
+    fseek(file, base + sizeof(header), SEEK_SET) == 0 &&
+    fwrite(index.begin(), sizeof(*index.begin()), n_tiles, file) == n_tiles;
+}
+
+bool
+RasterTileCache::SetTileStore(const void *data, size_t size)
+{
+  ClearTileStore();
+
+  if (!initialised)
+    return false;
+
+  const unsigned n_tiles = tiles.GetSize();
+
+  TileStoreHeader header;
+  if (size < sizeof(header))
+    return false;
+
+  memcpy(&header, data, sizeof(header));
+  if (header.version != TileStoreHeader::VERSION ||
+      header.width != width || header.height != height ||
+      header.tile_width != tile_width || header.tile_height != tile_height ||
+      header.tile_columns != tiles.GetWidth() ||
+      header.tile_rows != tiles.GetHeight() ||
+      size < sizeof(header) + n_tiles * sizeof(uint32_t))
+    return false;
+
+  tile_store = (const uint8_t *)data;
+  tile_store_size = size;
+  return true;
+}
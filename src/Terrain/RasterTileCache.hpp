@@ -30,6 +30,9 @@ Copyright_License {
 #include "Util/NonCopyable.hpp"
 #include "Util/StaticArray.hpp"
 #include "Util/Serial.hpp"
+#include "Util/ConstBuffer.hxx"
+
+#include <array>
 
 #include <assert.h>
 #include <tchar.h>
@@ -68,6 +71,14 @@ class RasterTileCache : private NonCopyable {
    */
   static constexpr unsigned OVERVIEW_BITS = 4;
 
+  /**
+   * Maximum number of tiles loaded at a time, to reduce system load
+   * peaks.
+   */
+  static constexpr unsigned MAX_ACTIVATE = MAX_ACTIVE_TILES > 32
+    ? 16
+    : MAX_ACTIVE_TILES / 2;
+
   /**
    * Target number of steps in intersection searches; total distance
    * is shifted by this number of bits
@@ -129,6 +140,21 @@ protected:
     GeoBounds bounds;
   };
 
+  /**
+   * The header of a tile store file written by SaveTileStore().  It
+   * is followed by one uint32_t per tile (the offset of the tile's
+   * raw height data within the store, or 0 if the tile is not
+   * available), followed by the tile data.
+   */
+  struct TileStoreHeader {
+    static constexpr unsigned VERSION = 0x1;
+
+    unsigned version;
+    unsigned width, height;
+    unsigned short tile_width, tile_height;
+    unsigned tile_columns, tile_rows;
+  };
+
   bool initialised;
 
   /** is the "bounds" attribute valid? */
@@ -166,13 +192,40 @@ protected:
    */
   StaticArray<uint16_t, MAX_RTC_TILES> request_tiles;
 
+  /**
+   * A tile which is being decoded asynchronously by DecodeTiles().
+   * The buffer is moved to the tile by CommitTiles().
+   */
+  struct PendingTile {
+    unsigned index;
+    RasterBuffer buffer;
+  };
+
+  std::array<PendingTile, MAX_ACTIVATE> pending_tiles;
+  unsigned n_pending_tiles;
+
+  /**
+   * Is DecodeTiles() currently running?  If yes, then decoded tiles
+   * are written to #pending_tiles instead of the tile buffers.
+   */
+  bool decoding;
+
   /**
    * Progress callbacks for loading the file during startup.
    */
   OperationEnvironment *operation;
 
+  /**
+   * The pre-decoded tile store (usually memory-mapped), or nullptr.
+   * If available, requested tiles are copied from here instead of
+   * being decoded from the JPEG2000 file.  This object does not own
+   * the memory.
+   */
+  const uint8_t *tile_store;
+  size_t tile_store_size;
+
 public:
-  RasterTileCache():operation(NULL) {
+  RasterTileCache():n_pending_tiles(0), decoding(false), operation(NULL) {
     Reset();
   }
 
@@ -202,6 +255,20 @@ public:
   short GetInterpolatedHeight(unsigned int lx,
                               unsigned int ly) const;
 
+  /**
+   * Batch version of GetHeight(): determine the non-interpolated
+   * heights of many pixel locations in one pass.  Consecutive
+   * locations within the same tile share one tile lookup, so this is
+   * fastest when the locations are spatially ordered (e.g. along a
+   * polyline).
+   *
+   * @param locations the pixel locations; may be out of range
+   * @param heights the destination array, with one element per
+   * location
+   */
+  void GetHeights(ConstBuffer<RasterLocation> locations,
+                  short *heights) const;
+
   /**
    * Scan a straight line and fill the buffer with the specified
    * number of samples along the line.
@@ -227,7 +294,10 @@ public:
                int h_origin, const int slope_fact) const;
 
 protected:
-  void LoadJPG2000(const char *path);
+  /**
+   * @return false if the file could not be opened
+   */
+  bool LoadJPG2000(const char *path);
 
   /**
    * Load a world file (*.tfw or *.j2w).
@@ -253,8 +323,69 @@ public:
   bool SaveCache(FILE *file) const;
   bool LoadCache(FILE *file);
 
+  /**
+   * Decode all tiles from the JPEG2000 file and write them to a tile
+   * store file, which can later be passed to SetTileStore().  This
+   * must be called right after loading, before any tiles have been
+   * activated.
+   */
+  bool SaveTileStore(const char *path, FILE *file,
+                     OperationEnvironment &operation);
+
+  /**
+   * Use the specified tile store (previously written by
+   * SaveTileStore()) to activate tiles.  The memory must remain valid
+   * until ClearTileStore() or Reset() is called.
+   *
+   * @return false if the tile store is malformed or does not match
+   * the loaded map
+   */
+  bool SetTileStore(const void *data, size_t size);
+
+  void ClearTileStore() {
+    tile_store = nullptr;
+    tile_store_size = 0;
+  }
+
+  bool HasTileStore() const {
+    return tile_store != nullptr;
+  }
+
   void UpdateTiles(const char *path, int x, int y, unsigned radius);
 
+  /**
+   * The first step of asynchronous tile loading (the alternative to
+   * UpdateTiles()): determine which tiles need to be loaded, and
+   * discard tiles which are too far away.  The caller must have
+   * exclusive access to this object.
+   *
+   * @param prefetch additional locations where tiles shall be loaded
+   * in advance (e.g. along the projected flight track); these are
+   * ranked behind the tiles around the view center
+   * @param prefetch_radius the radius around the prefetch locations
+   * @return true if DecodeTiles() and CommitTiles() need to be called
+   */
+  bool PrepareTiles(int x, int y, unsigned radius,
+                    ConstBuffer<SignedRasterLocation> prefetch,
+                    unsigned prefetch_radius);
+
+  /**
+   * The second step: decode the tiles selected by PrepareTiles() into
+   * private buffers.  This does not modify any state which is visible
+   * to readers, therefore it may run concurrently with them.  It must
+   * not run concurrently with any other non-const method.
+   *
+   * @return false if the file could not be opened; the tiles which
+   * have already been published remain usable
+   */
+  bool DecodeTiles(const char *path);
+
+  /**
+   * The third step: publish the tiles decoded by DecodeTiles().  The
+   * caller must have exclusive access to this object.
+   */
+  void CommitTiles();
+
   /**
    * Determines if there are still tiles scheduled to be loaded.  Call
    * this after UpdateTiles() to determine if UpdateTiles() should be
@@ -291,8 +422,6 @@ public:
   long SkipMarkerSegment(long file_offset) const;
   void MarkerSegment(long file_offset, unsigned id);
 
-  bool TileRequest(unsigned index);
-
   short *GetOverview() {
     return overview.GetData();
   }
@@ -306,11 +435,41 @@ public:
   void SetTile(unsigned index, int xstart, int ystart, int xend, int yend);
 
   void SetInitialised(bool val) {
+    if (decoding)
+      /* see SetTile() */
+      return;
+
     initialised = val;
   }
 
 protected:
-  bool PollTiles(int x, int y, unsigned radius);
+  bool PollTiles(int x, int y, unsigned radius,
+                 ConstBuffer<SignedRasterLocation> prefetch=nullptr,
+                 unsigned prefetch_radius=0);
+
+private:
+  /**
+   * Returns the buffer which receives the decoded data of the
+   * specified tile; this is either the tile's own buffer or (during
+   * DecodeTiles()) a new #PendingTile.
+   */
+  short *GetTileBuffer(unsigned index);
+
+  /**
+   * Copy one tile from the tile store into its buffer.
+   *
+   * @return false if the tile is not available in the tile store
+   */
+  bool LoadStoredTile(unsigned index);
+
+  /**
+   * Activate all requested tiles which are available in the tile
+   * store.
+   *
+   * @return true if there are requested tiles left which need to be
+   * decoded from the JPEG2000 file
+   */
+  bool LoadStoredTiles();
 
 public:
   short GetMaxElevation() const {
@@ -0,0 +1,178 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_SLOPE_SHADING_HPP
+#define XCSOAR_TERRAIN_SLOPE_SHADING_HPP
+
+#include "Terrain/RasterBuffer.hpp"
+#include "Util/Clamp.hpp"
+#include "Compiler.h"
+
+#ifdef FIXED_MATH
+#include "Math/FastMath.h"
+#else
+#include <math.h>
+#endif
+
+#include <algorithm>
+
+#include <stdint.h>
+
+/**
+ * Illumination value returned by the slope shading kernels when one
+ * of the neighbours is a "special" terrain value (water or invalid).
+ * The caller shall not apply slope shading to this pixel.
+ */
+static constexpr int SLOPE_SHADING_SPECIAL = -128;
+
+/**
+ * Parameters for the slope shading kernels which are constant for
+ * the whole image.
+ */
+struct SlopeShadingParameters {
+  /**
+   * The light source vector, scaled to 255.
+   */
+  int sx, sy, sz;
+
+  int contrast;
+
+  unsigned height_slope_factor;
+};
+
+/**
+ * Clip the difference between two adjacent terrain height values to
+ * sane bounds.  This works around integer overflows in the
+ * slope formula when the map file is broken, avoiding the sqrt() call
+ * with a negative argument.
+ */
+gcc_const
+static inline int
+ClipHeightDelta(int d)
+{
+  return Clamp(d, -512, 512);
+}
+
+/**
+ * Calculate the illumination of one pixel.
+ *
+ * @param p20 the horizontal distance between #h_left and #h_right
+ * @param p31 the vertical distance between #h_above and #h_below
+ * @return the illumination in the range -63..63 or
+ * #SLOPE_SHADING_SPECIAL
+ */
+gcc_pure
+static inline int
+CalculateSlopeShading(const SlopeShadingParameters &params,
+                      int h_above, int h_below, int h_left, int h_right,
+                      unsigned p20, unsigned p31)
+{
+  if (gcc_unlikely(RasterBuffer::IsSpecial(h_above) ||
+                   RasterBuffer::IsSpecial(h_below) ||
+                   RasterBuffer::IsSpecial(h_left) ||
+                   RasterBuffer::IsSpecial(h_right)))
+    /* some "special" terrain value surrounding us (water or
+       invalid), skip slope calculation */
+    return SLOPE_SHADING_SPECIAL;
+
+  const int p32 = ClipHeightDelta(h_above - h_below);
+  const int p22 = ClipHeightDelta(h_right - h_left);
+
+  const int dd0 = p22 * int(p31);
+  const int dd1 = int(p20) * p32;
+  const unsigned dd2 = p20 * p31 * params.height_slope_factor;
+  const int num = (int(dd2) * params.sz + dd0 * params.sx + dd1 * params.sy);
+  const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
+#ifdef FIXED_MATH
+  const unsigned mag = isqrt4(square_mag);
+#else
+  const unsigned mag = (unsigned)sqrt((double)square_mag);
+#endif
+  /* this is a workaround for a SIGFPE (division by zero)
+     observed by our users on some Android devices (e.g. Nexus
+     7), even though we did our best to make sure that the
+     integer arithmetics above can't overflow */
+  /* TODO: debug this problem and replace this workaround */
+  const int sval = num / int(mag|1);
+  const int sindex = (sval - params.sz) * params.contrast / 128;
+  return Clamp(sindex, -63, 63);
+}
+
+/**
+ * Portable implementation of the row kernels used by
+ * #RasterRenderer.  See SlopeShadingSSE2.hpp and SlopeShadingNEON.hpp
+ * for optimised versions which produce the exact same output.
+ */
+class PortableSlopeShading {
+protected:
+  SlopeShadingParameters params;
+
+public:
+  explicit constexpr PortableSlopeShading(const SlopeShadingParameters &_params)
+    :params(_params) {}
+
+  /**
+   * Calculate the illumination of #n pixels whose neighbours are
+   * #column_offset elements to the left and to the right.
+   *
+   * @param dest the destination buffer for the values returned by
+   * CalculateSlopeShading()
+   * @param src the first source pixel in the height matrix
+   * @param row_minus_offset the distance to the neighbour above in
+   * elements
+   * @param row_plus_offset the distance to the neighbour below in
+   * elements
+   */
+  void ShadeRow(int8_t *gcc_restrict dest, const short *gcc_restrict src,
+                unsigned n,
+                unsigned row_minus_offset, unsigned row_plus_offset,
+                unsigned column_offset, unsigned p31) const {
+    const unsigned p20 = 2 * column_offset;
+
+    for (unsigned i = 0; i < n; ++i, ++src)
+      dest[i] = CalculateSlopeShading(params,
+                                      src[-(int)row_minus_offset],
+                                      src[row_plus_offset],
+                                      src[-(int)column_offset],
+                                      src[column_offset],
+                                      p20, p31);
+  }
+
+  /**
+   * Calculate the color table index and the contour interval of #n
+   * pixels.  Both values are zero for negative and "special" heights.
+   */
+  static void ClassifyRow(uint8_t *gcc_restrict height_index,
+                          uint8_t *gcc_restrict contour,
+                          const short *gcc_restrict src, unsigned n,
+                          unsigned height_scale,
+                          unsigned contour_height_scale) {
+    for (unsigned i = 0; i < n; ++i) {
+      const int h = std::max(0, int(src[i]));
+      height_index[i] = std::min(254, h >> height_scale);
+      contour[i] = std::min(254, h >> contour_height_scale);
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,185 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_SLOPE_SHADING_NEON_HPP
+#define XCSOAR_TERRAIN_SLOPE_SHADING_NEON_HPP
+
+#include "SlopeShading.hpp"
+
+#ifndef __ARM_NEON__
+#error ARM NEON required
+#endif
+
+#ifdef FIXED_MATH
+#error NEONSlopeShading requires floating point sqrt()
+#endif
+
+#include <arm_neon.h>
+
+#include <assert.h>
+
+/**
+ * Implementation of the #RasterRenderer row kernels using ARM NEON
+ * instructions.  Processes 8 pixels at a time.
+ *
+ * ARMv7 NEON has no double precision arithmetic, therefore sqrt() and
+ * the division are done with scalar VFP instructions to remain
+ * bit-exact with #PortableSlopeShading; everything else is
+ * vectorised.
+ */
+class NEONSlopeShading {
+  SlopeShadingParameters params;
+
+public:
+  explicit constexpr NEONSlopeShading(const SlopeShadingParameters &_params)
+    :params(_params) {}
+
+private:
+  /**
+   * Vectorised version of ClipHeightDelta(a - b).  The saturating
+   * subtraction preserves the sign, so clipping it yields the same
+   * result.
+   */
+  gcc_always_inline
+  static int16x8_t HeightDelta(int16x8_t a, int16x8_t b) {
+    return vminq_s16(vmaxq_s16(vqsubq_s16(a, b), vdupq_n_s16(-512)),
+                     vdupq_n_s16(512));
+  }
+
+  /**
+   * Returns a mask of all lanes which contain a "special" terrain
+   * value.
+   */
+  gcc_always_inline
+  static uint16x8_t SpecialMask(int16x8_t h) {
+    return vcleq_s16(h, vdupq_n_s16(RasterBuffer::TERRAIN_WATER_THRESHOLD));
+  }
+
+  /**
+   * Calculate (sval - sz) * contrast / 128, rounding towards zero.
+   */
+  gcc_always_inline
+  int32x4_t Index4(int32x4_t sval) const {
+    const int32x4_t t = vmulq_n_s32(vsubq_s32(sval, vdupq_n_s32(params.sz)),
+                                    params.contrast);
+    const uint32x4_t bias =
+      vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(t, 31)), 25);
+    return vshrq_n_s32(vaddq_s32(t, vreinterpretq_s32_u32(bias)), 7);
+  }
+
+public:
+  gcc_flatten
+  void ShadeRow(int8_t *gcc_restrict dest, const short *gcc_restrict src,
+                unsigned n,
+                unsigned row_minus_offset, unsigned row_plus_offset,
+                unsigned column_offset, unsigned p31) const {
+    const unsigned p20 = 2 * column_offset;
+
+    /* these bounds guarantee that dd0 and dd1 fit into 16 bits */
+    assert(p20 <= 50);
+    assert(p31 <= 50);
+
+    const unsigned dd2 = p20 * p31 * params.height_slope_factor;
+    assert(dd2 <= 32768);
+
+    const int32x4_t num_base = vdupq_n_s32(int(dd2) * params.sz);
+    const unsigned dd2_square = dd2 * dd2;
+
+    for (unsigned i = 0; i < n / 8; ++i, src += 8, dest += 8) {
+      const int16x8_t above = vld1q_s16(src - row_minus_offset);
+      const int16x8_t below = vld1q_s16(src + row_plus_offset);
+      const int16x8_t left = vld1q_s16(src - column_offset);
+      const int16x8_t right = vld1q_s16(src + column_offset);
+
+      const int16x8_t p32 = HeightDelta(above, below);
+      const int16x8_t p22 = HeightDelta(right, left);
+
+      const int16x8_t dd0 = vmulq_n_s16(p22, p31);
+      const int16x8_t dd1 = vmulq_n_s16(p32, p20);
+
+      const int16x4_t dd0_lo = vget_low_s16(dd0), dd0_hi = vget_high_s16(dd0);
+      const int16x4_t dd1_lo = vget_low_s16(dd1), dd1_hi = vget_high_s16(dd1);
+
+      int32_t num[8], partial_square_mag[8], sval[8];
+      vst1q_s32(num,
+                vmlal_n_s16(vmlal_n_s16(num_base, dd0_lo, params.sx),
+                            dd1_lo, params.sy));
+      vst1q_s32(num + 4,
+                vmlal_n_s16(vmlal_n_s16(num_base, dd0_hi, params.sx),
+                            dd1_hi, params.sy));
+      vst1q_s32(partial_square_mag,
+                vmlal_s16(vmull_s16(dd0_lo, dd0_lo), dd1_lo, dd1_lo));
+      vst1q_s32(partial_square_mag + 4,
+                vmlal_s16(vmull_s16(dd0_hi, dd0_hi), dd1_hi, dd1_hi));
+
+      for (unsigned j = 0; j < 8; ++j) {
+        const unsigned square_mag = unsigned(partial_square_mag[j])
+          + dd2_square;
+        const unsigned mag = (unsigned)sqrt((double)square_mag);
+        sval[j] = num[j] / int(mag|1);
+      }
+
+      const int16x8_t sindex =
+        vcombine_s16(vqmovn_s32(Index4(vld1q_s32(sval))),
+                     vqmovn_s32(Index4(vld1q_s32(sval + 4))));
+      const int16x8_t clipped =
+        vminq_s16(vmaxq_s16(sindex, vdupq_n_s16(-63)), vdupq_n_s16(63));
+
+      const uint16x8_t special =
+        vorrq_u16(vorrq_u16(SpecialMask(above), SpecialMask(below)),
+                  vorrq_u16(SpecialMask(left), SpecialMask(right)));
+      const int16x8_t result =
+        vbslq_s16(special, vdupq_n_s16(SLOPE_SHADING_SPECIAL), clipped);
+
+      vst1_s8(dest, vqmovn_s16(result));
+    }
+  }
+
+  gcc_flatten
+  static void ClassifyRow(uint8_t *gcc_restrict height_index,
+                          uint8_t *gcc_restrict contour,
+                          const short *gcc_restrict src, unsigned n,
+                          unsigned height_scale,
+                          unsigned contour_height_scale) {
+    /* a negative shift count shifts to the right */
+    const int16x8_t v_height_scale = vdupq_n_s16(-int(height_scale));
+    const int16x8_t v_contour_height_scale =
+      vdupq_n_s16(-int(contour_height_scale));
+    const int16x8_t zero = vdupq_n_s16(0);
+    const int16x8_t limit = vdupq_n_s16(254);
+
+    for (unsigned i = 0; i < n / 8; ++i, src += 8,
+           height_index += 8, contour += 8) {
+      const int16x8_t h = vmaxq_s16(vld1q_s16(src), zero);
+
+      const int16x8_t hi = vminq_s16(vshlq_s16(h, v_height_scale), limit);
+      const int16x8_t ci = vminq_s16(vshlq_s16(h, v_contour_height_scale),
+                                     limit);
+
+      vst1_u8(height_index, vqmovun_s16(hi));
+      vst1_u8(contour, vqmovun_s16(ci));
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,227 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_SLOPE_SHADING_SSE2_HPP
+#define XCSOAR_TERRAIN_SLOPE_SHADING_SSE2_HPP
+
+#include "SlopeShading.hpp"
+
+#ifndef __SSE2__
+#error SSE2 required
+#endif
+
+#ifdef FIXED_MATH
+#error SSE2SlopeShading requires floating point sqrt()
+#endif
+
+#include <emmintrin.h>
+
+#include <assert.h>
+
+/**
+ * Implementation of the #RasterRenderer row kernels using SSE2
+ * instructions.  Processes 8 pixels at a time.
+ *
+ * The result is bit-exact with #PortableSlopeShading: all
+ * intermediate values fit into 16 or 32 bit integers (see the bounds
+ * in RasterRenderer::GenerateSlopeImage()), and sqrt() and the
+ * division are done in double precision, which is exact for 32 bit
+ * integer operands.
+ */
+class SSE2SlopeShading {
+  /**
+   * Pairs of (sx, sy) in each 32 bit lane, for _mm_madd_epi16().
+   */
+  __m128i light;
+
+  /**
+   * The contrast in the lower half of each 32 bit lane.
+   */
+  __m128i contrast;
+
+  __m128i sz;
+
+  int sz_value;
+  unsigned height_slope_factor;
+
+public:
+  explicit SSE2SlopeShading(const SlopeShadingParameters &params)
+    :light(_mm_unpacklo_epi16(_mm_set1_epi16(params.sx),
+                              _mm_set1_epi16(params.sy))),
+     contrast(_mm_unpacklo_epi16(_mm_set1_epi16(params.contrast),
+                                 _mm_setzero_si128())),
+     sz(_mm_set1_epi32(params.sz)),
+     sz_value(params.sz),
+     height_slope_factor(params.height_slope_factor) {}
+
+private:
+  gcc_always_inline
+  static __m128i Load8(const short *p) {
+    return _mm_loadu_si128((const __m128i *)p);
+  }
+
+  /**
+   * Vectorised version of ClipHeightDelta(a - b).  The saturating
+   * subtraction preserves the sign, so clipping it yields the same
+   * result.
+   */
+  gcc_always_inline
+  static __m128i HeightDelta(__m128i a, __m128i b) {
+    return _mm_min_epi16(_mm_max_epi16(_mm_subs_epi16(a, b),
+                                       _mm_set1_epi16(-512)),
+                         _mm_set1_epi16(512));
+  }
+
+  /**
+   * Returns a mask of all lanes which contain a "special" terrain
+   * value.
+   */
+  gcc_always_inline
+  static __m128i SpecialMask(__m128i h) {
+    return _mm_cmplt_epi16(h,
+                           _mm_set1_epi16(RasterBuffer::TERRAIN_WATER_THRESHOLD + 1));
+  }
+
+  /**
+   * Calculate num / (sqrt(square_mag) | 1) in the lower two 32 bit
+   * lanes.
+   */
+  gcc_always_inline
+  static __m128i Divide2(__m128i num, __m128i partial_square_mag,
+                         __m128d dd2_square) {
+    const __m128d square_mag =
+      _mm_add_pd(_mm_cvtepi32_pd(partial_square_mag), dd2_square);
+    const __m128i mag = _mm_or_si128(_mm_cvttpd_epi32(_mm_sqrt_pd(square_mag)),
+                                     _mm_set1_epi32(1));
+    return _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(num),
+                                       _mm_cvtepi32_pd(mag)));
+  }
+
+  gcc_always_inline
+  static __m128i Divide4(__m128i num, __m128i partial_square_mag,
+                         __m128d dd2_square) {
+    const __m128i lo = Divide2(num, partial_square_mag, dd2_square);
+    const __m128i hi = Divide2(_mm_srli_si128(num, 8),
+                               _mm_srli_si128(partial_square_mag, 8),
+                               dd2_square);
+    return _mm_unpacklo_epi64(lo, hi);
+  }
+
+  /**
+   * Calculate (sval - sz) * contrast / 128, rounding towards zero.
+   */
+  gcc_always_inline
+  __m128i Index4(__m128i sval) const {
+    const __m128i t = _mm_madd_epi16(_mm_sub_epi32(sval, sz), contrast);
+    const __m128i bias = _mm_srli_epi32(_mm_srai_epi32(t, 31), 25);
+    return _mm_srai_epi32(_mm_add_epi32(t, bias), 7);
+  }
+
+public:
+  gcc_flatten
+  void ShadeRow(int8_t *gcc_restrict dest, const short *gcc_restrict src,
+                unsigned n,
+                unsigned row_minus_offset, unsigned row_plus_offset,
+                unsigned column_offset, unsigned p31) const {
+    const unsigned p20 = 2 * column_offset;
+
+    /* these bounds guarantee that dd0 and dd1 fit into 16 bits */
+    assert(p20 <= 50);
+    assert(p31 <= 50);
+
+    const unsigned dd2 = p20 * p31 * height_slope_factor;
+    assert(dd2 <= 32768);
+
+    const __m128i v_p20 = _mm_set1_epi16(p20);
+    const __m128i v_p31 = _mm_set1_epi16(p31);
+    const __m128i num_base = _mm_set1_epi32(int(dd2) * sz_value);
+    const __m128d dd2_square = _mm_set1_pd(double(dd2 * dd2));
+
+    for (unsigned i = 0; i < n / 8; ++i, src += 8, dest += 8) {
+      const __m128i above = Load8(src - row_minus_offset);
+      const __m128i below = Load8(src + row_plus_offset);
+      const __m128i left = Load8(src - column_offset);
+      const __m128i right = Load8(src + column_offset);
+
+      const __m128i p32 = HeightDelta(above, below);
+      const __m128i p22 = HeightDelta(right, left);
+
+      const __m128i dd0 = _mm_mullo_epi16(p22, v_p31);
+      const __m128i dd1 = _mm_mullo_epi16(p32, v_p20);
+
+      const __m128i dd_lo = _mm_unpacklo_epi16(dd0, dd1);
+      const __m128i dd_hi = _mm_unpackhi_epi16(dd0, dd1);
+
+      const __m128i num_lo = _mm_add_epi32(num_base,
+                                           _mm_madd_epi16(dd_lo, light));
+      const __m128i num_hi = _mm_add_epi32(num_base,
+                                           _mm_madd_epi16(dd_hi, light));
+
+      const __m128i sindex_lo =
+        Index4(Divide4(num_lo, _mm_madd_epi16(dd_lo, dd_lo), dd2_square));
+      const __m128i sindex_hi =
+        Index4(Divide4(num_hi, _mm_madd_epi16(dd_hi, dd_hi), dd2_square));
+
+      __m128i sindex = _mm_packs_epi32(sindex_lo, sindex_hi);
+      sindex = _mm_min_epi16(_mm_max_epi16(sindex, _mm_set1_epi16(-63)),
+                             _mm_set1_epi16(63));
+
+      const __m128i special =
+        _mm_or_si128(_mm_or_si128(SpecialMask(above), SpecialMask(below)),
+                     _mm_or_si128(SpecialMask(left), SpecialMask(right)));
+      sindex = _mm_or_si128(_mm_andnot_si128(special, sindex),
+                            _mm_and_si128(special,
+                                          _mm_set1_epi16(SLOPE_SHADING_SPECIAL)));
+
+      _mm_storel_epi64((__m128i *)dest, _mm_packs_epi16(sindex, sindex));
+    }
+  }
+
+  gcc_flatten
+  static void ClassifyRow(uint8_t *gcc_restrict height_index,
+                          uint8_t *gcc_restrict contour,
+                          const short *gcc_restrict src, unsigned n,
+                          unsigned height_scale,
+                          unsigned contour_height_scale) {
+    const __m128i v_height_scale = _mm_cvtsi32_si128(height_scale);
+    const __m128i v_contour_height_scale =
+      _mm_cvtsi32_si128(contour_height_scale);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i limit = _mm_set1_epi16(254);
+
+    for (unsigned i = 0; i < n / 8; ++i, src += 8,
+           height_index += 8, contour += 8) {
+      const __m128i h = _mm_max_epi16(Load8(src), zero);
+
+      const __m128i hi = _mm_min_epi16(_mm_sra_epi16(h, v_height_scale),
+                                       limit);
+      const __m128i ci = _mm_min_epi16(_mm_sra_epi16(h, v_contour_height_scale),
+                                       limit);
+
+      _mm_storel_epi64((__m128i *)height_index, _mm_packus_epi16(hi, hi));
+      _mm_storel_epi64((__m128i *)contour, _mm_packus_epi16(ci, ci));
+    }
+  }
+};
+
+#endif
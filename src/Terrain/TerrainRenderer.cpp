@@ -368,11 +368,18 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
     return;
 
 #else
-  if (compare_projection.Compare(map_projection) &&
-      terrain_serial == terrain.GetSerial() &&
-      sunazimuth.CompareRoughly(last_sun_azimuth))
-    /* no change since previous frame */
-    return;
+  if (terrain_serial == terrain.GetSerial() &&
+      sunazimuth.CompareRoughly(last_sun_azimuth)) {
+    if (compare_projection.Compare(map_projection))
+      /* no change since previous frame */
+      return;
+
+    if (compare_projection.IsDefined() && ScrollImage(map_projection)) {
+      /* the map was panned: only the exposed strips were rendered */
+      compare_projection = CompareProjection(map_projection);
+      return;
+    }
+  }
 
   compare_projection = CompareProjection(map_projection);
 #endif
@@ -384,11 +391,6 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
   const bool do_water = true;
   const unsigned height_scale = 4;
   const int interp_levels = 2;
-  const bool is_terrain = true;
-  const bool do_shading = is_terrain &&
-                          settings.slope_shading != SlopeShading::OFF;
-  const bool do_contour = is_terrain &&
-                          settings.contours != Contours::OFF;
 
   const ColorRamp *const color_ramp = &terrain_colors[settings.ramp][0];
   if (color_ramp != last_color_ramp) {
@@ -402,12 +404,42 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
     raster_renderer.ScanMap(map, map_projection);
   }
 
+  GenerateImage(sunazimuth);
+}
+
+void
+TerrainRenderer::GenerateImage(const Angle sunazimuth)
+{
+  const unsigned height_scale = 4;
+  const bool is_terrain = true;
+  const bool do_shading = is_terrain &&
+                          settings.slope_shading != SlopeShading::OFF;
+  const bool do_contour = is_terrain &&
+                          settings.contours != Contours::OFF;
+
   raster_renderer.GenerateImage(do_shading, height_scale,
                                 settings.contrast, settings.brightness,
                                 sunazimuth,
                                 do_contour);
 }
 
+#ifndef ENABLE_OPENGL
+
+bool
+TerrainRenderer::ScrollImage(const WindowProjection &map_projection)
+{
+  {
+    RasterTerrain::Lease map(terrain);
+    if (!raster_renderer.ScrollMap(map, map_projection))
+      return false;
+  }
+
+  GenerateImage(last_sun_azimuth);
+  return true;
+}
+
+#endif
+
 /**
  * Draws the terrain to the given canvas
  * @param canvas The drawing canvas
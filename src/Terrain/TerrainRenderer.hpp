@@ -64,9 +64,8 @@ public:
    * Flush the cache.
    */
   void Flush() {
-#ifdef ENABLE_OPENGL
     raster_renderer.Invalidate();
-#else
+#ifndef ENABLE_OPENGL
     compare_projection.Clear();
 #endif
   }
@@ -74,6 +73,22 @@ public:
 protected:
   void CopyTo(Canvas &canvas, unsigned width, unsigned height) const;
 
+  /**
+   * Convert the #RasterRenderer's height matrix to the image, using
+   * the current settings.
+   */
+  void GenerateImage(const Angle sunazimuth);
+
+#ifndef ENABLE_OPENGL
+  /**
+   * Attempt to scroll the previous image after the map was panned,
+   * instead of regenerating it completely.
+   *
+   * @return false if the projection change was not a simple pan
+   */
+  bool ScrollImage(const WindowProjection &map_projection);
+#endif
+
 public:
   const TerrainRendererSettings &GetSettings() const {
     return settings;
@@ -0,0 +1,97 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread.hpp"
+#include "RasterTerrain.hpp"
+
+TerrainThread::TerrainThread(RasterTerrain &_terrain,
+                             std::function<void()> &&_callback)
+  :StandbyThread("Terrain"),
+   terrain(_terrain),
+   callback(_callback),
+   next_location(GeoPoint::Invalid()),
+   last_location(GeoPoint::Invalid()),
+   last_radius(fixed(0)) {}
+
+TerrainThread::~TerrainThread()
+{
+}
+
+void
+TerrainThread::Trigger(const GeoPoint &location, fixed radius,
+                       ConstBuffer<GeoPoint> prefetch, fixed prefetch_radius)
+{
+  assert(location.IsValid());
+
+  if (last_radius >= radius && last_location.IsValid() &&
+      last_location.DistanceS(location) < fixed(1000))
+    /* the tiles are still fresh */
+    return;
+
+  last_location = location;
+  last_radius = radius;
+
+  {
+    const ScopeLock protect(mutex);
+    next_location = location;
+    next_radius = radius;
+
+    next_prefetch.clear();
+    for (const GeoPoint &p : prefetch)
+      if (!next_prefetch.full())
+        next_prefetch.append(p);
+
+    next_prefetch_radius = prefetch_radius;
+
+    StandbyThread::Trigger();
+  }
+}
+
+void
+TerrainThread::Tick()
+{
+  // TODO: call only once
+  SetLowPriority();
+
+  bool again = true;
+  while (next_location.IsValid() && again && !IsStopped()) {
+    const GeoPoint location = next_location;
+    const fixed radius = next_radius;
+    const StaticArray<GeoPoint, MAX_PREFETCH> prefetch = next_prefetch;
+    const fixed prefetch_radius = next_prefetch_radius;
+
+    mutex.Unlock();
+    again = terrain.UpdateTiles(location, radius,
+                                ConstBuffer<GeoPoint>(prefetch.begin(),
+                                                      prefetch.size()),
+                                prefetch_radius);
+    mutex.Lock();
+  }
+
+  /* notify the client that we have loaded new tiles */
+  if (callback) {
+    mutex.Unlock();
+    callback();
+    mutex.Lock();
+  }
+}
@@ -0,0 +1,84 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_THREAD_HPP
+#define XCSOAR_TERRAIN_THREAD_HPP
+
+#include "Thread/StandbyThread.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Util/StaticArray.hpp"
+#include "Util/ConstBuffer.hxx"
+
+#include <functional>
+
+class RasterTerrain;
+
+/**
+ * A thread that loads terrain tiles asynchronously.  Tiles are
+ * decoded without holding the terrain's exclusive lock, see
+ * RasterTerrain::UpdateTiles().
+ */
+class TerrainThread final : private StandbyThread {
+public:
+  /**
+   * The maximum number of prefetch locations.
+   */
+  static constexpr unsigned MAX_PREFETCH = 4;
+
+private:
+  RasterTerrain &terrain;
+
+  const std::function<void()> callback;
+
+  GeoPoint next_location;
+  fixed next_radius;
+  StaticArray<GeoPoint, MAX_PREFETCH> next_prefetch;
+  fixed next_prefetch_radius;
+
+  GeoPoint last_location;
+  fixed last_radius;
+
+public:
+  TerrainThread(RasterTerrain &_terrain, std::function<void()> &&_callback);
+  ~TerrainThread();
+
+  using StandbyThread::LockStop;
+
+  /**
+   * Request loading the tiles around the specified location.
+   *
+   * @param prefetch additional locations where tiles shall be loaded
+   * in advance, e.g. the projected flight track and the next task
+   * leg
+   * @param prefetch_radius the radius around each prefetch location
+   * [m]
+   */
+  void Trigger(const GeoPoint &location, fixed radius,
+               ConstBuffer<GeoPoint> prefetch, fixed prefetch_radius);
+
+private:
+  /* virtual methods from class StandbyThread*/
+  void Tick() override;
+};
+
+#endif
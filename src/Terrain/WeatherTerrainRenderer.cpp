@@ -204,4 +204,10 @@ WeatherTerrainRenderer::Generate(const WindowProjection &projection,
   raster_renderer.GenerateImage(do_shading, height_scale,
                                 settings.contrast, settings.brightness,
                                 sunazimuth, false);
+
+#ifndef ENABLE_OPENGL
+  /* the height matrix does not contain terrain now; don't let
+     TerrainRenderer::Generate() reuse or scroll it */
+  compare_projection.Clear();
+#endif
 }
@@ -0,0 +1,119 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_SNAPSHOT_BUFFER_HPP
+#define XCSOAR_THREAD_SNAPSHOT_BUFFER_HPP
+
+#include "Compiler.h"
+
+#include <atomic>
+#include <type_traits>
+
+/**
+ * Publishes copies of a (large) object from one thread to any number
+ * of reader threads without a mutex.  It is a sequence lock with two
+ * slots: the writer always fills the slot which does not contain the
+ * latest snapshot, so a reader only needs to retry if the writer has
+ * started two new publications while it was copying.
+ *
+ * Writers never wait for readers.  Calls to Publish() must be
+ * serialised by the caller (e.g. by the mutex which protects the
+ * source object).
+ */
+template<typename T>
+class SnapshotBuffer {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "a torn copy must be harmless");
+
+  /**
+   * Bit 0 is set while a publication is in progress; the remaining
+   * bits count the finished publications, and their lowest bit
+   * selects the slot containing the latest snapshot.
+   */
+  std::atomic<unsigned> sequence;
+
+  /**
+   * The number of times Read() had to retry; for diagnostics only.
+   */
+  mutable std::atomic<unsigned> retries;
+
+  T slots[2];
+
+public:
+  /**
+   * The initial snapshot is undefined; call Publish() before the
+   * first Read().
+   */
+  SnapshotBuffer():sequence(0), retries(0) {}
+
+  SnapshotBuffer(const SnapshotBuffer &) = delete;
+  SnapshotBuffer &operator=(const SnapshotBuffer &) = delete;
+
+  /**
+   * Publish a new snapshot.
+   */
+  void Publish(const T &value) {
+    const unsigned s = sequence.load(std::memory_order_relaxed);
+    sequence.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slots[((s >> 1) + 1) & 1] = value;
+
+    sequence.store(s + 2, std::memory_order_release);
+  }
+
+  /**
+   * Copy the latest snapshot.  This never blocks, but it may copy
+   * more than once if the writer is faster than the reader.
+   */
+  void Read(T &dest) const {
+    while (true) {
+      const unsigned s1 = sequence.load(std::memory_order_acquire);
+      dest = slots[(s1 >> 1) & 1];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const unsigned s2 = sequence.load(std::memory_order_relaxed);
+
+      /* the slot is overwritten by the second publication after s1,
+         which sets bit 0 at (s1 & ~1) + 3 */
+      if (s2 - (s1 & ~1u) < 3)
+        return;
+
+      retries.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Returns the number of snapshots published so far.
+   */
+  gcc_pure
+  unsigned GetVersion() const {
+    return sequence.load(std::memory_order_acquire) >> 1;
+  }
+
+  gcc_pure
+  unsigned GetRetryCount() const {
+    return retries.load(std::memory_order_relaxed);
+  }
+};
+
+#endif
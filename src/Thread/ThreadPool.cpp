@@ -0,0 +1,132 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread/ThreadPool.hpp"
+
+#include <algorithm>
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+void
+ThreadPool::Worker::Tick()
+{
+  mutex.Unlock();
+  pool.Work();
+  mutex.Lock();
+}
+
+ThreadPool::ThreadPool(unsigned _n_workers)
+  :workers(new Worker *[_n_workers]), n_workers(_n_workers),
+   running(false), function(nullptr), size(0), next(0)
+{
+  for (unsigned i = 0; i < n_workers; ++i)
+    workers[i] = new Worker(*this);
+}
+
+ThreadPool::~ThreadPool()
+{
+  for (unsigned i = 0; i < n_workers; ++i) {
+    workers[i]->LockStop();
+    delete workers[i];
+  }
+
+  delete[] workers;
+}
+
+unsigned
+ThreadPool::GetDefaultWorkers(unsigned max)
+{
+#ifdef HAVE_POSIX
+  const long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  const long n_cpus = info.dwNumberOfProcessors;
+#endif
+
+  if (n_cpus <= 1)
+    return 0;
+
+  return std::min((unsigned)n_cpus - 1, max);
+}
+
+void
+ThreadPool::Work()
+{
+  while (true) {
+    unsigned i;
+
+    {
+      const ScopeLock protect(mutex);
+      if (next >= size)
+        return;
+
+      i = next++;
+    }
+
+    (*function)(i);
+  }
+}
+
+void
+ThreadPool::ForEach(unsigned n, const std::function<void(unsigned)> &f)
+{
+  bool busy;
+
+  {
+    const ScopeLock protect(mutex);
+    busy = running;
+    if (!busy) {
+      running = true;
+      function = &f;
+      size = n;
+      next = 0;
+    }
+  }
+
+  if (busy) {
+    /* the workers are in use; don't wait for them, which would
+       deadlock if this is a nested call from inside a job */
+    for (unsigned i = 0; i < n; ++i)
+      f(i);
+    return;
+  }
+
+  /* the calling thread takes one job, so one worker less is needed */
+  const unsigned n_started = n > 0 ? std::min(n - 1, n_workers) : 0;
+  for (unsigned i = 0; i < n_started; ++i)
+    workers[i]->LockTrigger();
+
+  Work();
+
+  for (unsigned i = 0; i < n_started; ++i)
+    workers[i]->LockWaitDone();
+
+  const ScopeLock protect(mutex);
+  function = nullptr;
+  running = false;
+}
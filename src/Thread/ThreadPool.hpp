@@ -0,0 +1,105 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_POOL_HPP
+#define XCSOAR_THREAD_POOL_HPP
+
+#include "Thread/StandbyThread.hpp"
+#include "Thread/Mutex.hpp"
+#include "Util/ParallelExecutor.hpp"
+
+/**
+ * A small pool of worker threads implementing #ParallelExecutor.  The
+ * threads are launched on demand by the first ForEach() call.
+ *
+ * Only one ForEach() call is distributed over the workers at a time.
+ * Calls made while the pool is busy (nested calls from inside a job,
+ * or calls from other threads) run all their jobs in the calling
+ * thread instead of waiting.
+ */
+class ThreadPool final : public ParallelExecutor {
+  class Worker final : private StandbyThread {
+    ThreadPool &pool;
+
+  public:
+    Worker(ThreadPool &_pool):StandbyThread("ThreadPool"), pool(_pool) {}
+
+    using StandbyThread::LockTrigger;
+    using StandbyThread::LockWaitDone;
+    using StandbyThread::LockStop;
+
+  private:
+    /* virtual methods from class StandbyThread */
+    void Tick() override;
+  };
+
+  Worker **workers;
+  const unsigned n_workers;
+
+  /**
+   * Protects the attributes below.
+   */
+  Mutex mutex;
+
+  /**
+   * Is a ForEach() call currently using the workers?
+   */
+  bool running;
+
+  const std::function<void(unsigned)> *function;
+  unsigned size, next;
+
+public:
+  /**
+   * @param n_workers the number of worker threads; zero means all
+   * jobs run in the calling thread
+   */
+  explicit ThreadPool(unsigned n_workers);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * Returns the number of worker threads which makes sense on this
+   * machine (the number of CPU cores minus the calling thread),
+   * limited to the specified maximum.
+   */
+  gcc_pure
+  static unsigned GetDefaultWorkers(unsigned max);
+
+  /* virtual methods from class ParallelExecutor */
+  unsigned GetConcurrency() const override {
+    return n_workers + 1;
+  }
+
+  void ForEach(unsigned n, const std::function<void(unsigned)> &f) override;
+
+private:
+  /**
+   * Run jobs until there are none left.
+   */
+  void Work();
+};
+
+#endif
@@ -93,6 +93,10 @@ public:
     return *this;
   }
 
+  void swap(AllocatedArray &other) {
+    std::swap(buffer, other.buffer);
+  }
+
   /**
    * Returns true if no memory was allocated so far.
    */
@@ -129,6 +129,12 @@ public:
     array.ResizeDiscard(0);
   }
 
+  void Swap(AllocatedGrid &other) {
+    array.swap(other.array);
+    std::swap(width, other.width);
+    std::swap(height, other.height);
+  }
+
   void GrowDiscard(unsigned _width, unsigned _height) {
     array.GrowDiscard(_width * _height);
     width = _width;
@@ -0,0 +1,265 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_DENSE_HASH_MAP_HPP
+#define XCSOAR_DENSE_HASH_MAP_HPP
+
+#include "Compiler.h"
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include <assert.h>
+#include <stdint.h>
+
+/**
+ * A hash map which stores its items in one dense array (the "arena")
+ * and looks them up in an open-addressing table of array indices
+ * with linear probing.
+ *
+ * Items are addressed by their index in the arena, which remains
+ * valid until clear() is called.  Items cannot be removed
+ * individually.  clear() does not free memory, so a map which is
+ * filled and cleared repeatedly (e.g. once per search) stops
+ * allocating after the first few rounds.
+ */
+template<typename K, typename V, typename Hash=std::hash<K>,
+         typename KeyEqual=std::equal_to<K>>
+class DenseHashMap {
+public:
+  struct Item {
+    K key;
+    V value;
+
+    Item(const K &_key, const V &_value):key(_key), value(_value) {}
+  };
+
+  typedef unsigned size_type;
+
+  /**
+   * Returned by find() if the key does not exist.
+   */
+  static constexpr size_type NONE = size_type(-1);
+
+private:
+  /**
+   * Marks an unused slot in the #table.
+   */
+  static constexpr size_type EMPTY = size_type(-1);
+
+  /**
+   * The items in insertion order.
+   */
+  std::vector<Item> items;
+
+  /**
+   * Arena indices; the size is always a power of two and at least
+   * twice the number of items.
+   */
+  std::vector<size_type> table;
+
+  /**
+   * 64 minus the base-2 logarithm of the table size; used to pick
+   * the high bits of the scrambled hash value.
+   */
+  unsigned table_shift;
+
+  Hash hash;
+  KeyEqual key_equal;
+
+public:
+  explicit DenseHashMap(size_type reserve_size=0):table_shift(64) {
+    reserve(reserve_size);
+  }
+
+  gcc_pure
+  size_type size() const {
+    return items.size();
+  }
+
+  gcc_pure
+  bool empty() const {
+    return items.empty();
+  }
+
+  /**
+   * Remove all items, but keep the allocated memory for reuse.
+   */
+  void clear() {
+    if (items.size() * 8 < table.size())
+      /* sparse: erase only the slots which are in use; this must be
+         done in reverse insertion order, because the probe sequence
+         of an item may pass the slots of all older items */
+      for (auto i = items.rbegin(); i != items.rend(); ++i)
+        table[Lookup(i->key)] = EMPTY;
+    else
+      std::fill(table.begin(), table.end(), size_type(EMPTY));
+
+    items.clear();
+  }
+
+  /**
+   * Make sure that the specified number of items can be added
+   * without allocating memory.
+   */
+  void reserve(size_type n) {
+    items.reserve(n);
+
+    size_type table_size = 16;
+    while (table_size < n * 2)
+      table_size *= 2;
+
+    if (table_size > table.size())
+      Rehash(table_size);
+  }
+
+  /**
+   * Look up a key.
+   *
+   * @return the item's index or #NONE if the key does not exist
+   */
+  gcc_pure
+  size_type find(const K &key) const {
+    if (table.empty())
+      return NONE;
+
+    return table[Lookup(key)];
+  }
+
+  /**
+   * Add a new item unless the key already exists.
+   *
+   * @return the index of the (new or existing) item and a flag
+   * which is true if the item was added
+   */
+  std::pair<size_type, bool> insert(const K &key, const V &value) {
+    if ((items.size() + 1) * 2 > table.size())
+      Rehash(std::max<size_type>(table.size() * 2, 16));
+
+    size_type &slot = table[Lookup(key)];
+    if (slot != EMPTY)
+      return std::make_pair(slot, false);
+
+    slot = items.size();
+    items.emplace_back(key, value);
+    return std::make_pair(slot, true);
+  }
+
+  Item &operator[](size_type i) {
+    assert(i < items.size());
+
+    return items[i];
+  }
+
+  const Item &operator[](size_type i) const {
+    assert(i < items.size());
+
+    return items[i];
+  }
+
+private:
+  /**
+   * Find the slot which contains the specified key or the empty
+   * slot where it would be inserted.
+   */
+  gcc_pure
+  size_type Lookup(const K &key) const {
+    assert(!table.empty());
+
+    /* Fibonacci hashing: spread the hash over the whole table, so
+       simple hash functions (e.g. linear combinations of
+       coordinates) do not form long probe sequences */
+    const uint64_t scrambled = uint64_t(hash(key)) * 0x9e3779b97f4a7c15ull;
+
+    const size_type mask = table.size() - 1;
+    for (size_type i = size_type(scrambled >> table_shift);;
+         i = (i + 1) & mask) {
+      const size_type index = table[i];
+      if (index == EMPTY || key_equal(items[index].key, key))
+        return i;
+    }
+  }
+
+  void Rehash(size_type new_size) {
+    assert((new_size & (new_size - 1)) == 0);
+
+    table.assign(new_size, size_type(EMPTY));
+
+    table_shift = 64;
+    for (size_type i = new_size; i > 1; i /= 2)
+      --table_shift;
+
+    for (size_type i = 0, n = items.size(); i < n; ++i)
+      table[Lookup(items[i].key)] = i;
+  }
+};
+
+/**
+ * A set variant of DenseHashMap.
+ */
+template<typename K, typename Hash=std::hash<K>,
+         typename KeyEqual=std::equal_to<K>>
+class DenseHashSet {
+  struct Empty {};
+
+  DenseHashMap<K, Empty, Hash, KeyEqual> map;
+
+public:
+  typedef typename DenseHashMap<K, Empty, Hash, KeyEqual>::size_type size_type;
+
+  explicit DenseHashSet(size_type reserve_size=0):map(reserve_size) {}
+
+  gcc_pure
+  size_type size() const {
+    return map.size();
+  }
+
+  gcc_pure
+  bool empty() const {
+    return map.empty();
+  }
+
+  void clear() {
+    map.clear();
+  }
+
+  void reserve(size_type n) {
+    map.reserve(n);
+  }
+
+  gcc_pure
+  bool contains(const K &key) const {
+    return map.find(key) != map.NONE;
+  }
+
+  /**
+   * @return true if the key was added, false if it existed already
+   */
+  bool insert(const K &key) {
+    return map.insert(key, Empty()).second;
+  }
+};
+
+#endif
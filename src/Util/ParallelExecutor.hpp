@@ -0,0 +1,53 @@
+/*
+Copyright_License {
+
+  Top Hat Soaring Glide Computer - http://www.tophatsoaring.org/
+  Copyright (C) 2000-2016 The Top Hat Soaring Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_PARALLEL_EXECUTOR_HPP
+#define XCSOAR_PARALLEL_EXECUTOR_HPP
+
+#include <functional>
+
+/**
+ * An interface for running independent jobs concurrently.  It allows
+ * libraries which do not depend on the threading library (e.g. the
+ * task engine) to make use of a thread pool, see class #ThreadPool.
+ */
+class ParallelExecutor {
+public:
+  /**
+   * Returns the number of jobs which may run at the same time,
+   * including the calling thread.
+   */
+  virtual unsigned GetConcurrency() const = 0;
+
+  /**
+   * Invoke the function once for each index in the range [0, n).
+   * The invocations may run concurrently (in no particular order),
+   * and the calling thread participates.  Returns after all
+   * invocations have finished.  May be called from within such an
+   * invocation; the nested invocations may then run in the calling
+   * thread.
+   */
+  virtual void ForEach(unsigned n, const std::function<void(unsigned)> &f) = 0;
+};
+
+#endif
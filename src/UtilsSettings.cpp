@@ -192,7 +192,7 @@ SettingsLeave(const UISettings &old_ui_settings)
     airspace_database.Clear();
     ReadAirspace(airspace_database, terrain,
                  CommonInterface::GetComputerSettings().pressure,
-                 operation);
+                 file_cache, operation);
   }
 
   if (DevicePortChanged)
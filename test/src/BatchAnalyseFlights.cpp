@@ -0,0 +1,239 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+/*
+ * Analyse many flights at once, e.g. to re-score a whole season.
+ * Each flight is replayed by its own FlightAnalysis instance, and the
+ * flights are distributed over a thread pool.  The results are
+ * written as one JSON document to stdout, in the order of the input
+ * files.
+ */
+
+#include "FlightAnalysis.hpp"
+#include "DebugReplayIGC.hpp"
+#include "OS/Args.hpp"
+#include "OS/FileUtil.hpp"
+#include "OS/PathName.hpp"
+#include "IO/TextWriter.hpp"
+#include "JSON/Writer.hpp"
+#include "JSON/GeoWriter.hpp"
+#include "Thread/ThreadPool.hpp"
+#include "Time/PeriodClock.hpp"
+#include "Util/StringUtil.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+class IGCFileCollector : public File::Visitor {
+  std::vector<std::string> &paths;
+
+public:
+  explicit IGCFileCollector(std::vector<std::string> &_paths)
+    :paths(_paths) {}
+
+  void Visit(const char *path, const char *filename) override {
+    if (MatchesExtension(filename, ".igc"))
+      paths.emplace_back(path);
+  }
+};
+
+/**
+ * Add a file, or all IGC files in a directory and its
+ * subdirectories.
+ */
+static void
+AddPath(std::vector<std::string> &paths, const char *path)
+{
+  if (Directory::Exists(path)) {
+    std::vector<std::string> found;
+    IGCFileCollector collector(found);
+    Directory::VisitFiles(path, collector, true);
+
+    /* the directory order is arbitrary */
+    std::sort(found.begin(), found.end());
+    paths.insert(paths.end(), found.begin(), found.end());
+  } else
+    paths.emplace_back(path);
+}
+
+/**
+ * Add the paths listed in the file, one per line.
+ */
+static void
+AddList(std::vector<std::string> &paths, FILE *file)
+{
+  char line[4096];
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    StripRight(line);
+    if (*line != 0)
+      AddPath(paths, line);
+  }
+}
+
+static void
+WriteFlight(TextWriter &writer, const char *path,
+            const FlightAnalysis *analysis)
+{
+  JSON::ObjectWriter object(writer);
+
+  object.WriteElement("file", JSON::WriteString, path);
+
+  if (analysis != nullptr)
+    analysis->Write(object);
+  else
+    object.WriteElement("error", JSON::WriteString, "Failed to open");
+}
+
+static void
+WriteStatistics(TextWriter &writer, unsigned n_flights, unsigned n_failed,
+                unsigned n_threads, fixed duration)
+{
+  JSON::ObjectWriter object(writer);
+
+  object.WriteElement("flights", JSON::WriteUnsigned, n_flights);
+  object.WriteElement("failed", JSON::WriteUnsigned, n_failed);
+  object.WriteElement("threads", JSON::WriteUnsigned, n_threads);
+  object.WriteElement("duration", JSON::WriteFixed, duration);
+  if (positive(duration))
+    object.WriteElement("flights_per_second", JSON::WriteFixed,
+                        n_flights / duration);
+}
+
+int main(int argc, char **argv)
+{
+  unsigned full_max_points = 512,
+           triangle_max_points = 1024,
+           sprint_max_points = 64,
+           n_threads = ThreadPool::GetDefaultWorkers(63) + 1;
+
+  Args args(argc, argv,
+            "[options] PATH...\n"
+            "PATH is an IGC file, a directory which is searched for IGC files,\n"
+            "or \"-\" to read a list of paths from stdin\n"
+            "Options:\n"
+            "  --threads=N              Number of flights analysed concurrently (default = number of CPUs)\n"
+            "  --full-points=512        Maximum number of full trace points (default = 512)\n"
+            "  --triangle-points=1024   Maximum number of triangle trace points (default = 1024)\n"
+            "  --sprint-points=64       Maximum number of sprint trace points (default = 64)");
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && arg[0] == '-' && arg[1] != 0) {
+    args.Skip();
+
+    const char *value;
+    if ((value = StringAfterPrefix(arg, "--threads=")) != nullptr)
+      n_threads = args.ParsePositive(value);
+    else if ((value = StringAfterPrefix(arg, "--full-points=")) != nullptr)
+      full_max_points = args.ParsePositive(value);
+    else if ((value = StringAfterPrefix(arg, "--triangle-points=")) != nullptr)
+      triangle_max_points = args.ParsePositive(value);
+    else if ((value = StringAfterPrefix(arg, "--sprint-points=")) != nullptr)
+      sprint_max_points = args.ParsePositive(value);
+    else
+      args.UsageError();
+  }
+
+  std::vector<std::string> paths;
+  do {
+    const char *path = args.ExpectNext();
+    if (strcmp(path, "-") == 0)
+      AddList(paths, stdin);
+    else
+      AddPath(paths, path);
+  } while (!args.IsEmpty());
+
+  ThreadPool pool(n_threads - 1);
+
+  /* analyse a few flights per thread at a time, so the results can be
+     written in order without keeping all of them in memory */
+  const unsigned batch_size = pool.GetConcurrency() * 4;
+  std::vector<FlightAnalysis *> analyses(batch_size);
+
+  unsigned n_failed = 0;
+
+  PeriodClock clock;
+  clock.Update();
+
+  TextWriter writer("/dev/stdout", true);
+
+  {
+    JSON::ObjectWriter root(writer);
+    root.BeginElement("flights");
+
+    {
+      JSON::ArrayWriter flights(writer);
+
+      for (unsigned start = 0; start < paths.size(); start += batch_size) {
+        const unsigned n = std::min(unsigned(paths.size()) - start,
+                                    batch_size);
+
+        pool.ForEach(n, [&](unsigned i){
+            analyses[i] = nullptr;
+
+            DebugReplay *replay =
+              DebugReplayIGC::Create(paths[start + i].c_str());
+            if (replay == nullptr)
+              return;
+
+            FlightAnalysis *analysis =
+              new FlightAnalysis(full_max_points, triangle_max_points,
+                                 sprint_max_points);
+            analysis->Run(*replay);
+            delete replay;
+
+            analysis->SolveContests();
+            analyses[i] = analysis;
+          });
+
+        for (unsigned i = 0; i < n; ++i) {
+          if (analyses[i] == nullptr)
+            ++n_failed;
+
+          flights.WriteElement(WriteFlight, paths[start + i].c_str(),
+                               (const FlightAnalysis *)analyses[i]);
+          delete analyses[i];
+        }
+      }
+    }
+
+    root.EndElement();
+
+    const fixed duration = fixed(std::max(clock.Elapsed(), 1)) / 1000;
+    root.WriteElement("statistics", WriteStatistics,
+                      unsigned(paths.size()), n_failed,
+                      pool.GetConcurrency(), duration);
+
+    fprintf(stderr, "%u flights (%u failed) in %.1f s with %u thread(s): %.2f flights/s\n",
+            unsigned(paths.size()), n_failed, (double)duration,
+            pool.GetConcurrency(), (double)(paths.size() / duration));
+  }
+
+  writer.NewLine();
+
+  return n_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
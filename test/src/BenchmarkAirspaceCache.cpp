@@ -0,0 +1,132 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Compares loading an airspace file by parsing it with loading it
+ * from the binary cache.  Both paths construct the same airspace
+ * objects, and Airspaces::Optimise() builds the same R-tree and
+ * projected edge indexes afterwards, so that step is measured
+ * separately: the cache speeds up only the part before it.
+ */
+
+#include "Airspace/AirspaceCache.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "IO/FileCache.hpp"
+#include "IO/FileLineReader.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "OS/FileMapping.hpp"
+#include "Operation/Operation.hpp"
+
+#include <memory>
+#include <vector>
+
+#include <stdio.h>
+
+static constexpr unsigned N_RUNS = 10;
+
+static const char *const cache_name = "airspace";
+
+int main(int argc, char **argv)
+{
+  Args args(argc, argv, "PATH CACHE_DIR");
+  const char *path = args.ExpectNext();
+  const char *cache_dir = args.ExpectNext();
+  args.ExpectEnd();
+
+  FileCache cache(cache_dir);
+  NullOperationEnvironment operation;
+
+  uint64_t parse_time = 0, parse_optimise_time = 0;
+  unsigned n_airspaces = 0;
+  std::vector<const AbstractAirspace *> added;
+
+  for (unsigned i = 0; i < N_RUNS; ++i) {
+    const uint64_t start = MonotonicClockUS();
+
+    FileLineReader reader(path, Charset::AUTO);
+    if (reader.error()) {
+      fprintf(stderr, "Failed to open input file\n");
+      return 1;
+    }
+
+    Airspaces airspaces;
+    AirspaceParser parser(airspaces);
+    added.clear();
+    if (!parser.Parse(reader, operation, &added)) {
+      fprintf(stderr, "Failed to parse input file\n");
+      return 1;
+    }
+
+    const uint64_t parsed = MonotonicClockUS();
+    parse_time += parsed - start;
+
+    airspaces.Optimise();
+    parse_optimise_time += MonotonicClockUS() - parsed;
+    n_airspaces = airspaces.GetSize();
+
+    if (i == N_RUNS - 1) {
+      FILE *file = cache.Save(cache_name, path);
+      if (file == nullptr || !SaveAirspaceCache(file, path, added) ||
+          !cache.Commit(cache_name, file)) {
+        fprintf(stderr, "Failed to write cache\n");
+        return 1;
+      }
+    }
+  }
+
+  uint64_t cache_time = 0, cache_optimise_time = 0;
+  for (unsigned i = 0; i < N_RUNS; ++i) {
+    const uint64_t start = MonotonicClockUS();
+
+    size_t offset;
+    std::unique_ptr<FileMapping> mapping(cache.Map(cache_name, path, offset));
+    Airspaces airspaces;
+    if (!mapping ||
+        !LoadAirspaceCache(mapping->at(offset), mapping->size() - offset,
+                           path, airspaces)) {
+      fprintf(stderr, "Failed to load cache\n");
+      return 1;
+    }
+
+    const uint64_t loaded = MonotonicClockUS();
+    cache_time += loaded - start;
+
+    airspaces.Optimise();
+    cache_optimise_time += MonotonicClockUS() - loaded;
+
+    if (airspaces.GetSize() != n_airspaces) {
+      fprintf(stderr, "Airspace count mismatch\n");
+      return 1;
+    }
+  }
+
+  printf("%u airspaces\n", n_airspaces);
+  printf("parse  %8.2f ms + Optimise %8.2f ms\n",
+         parse_time / 1000. / N_RUNS, parse_optimise_time / 1000. / N_RUNS);
+  printf("cache  %8.2f ms + Optimise %8.2f ms\n",
+         cache_time / 1000. / N_RUNS, cache_optimise_time / 1000. / N_RUNS);
+
+  cache.Flush(cache_name);
+  return 0;
+}
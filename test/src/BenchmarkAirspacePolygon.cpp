@@ -0,0 +1,203 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Compares the indexed AirspacePolygon queries with the linear scans
+ * over the border, for all polygons of an airspace file which are
+ * large enough to be indexed.  Any mismatch is reported and makes the
+ * program fail.
+ */
+
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "Engine/Airspace/AirspaceIntersectSort.hpp"
+#include "Engine/Airspace/AirspaceIntersectionVector.hpp"
+#include "Geo/PolygonEdgeIndex.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "Geo/GeoVector.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "Geo/Flat/FlatRay.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Operation/Operation.hpp"
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr unsigned N_QUERIES = 2000;
+
+/** the linear version of AirspacePolygon::Intersects() */
+static AirspaceIntersectionVector
+LinearIntersects(const AbstractAirspace &airspace,
+                 const GeoPoint &start, const GeoPoint &end,
+                 const FlatProjection &projection)
+{
+  const SearchPointVector &border = airspace.GetPoints();
+  const FlatRay ray(projection.ProjectInteger(start),
+                    projection.ProjectInteger(end));
+
+  AirspaceIntersectSort sorter(start, airspace);
+
+  for (auto it = border.begin(); it + 1 != border.end(); ++it) {
+    const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
+    fixed t = ray.DistinctIntersection(r_seg);
+    if (!negative(t))
+      sorter.add(t, projection.Unproject(ray.Parametric(t)));
+  }
+
+  return sorter.all();
+}
+
+static GeoPoint
+RandomPoint(const GeoBounds &bounds)
+{
+  const Angle lon = bounds.GetWest() +
+    bounds.GetWidth() * fixed(1.2 * (rand() % 10000) / 10000. - 0.1);
+  const Angle lat = bounds.GetSouth() +
+    bounds.GetHeight() * fixed(1.2 * (rand() % 10000) / 10000. - 0.1);
+  return GeoPoint(lon, lat);
+}
+
+struct Timing {
+  uint64_t indexed = 0, linear = 0;
+
+  void Print(const char *name) const {
+    printf("%-14s %10.1f %10.1f %8.1fx\n", name,
+           indexed / 1000., linear / 1000.,
+           indexed > 0 ? double(linear) / indexed : 0.);
+  }
+};
+
+int main(int argc, char **argv)
+{
+  Args args(argc, argv, "PATH");
+  const char *path = args.ExpectNext();
+  args.ExpectEnd();
+
+  FileLineReader reader(path, Charset::AUTO);
+  if (reader.error()) {
+    fprintf(stderr, "Failed to open input file\n");
+    return 1;
+  }
+
+  Airspaces airspaces;
+  AirspaceParser parser(airspaces);
+
+  NullOperationEnvironment operation;
+  if (!parser.Parse(reader, operation)) {
+    fprintf(stderr, "Failed to parse input file\n");
+    return 1;
+  }
+
+  airspaces.Optimise();
+
+  const FlatProjection &projection = airspaces.GetProjection();
+
+  srand(1);
+
+  unsigned n_polygons = 0, n_points = 0, max_points = 0, errors = 0;
+  Timing inside, nearest, intersects;
+
+  for (const auto &i : airspaces) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+    const SearchPointVector &border = airspace.GetPoints();
+    if (airspace.GetShape() != AbstractAirspace::Shape::POLYGON ||
+        !PolygonEdgeIndex::IsWorthwhile(border))
+      continue;
+
+    ++n_polygons;
+    n_points += border.size();
+    if (border.size() > max_points)
+      max_points = border.size();
+
+    const GeoBounds bounds = airspace.GetGeoBounds();
+    std::vector<GeoPoint> points, ends;
+    for (unsigned j = 0; j < N_QUERIES; ++j) {
+      points.push_back(RandomPoint(bounds));
+      /* short rays, like the warning manager's glide and prediction
+         vectors */
+      ends.push_back(GeoVector(fixed(2000 + rand() % 20000),
+                               Angle::Degrees(rand() % 360))
+                     .EndPoint(points.back()));
+    }
+
+    std::vector<bool> inside_result(N_QUERIES);
+    std::vector<GeoPoint> nearest_result(N_QUERIES);
+    std::vector<AirspaceIntersectionVector> intersects_result(N_QUERIES);
+
+    uint64_t t = MonotonicClockUS();
+    for (unsigned j = 0; j < N_QUERIES; ++j)
+      inside_result[j] = airspace.Inside(points[j]);
+    inside.indexed += MonotonicClockUS() - t;
+
+    t = MonotonicClockUS();
+    for (unsigned j = 0; j < N_QUERIES; ++j)
+      if (border.IsInside(points[j]) != inside_result[j])
+        ++errors;
+    inside.linear += MonotonicClockUS() - t;
+
+    t = MonotonicClockUS();
+    for (unsigned j = 0; j < N_QUERIES; ++j)
+      nearest_result[j] = airspace.ClosestPoint(points[j], projection);
+    nearest.indexed += MonotonicClockUS() - t;
+
+    t = MonotonicClockUS();
+    for (unsigned j = 0; j < N_QUERIES; ++j) {
+      const FlatGeoPoint p = projection.ProjectInteger(points[j]);
+      if (projection.Unproject(border.NearestPoint(p)) != nearest_result[j])
+        ++errors;
+    }
+    nearest.linear += MonotonicClockUS() - t;
+
+    t = MonotonicClockUS();
+    for (unsigned j = 0; j < N_QUERIES; ++j)
+      intersects_result[j] = airspace.Intersects(points[j], ends[j],
+                                                 projection);
+    intersects.indexed += MonotonicClockUS() - t;
+
+    t = MonotonicClockUS();
+    for (unsigned j = 0; j < N_QUERIES; ++j)
+      if (LinearIntersects(airspace, points[j], ends[j], projection) !=
+          intersects_result[j])
+        ++errors;
+    intersects.linear += MonotonicClockUS() - t;
+  }
+
+  printf("%u indexed polygons, %u points (max %u), %u queries each\n",
+         n_polygons, n_points, max_points, N_QUERIES);
+  printf("%-14s %10s %10s %9s\n", "query", "index ms", "linear ms",
+         "speedup");
+  inside.Print("Inside");
+  nearest.Print("ClosestPoint");
+  intersects.Print("Intersects");
+
+  if (errors > 0) {
+    fprintf(stderr, "%u mismatches\n", errors);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,169 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Measures the spatial queries of the #Airspaces container on a
+ * large synthetic database.  The visit counts are printed so results
+ * can be compared between implementations.
+ */
+
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceVisitor.hpp"
+#include "Engine/Airspace/AirspaceIntersectionVisitor.hpp"
+#include "Navigation/Aircraft.hpp"
+#include "Geo/GeoVector.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static GeoPoint
+RandomLocation(const GeoPoint &origin, double extent)
+{
+  return GeoPoint(origin.longitude +
+                  Angle::Degrees(extent * (rand() % 10000) / 10000.),
+                  origin.latitude +
+                  Angle::Degrees(extent * (rand() % 10000) / 10000.));
+}
+
+static AbstractAirspace *
+RandomAirspace(const GeoPoint &origin, double extent)
+{
+  const GeoPoint center = RandomLocation(origin, extent);
+  const fixed radius(1000 + rand() % 20000);
+
+  if (rand() % 2 == 0)
+    return new AirspaceCircle(center, radius);
+
+  std::vector<GeoPoint> points;
+  const unsigned n = 4 + rand() % 40;
+  for (unsigned i = 0; i < n; ++i)
+    points.push_back(GeoVector(radius * fixed(0.5 + (rand() % 100) / 200.),
+                               Angle::FullCircle() * i / n)
+                     .EndPoint(center));
+
+  return new AirspacePolygon(points);
+}
+
+class CountingVisitor final : public AirspaceVisitor {
+public:
+  unsigned count = 0;
+
+  void Visit(const AbstractAirspace &) override {
+    ++count;
+  }
+};
+
+class CountingIntersectionVisitor final
+  : public AirspaceIntersectionVisitor {
+public:
+  unsigned count = 0;
+
+  void Visit(const AbstractAirspace &) override {
+    count += intersections.size();
+  }
+};
+
+template<typename F>
+static void
+Measure(const char *name, unsigned n, F &&f)
+{
+  const uint64_t start = MonotonicClockUS();
+  const unsigned result = f();
+  const uint64_t duration = MonotonicClockUS() - start;
+
+  printf("%-18s %9.1f ms %8.2f us/call %9u results\n", name,
+         duration / 1000., double(duration) / n, result);
+}
+
+int main(int argc, char **argv)
+{
+  Args args(argc, argv, "[COUNT]");
+  const unsigned n_airspaces = args.IsEmpty()
+    ? 10000
+    : strtoul(args.ExpectNext(), nullptr, 10);
+  args.ExpectEnd();
+
+  srand(1);
+
+  const GeoPoint origin(Angle::Degrees(2), Angle::Degrees(44));
+  const double extent = 10;
+
+  Airspaces airspaces;
+  for (unsigned i = 0; i < n_airspaces; ++i)
+    airspaces.Add(RandomAirspace(origin, extent));
+
+  const unsigned n_queries = 20000;
+  std::vector<GeoPoint> locations, ends;
+  for (unsigned i = 0; i < n_queries; ++i) {
+    locations.push_back(RandomLocation(origin, extent));
+    ends.push_back(GeoVector(fixed(5000 + rand() % 30000),
+                             Angle::Degrees(rand() % 360))
+                   .EndPoint(locations.back()));
+  }
+
+  printf("%u airspaces, %u queries each\n", n_airspaces, n_queries);
+
+  Measure("Optimise", 1, [&airspaces](){
+      airspaces.Optimise();
+      return airspaces.GetSize();
+    });
+
+  Measure("VisitWithinRange", n_queries, [&](){
+      CountingVisitor visitor;
+      for (const auto &i : locations)
+        airspaces.VisitWithinRange(i, fixed(20000), visitor);
+      return visitor.count;
+    });
+
+  Measure("ScanRange", n_queries, [&](){
+      unsigned count = 0;
+      for (const auto &i : locations)
+        count += airspaces.ScanRange(i, fixed(5000)).size();
+      return count;
+    });
+
+  Measure("FindInside", n_queries, [&](){
+      unsigned count = 0;
+      AircraftState state;
+      state.altitude = fixed(0);
+      for (const auto &i : locations) {
+        state.location = i;
+        count += airspaces.FindInside(state).size();
+      }
+      return count;
+    });
+
+  Measure("VisitIntersecting", n_queries, [&](){
+      CountingIntersectionVisitor visitor;
+      for (unsigned i = 0; i < n_queries; ++i)
+        airspaces.VisitIntersecting(locations[i], ends[i], visitor);
+      return visitor.count;
+    });
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Measures Airspaces::SynchroniseInRange() the way the route planner
+ * uses it: a local copy follows a moving query window over a large
+ * master database.  After each call, the copy is checked against a
+ * fresh query of the master.
+ */
+
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Geo/GeoVector.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static GeoPoint
+RandomLocation(const GeoPoint &origin, double extent)
+{
+  return GeoPoint(origin.longitude +
+                  Angle::Degrees(extent * (rand() % 10000) / 10000.),
+                  origin.latitude +
+                  Angle::Degrees(extent * (rand() % 10000) / 10000.));
+}
+
+static AbstractAirspace *
+RandomAirspace(const GeoPoint &origin, double extent)
+{
+  const GeoPoint center = RandomLocation(origin, extent);
+  const fixed radius(1000 + rand() % 20000);
+
+  if (rand() % 2 == 0)
+    return new AirspaceCircle(center, radius);
+
+  std::vector<GeoPoint> points;
+  const unsigned n = 4 + rand() % 40;
+  for (unsigned i = 0; i < n; ++i)
+    points.push_back(GeoVector(radius * fixed(0.5 + (rand() % 100) / 200.),
+                               Angle::FullCircle() * i / n)
+                     .EndPoint(center));
+
+  return new AirspacePolygon(points);
+}
+
+gcc_pure
+static std::vector<const AbstractAirspace *>
+Contents(const Airspaces &airspaces)
+{
+  std::vector<const AbstractAirspace *> result;
+  for (const auto &i : airspaces)
+    result.push_back(&i.GetAirspace());
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+gcc_pure
+static std::vector<const AbstractAirspace *>
+Expected(const Airspaces &master, const GeoPoint &location, fixed range)
+{
+  std::vector<const AbstractAirspace *> result;
+  for (const auto &i : master.ScanRange(location, range))
+    if (i.GetAirspace().IsActive())
+      result.push_back(&i.GetAirspace());
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+int main(int argc, char **argv)
+{
+  Args args(argc, argv, "[COUNT]");
+  const unsigned n_airspaces = args.IsEmpty()
+    ? 6000
+    : strtoul(args.ExpectNext(), nullptr, 10);
+  args.ExpectEnd();
+
+  srand(1);
+
+  const GeoPoint origin(Angle::Degrees(2), Angle::Degrees(44));
+  const double extent = 10;
+
+  Airspaces master;
+  for (unsigned i = 0; i < n_airspaces; ++i) {
+    AbstractAirspace *airspace = RandomAirspace(origin, extent);
+    master.Add(airspace);
+  }
+
+  master.Optimise();
+
+  Airspaces local(false);
+
+  /* fly across the area with a final glide destination 60 km ahead,
+     like AirspaceRoute::Synchronise() */
+  const unsigned n_steps = 3000;
+  const Angle track = Angle::Degrees(40);
+  GeoPoint location = origin;
+
+  uint64_t duration = 0;
+  unsigned n_changes = 0, max_size = 0, errors = 0;
+
+  for (unsigned i = 0; i < n_steps; ++i) {
+    location = GeoVector(fixed(400), track).EndPoint(location);
+    const GeoPoint destination =
+      GeoVector(fixed(60000), track).EndPoint(location);
+    const GeoPoint middle = location.Middle(destination);
+    const fixed range = Half(location.Distance(destination));
+
+    const uint64_t start = MonotonicClockUS();
+    if (local.SynchroniseInRange(master, middle, range))
+      ++n_changes;
+    duration += MonotonicClockUS() - start;
+
+    max_size = std::max(max_size, local.GetSize());
+
+    if (Contents(local) != Expected(master, middle, range))
+      ++errors;
+  }
+
+  printf("%u airspaces, %u synchronisations, %u with changes, "
+         "up to %u airspaces in range\n",
+         master.GetSize(), n_steps, n_changes, max_size);
+  printf("total %.1f ms, %.1f us per call\n",
+         duration / 1000., double(duration) / n_steps);
+
+  if (errors > 0) {
+    fprintf(stderr, "%u mismatches\n", errors);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,175 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Measures AirspaceWarningManager::Update() on a large synthetic
+ * airspace database, with the aircraft flying across it.  The warning
+ * count is printed so results can be compared between
+ * implementations.
+ */
+
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceWarningManager.hpp"
+#include "Engine/Airspace/AirspaceWarningConfig.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Task/Stats/TaskStats.hpp"
+#include "Navigation/Aircraft.hpp"
+#include "Geo/GeoVector.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static GeoPoint
+RandomLocation(const GeoPoint &origin, double extent)
+{
+  return GeoPoint(origin.longitude +
+                  Angle::Degrees(extent * (rand() % 10000) / 10000.),
+                  origin.latitude +
+                  Angle::Degrees(extent * (rand() % 10000) / 10000.));
+}
+
+static AirspaceAltitude
+RandomAltitude(int min, int max)
+{
+  AirspaceAltitude altitude;
+  const int value = min + rand() % (max - min);
+
+  switch (rand() % 3) {
+  case 0:
+    altitude.reference = AltitudeReference::MSL;
+    altitude.altitude = fixed(value);
+    break;
+
+  case 1:
+    altitude.reference = AltitudeReference::AGL;
+    altitude.altitude_above_terrain = fixed(value / 4);
+    break;
+
+  default:
+    altitude.reference = AltitudeReference::STD;
+    altitude.flight_level = fixed(value / 30);
+    break;
+  }
+
+  return altitude;
+}
+
+static AbstractAirspace *
+RandomAirspace(const GeoPoint &origin, double extent)
+{
+  const GeoPoint center = RandomLocation(origin, extent);
+  const fixed radius(1000 + rand() % 20000);
+
+  AbstractAirspace *airspace;
+  if (rand() % 2 == 0)
+    airspace = new AirspaceCircle(center, radius);
+  else {
+    std::vector<GeoPoint> points;
+    const unsigned n = 4 + rand() % 40;
+    for (unsigned i = 0; i < n; ++i)
+      points.push_back(GeoVector(radius * fixed(0.5 + (rand() % 100) / 200.),
+                                 Angle::FullCircle() * i / n)
+                       .EndPoint(center));
+
+    airspace = new AirspacePolygon(points);
+  }
+
+  /* stacked airspace: most bases are far above a glider */
+  const AirspaceAltitude base = RandomAltitude(0, 6000);
+  const AirspaceAltitude top = RandomAltitude(6000, 20000);
+  airspace->SetProperties(_T("test"), CTR, base, top);
+
+  if (rand() % 3 == 0)
+    airspace->SetDays(AirspaceActivity(rand() % 7));
+
+  return airspace;
+}
+
+int main(int argc, char **argv)
+{
+  Args args(argc, argv, "[COUNT]");
+  const unsigned n_airspaces = args.IsEmpty()
+    ? 10000
+    : strtoul(args.ExpectNext(), nullptr, 10);
+  args.ExpectEnd();
+
+  srand(1);
+
+  const GeoPoint origin(Angle::Degrees(2), Angle::Degrees(44));
+  const double extent = 10;
+
+  Airspaces airspaces;
+  for (unsigned i = 0; i < n_airspaces; ++i)
+    airspaces.Add(RandomAirspace(origin, extent));
+
+  airspaces.Optimise();
+  airspaces.SetFlightLevels(AtmosphericPressure::Standard());
+  airspaces.SetActivity(AirspaceActivity(2));
+
+  AirspaceWarningConfig config;
+  config.SetDefaults();
+
+  AirspaceWarningManager warnings(airspaces);
+  warnings.SetConfig(config);
+  const GlidePolar glide_polar(fixed(1));
+
+  TaskStats task_stats;
+  task_stats.task_valid = false;
+
+  /* fly diagonally across the database at 35 m/s */
+  AircraftState state;
+  state.Reset();
+  state.flying = true;
+  state.location = origin;
+  state.track = Angle::Degrees(45);
+  state.ground_speed = state.true_airspeed = fixed(35);
+  warnings.Reset(state);
+
+  const unsigned n_updates = 20000;
+  unsigned n_warnings = 0;
+
+  const uint64_t start = MonotonicClockUS();
+  for (unsigned i = 0; i < n_updates; ++i) {
+    state.time = fixed(i);
+    state.location = GeoVector(state.ground_speed * i, state.track)
+      .EndPoint(origin);
+    state.altitude = fixed(500 + (i * 7) % 2500);
+    state.altitude_agl = state.altitude - fixed(200);
+    state.vario = fixed(i % 60 < 20 ? 2 : -1);
+
+    warnings.Update(state, glide_polar, task_stats, i % 60 < 20, 1);
+    n_warnings += warnings.size();
+  }
+  const uint64_t duration = MonotonicClockUS() - start;
+
+  printf("%u airspaces, %u updates: %.1f ms, %.2f us/update, %u warnings\n",
+         n_airspaces, n_updates, duration / 1000.,
+         double(duration) / n_updates, n_warnings);
+
+  return 0;
+}
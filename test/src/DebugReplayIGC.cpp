@@ -22,14 +22,15 @@ Copyright_License {
 */
 
 #include "DebugReplayIGC.hpp"
-#include "IO/FileLineReader.hpp"
 #include "IGC/IGCParser.hpp"
 #include "IGC/IGCFix.hpp"
 #include "Units/System.hpp"
 
 DebugReplay*
 DebugReplayIGC::Create(const char *input_file) {
-  FileLineReaderA *reader = new FileLineReaderA(input_file);
+  /* the interpolated fixes carry no extension values, so the "I"
+     records don't need to be decoded */
+  IGCMappedReader *reader = new IGCMappedReader(input_file, false);
   if (reader->error()) {
     delete reader;
     fprintf(stderr, "Failed to open %s\n", input_file);
@@ -43,13 +44,16 @@ bool
 DebugReplayIGC::Next()
 {
   last_basic = computed_basic;
-  const char *line;
+  ConstBuffer<char> line;
   IGCFix fix;
   while (cli->NeedData(virtual_time)) {
-    if ((line = reader->ReadLine()) != NULL) {
-      if (line[0] == 'B') {
+    if (!(line = reader->ReadLine()).IsNull()) {
+      if (line.IsEmpty())
+        continue;
+
+      if (line.data[0] == 'B') {
         fix.Clear();
-        if (IGCParseFix(line, extensions, fix) && fix.time.IsPlausible()) {
+        if (reader->ParseFix(line, fix) && fix.time.IsPlausible()) {
           cli->Update(fix.time.GetSecondOfDay(), fix.location,
                       fix.gps_altitude,
                       fix.pressure_altitude);
@@ -59,17 +63,18 @@ DebugReplayIGC::Next()
         }
         continue;
 
-      } else if (line[0] == 'H') {
+      } else if (line.data[0] == 'H') {
+        const char *h = reader->Terminate(line);
         BrokenDate date;
-        if (memcmp(line, "HFDTE", 5) == 0 &&
-            IGCParseDateRecord(line, date)) {
+        if (memcmp(h, "HFDTE", 5) == 0 &&
+            IGCParseDateRecord(h, date)) {
           (BrokenDate &)raw_basic.date_time_utc = date;
           raw_basic.time_available.Clear();
         } else {
-          IGCParseHRecords(line, glider_type, logger_settings);
+          IGCParseHRecords(h, glider_type, logger_settings);
         }
-      } else if (line[0] == 'I') {
-        IGCParseExtensions(line, extensions);
+      } else if (line.data[0] == 'I') {
+        reader->ParseExtensions(line);
       }
     } else {
       if (computed_basic.time_available)
@@ -24,27 +24,34 @@ Copyright_License {
 #ifndef XCSOAR_DEBUG_REPLAY_IGC_HPP
 #define XCSOAR_DEBUG_REPLAY_IGC_HPP
 
-#include "DebugReplayFile.hpp"
-#include "IGC/IGCExtensions.hpp"
+#include "DebugReplay.hpp"
+#include "IGC/IGCMappedReader.hpp"
 #include "Replay/CatmullRomInterpolator.hpp"
-#include "IO/FileLineReader.hpp"
 
 struct IGCFix;
 
-class DebugReplayIGC : public DebugReplayFile {
-  IGCExtensions extensions;
+class DebugReplayIGC : public DebugReplay {
+  IGCMappedReader *reader;
   fixed virtual_time;
   CatmullRomInterpolator *cli;
 
 public:
-  DebugReplayIGC(FileLineReaderA *_reader)
-    : DebugReplayFile(_reader), virtual_time(fixed(-1)) {
-    extensions.clear();
+  DebugReplayIGC(IGCMappedReader *_reader)
+    : reader(_reader), virtual_time(fixed(-1)) {
     cli = new CatmullRomInterpolator(fixed(0.98));
     cli->Reset();
   }
   ~DebugReplayIGC() {
     delete cli;
+    delete reader;
+  }
+
+  long Size() const override {
+    return reader->GetSize();
+  }
+
+  long Tell() const override {
+    return reader->Tell();
   }
 
 public:
@@ -0,0 +1,306 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#include "FlightAnalysis.hpp"
+#include "DebugReplay.hpp"
+#include "Contest/ContestManager.hpp"
+#include "Computer/Settings.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Formatter/TimeFormatter.hpp"
+#include "JSON/Writer.hpp"
+#include "JSON/GeoWriter.hpp"
+#include "FlightPhaseJSON.hpp"
+#include "Util/StaticString.hxx"
+
+FlightAnalysis::FlightAnalysis(unsigned full_max_points,
+                               unsigned triangle_max_points,
+                               unsigned sprint_max_points)
+  :full_trace(0, Trace::null_time, full_max_points),
+   triangle_trace(0, Trace::null_time, triangle_max_points),
+   sprint_trace(0, 9000, sprint_max_points)
+{
+  olc_plus.Reset();
+  dmst.Reset();
+}
+
+void
+FlightAnalysis::Update(const MoreData &basic, const DerivedInfo &calculated)
+{
+  const FlyingState &state = calculated.flight;
+
+  if (!basic.time_available || !basic.date_time_utc.IsDatePlausible())
+    return;
+
+  if (state.flying && !events.takeoff_time.IsPlausible()) {
+    events.takeoff_time = basic.GetDateTimeAt(state.takeoff_time);
+    events.takeoff_location = state.takeoff_location;
+  }
+
+  if (!state.flying && events.takeoff_time.IsPlausible() &&
+      !events.landing_time.IsPlausible()) {
+    events.landing_time = basic.GetDateTimeAt(state.landing_time);
+    events.landing_location = state.landing_location;
+  }
+
+  if (!negative(state.release_time) && !events.release_time.IsPlausible()) {
+    events.release_time = basic.GetDateTimeAt(state.release_time);
+    events.release_location = state.release_location;
+  }
+}
+
+void
+FlightAnalysis::Finish(const MoreData &basic)
+{
+  if (!basic.time_available || !basic.date_time_utc.IsDatePlausible())
+    return;
+
+  if (events.takeoff_time.IsPlausible() &&
+      !events.landing_time.IsPlausible()) {
+    events.landing_time = basic.date_time_utc;
+
+    if (basic.location_available)
+      events.landing_location = basic.location;
+  }
+}
+
+void
+FlightAnalysis::Run(DebugReplay &replay, bool thermal_mode)
+{
+  CirclingSettings circling_settings;
+  circling_settings.SetDefaults();
+
+  WindSettings wind_settings;
+  wind_settings.SetDefaults();
+  wind_settings.user_wind_source = UserWindSource::INTERNAL_WIND;
+  wind_computer.Reset();
+
+  const GlidePolar glide_polar(fixed(0));
+
+  bool released = false;
+
+  GeoPoint last_location = GeoPoint::Invalid();
+  constexpr Angle max_longitude_change = Angle::Degrees(30);
+  constexpr Angle max_latitude_change = Angle::Degrees(1);
+
+  while (replay.Next()) {
+    circling_computer.TurnRate(replay.SetCalculated(),
+                               replay.Basic(),
+                               replay.Calculated().flight);
+    circling_computer.Turning(replay.SetCalculated(),
+                              replay.Basic(),
+                              replay.Calculated().flight,
+                              circling_settings);
+
+    wind_computer.Compute(wind_settings, glide_polar, replay.Basic(),
+                          replay.SetCalculated());
+    wind_computer.Select(wind_settings, replay.Basic(), replay.SetCalculated());
+
+    const MoreData &basic = replay.Basic();
+
+    Update(basic, replay.Calculated());
+    flight_phase_detector.Update(replay.Basic(), replay.Calculated());
+
+    if (!basic.time_available || !basic.location_available ||
+        !basic.NavAltitudeAvailable())
+      continue;
+
+    if (last_location.IsValid() &&
+        ((last_location.latitude - basic.location.latitude).Absolute() > max_latitude_change ||
+         (last_location.longitude - basic.location.longitude).Absolute() > max_longitude_change))
+      /* there was an implausible warp, which is usually triggered by
+         an invalid point declared "valid" by a bugged logger; if that
+         happens, we stop the analysis, because the IGC file is
+         obviously broken */
+      break;
+
+    last_location = basic.location;
+
+    if (!released && !negative(replay.Calculated().flight.release_time)) {
+      released = true;
+
+      full_trace.EraseEarlierThan(replay.Calculated().flight.release_time);
+      if (!thermal_mode) {
+        triangle_trace.EraseEarlierThan(replay.Calculated().flight.release_time);
+        sprint_trace.EraseEarlierThan(replay.Calculated().flight.release_time);
+      }
+    }
+
+    if (released && !replay.Calculated().flight.flying)
+      /* the aircraft has landed, stop here */
+      /* TODO: at some point, we might want to emit the analysis of
+         all flights in this IGC file */
+      break;
+
+    const TracePoint point(basic);
+    full_trace.push_back(point);
+    if (!thermal_mode) {
+      triangle_trace.push_back(point);
+      sprint_trace.push_back(point);
+    }
+  }
+
+  Update(replay.Basic(), replay.Calculated());
+  Finish(replay.Basic());
+  flight_phase_detector.Finish();
+}
+
+void
+FlightAnalysis::SolveContests()
+{
+  ContestManager olc_plus_manager(Contest::OLC_PLUS, full_trace,
+                                  triangle_trace, sprint_trace);
+  olc_plus_manager.SolveExhaustive();
+  olc_plus = olc_plus_manager.GetStats();
+
+  ContestManager dmst_manager(Contest::DMST, full_trace,
+                              triangle_trace, sprint_trace);
+  dmst_manager.SolveExhaustive();
+  dmst = dmst_manager.GetStats();
+}
+
+static void
+WriteEventAttributes(TextWriter &writer,
+                     const BrokenDateTime &time, const GeoPoint &location)
+{
+  JSON::ObjectWriter object(writer);
+
+  if (time.IsPlausible()) {
+    NarrowString<64> buffer;
+    FormatISO8601(buffer.buffer(), time);
+    object.WriteElement("time", JSON::WriteString, buffer);
+  }
+
+  if (location.IsValid())
+    JSON::WriteGeoPointAttributes(object, location);
+}
+
+static void
+WriteEvent(JSON::ObjectWriter &object, const char *name,
+           const BrokenDateTime &time, const GeoPoint &location)
+{
+  if (time.IsPlausible() || location.IsValid())
+    object.WriteElement(name, WriteEventAttributes, time, location);
+}
+
+static void
+WriteEvents(TextWriter &writer, const FlightAnalysis::Events &events)
+{
+  JSON::ObjectWriter object(writer);
+
+  WriteEvent(object, "takeoff", events.takeoff_time, events.takeoff_location);
+  WriteEvent(object, "release", events.release_time, events.release_location);
+  WriteEvent(object, "landing", events.landing_time, events.landing_location);
+}
+
+static void
+WritePoint(TextWriter &writer, const ContestTracePoint &point,
+           const ContestTracePoint *previous)
+{
+  JSON::ObjectWriter object(writer);
+
+  object.WriteElement("time", JSON::WriteLong, (long)point.GetTime());
+  JSON::WriteGeoPointAttributes(object, point.GetLocation());
+
+  if (previous != NULL) {
+    fixed distance = point.DistanceTo(previous->GetLocation());
+    object.WriteElement("distance", JSON::WriteUnsigned, uround(distance));
+
+    unsigned duration =
+      std::max((int)point.GetTime() - (int)previous->GetTime(), 0);
+    object.WriteElement("duration", JSON::WriteUnsigned, duration);
+
+    if (duration > 0) {
+      fixed speed = distance / duration;
+      object.WriteElement("speed", JSON::WriteFixed, speed);
+    }
+  }
+}
+
+static void
+WriteTrace(TextWriter &writer, const ContestTraceVector &trace)
+{
+  JSON::ArrayWriter array(writer);
+
+  const ContestTracePoint *previous = NULL;
+  for (auto i = trace.begin(), end = trace.end(); i != end; ++i) {
+    array.WriteElement(WritePoint, *i, previous);
+    previous = &*i;
+  }
+}
+
+static void
+WriteContest(TextWriter &writer,
+             const ContestResult &result, const ContestTraceVector &trace)
+{
+  JSON::ObjectWriter object(writer);
+
+  object.WriteElement("score", JSON::WriteFixed, result.score);
+  object.WriteElement("distance", JSON::WriteFixed, result.distance);
+  object.WriteElement("duration", JSON::WriteUnsigned, (unsigned)result.time);
+  object.WriteElement("speed", JSON::WriteFixed, result.GetSpeed());
+
+  object.WriteElement("turnpoints", WriteTrace, trace);
+}
+
+static void
+WriteOLCPlus(TextWriter &writer, const ContestStatistics &stats)
+{
+  JSON::ObjectWriter object(writer);
+
+  object.WriteElement("classic", WriteContest,
+                      stats.result[0], stats.solution[0]);
+  object.WriteElement("triangle", WriteContest,
+                      stats.result[1], stats.solution[1]);
+  object.WriteElement("plus", WriteContest,
+                      stats.result[2], stats.solution[2]);
+}
+
+static void
+WriteDMSt(TextWriter &writer, const ContestStatistics &stats)
+{
+  JSON::ObjectWriter object(writer);
+
+  object.WriteElement("quadrilateral", WriteContest,
+                      stats.result[0], stats.solution[0]);
+}
+
+static void
+WriteContests(TextWriter &writer, const ContestStatistics &olc_plus,
+              const ContestStatistics &dmst)
+{
+  JSON::ObjectWriter object(writer);
+
+  object.WriteElement("olc_plus", WriteOLCPlus, olc_plus);
+  object.WriteElement("dmst", WriteDMSt, dmst);
+}
+
+void
+FlightAnalysis::Write(JSON::ObjectWriter &root) const
+{
+  root.WriteElement("events", WriteEvents, events);
+  root.WriteElement("phases", WritePhaseList,
+                    flight_phase_detector.GetPhases());
+  root.WriteElement("performance", WritePerformanceStats,
+                    flight_phase_detector.GetTotals());
+  root.WriteElement("contests", WriteContests, olc_plus, dmst);
+}
@@ -0,0 +1,107 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#ifndef XCSOAR_FLIGHT_ANALYSIS_HPP
+#define XCSOAR_FLIGHT_ANALYSIS_HPP
+
+#include "Engine/Trace/Trace.hpp"
+#include "Contest/ContestStatistics.hpp"
+#include "Computer/CirclingComputer.hpp"
+#include "Computer/Wind/Computer.hpp"
+#include "FlightPhaseDetector.hpp"
+#include "Time/BrokenDateTime.hpp"
+#include "Geo/GeoPoint.hpp"
+
+class DebugReplay;
+namespace JSON { class ObjectWriter; }
+
+/**
+ * The post-flight analysis of one flight: all the computers needed
+ * to replay it, and the results.  Instances do not share any state,
+ * so several flights may be analysed concurrently.
+ */
+class FlightAnalysis {
+public:
+  struct Events {
+    BrokenDateTime takeoff_time, release_time, landing_time;
+    GeoPoint takeoff_location, release_location, landing_location;
+
+    Events() {
+      takeoff_time.Clear();
+      landing_time.Clear();
+      release_time.Clear();
+
+      takeoff_location.SetInvalid();
+      landing_location.SetInvalid();
+      release_location.SetInvalid();
+    }
+  };
+
+private:
+  WindComputer wind_computer;
+  CirclingComputer circling_computer;
+  FlightPhaseDetector flight_phase_detector;
+
+  Trace full_trace, triangle_trace, sprint_trace;
+
+  Events events;
+
+  ContestStatistics olc_plus, dmst;
+
+public:
+  FlightAnalysis(unsigned full_max_points, unsigned triangle_max_points,
+                 unsigned sprint_max_points);
+
+  /**
+   * Replay the flight until the aircraft lands.
+   *
+   * @param thermal_mode if true, then only the phases are detected,
+   * and the contest traces are not recorded
+   */
+  void Run(DebugReplay &replay, bool thermal_mode=false);
+
+  /**
+   * Find the final contest solutions.  Call after Run().
+   */
+  void SolveContests();
+
+  const Events &GetEvents() const {
+    return events;
+  }
+
+  const FlightPhaseDetector &GetPhaseDetector() const {
+    return flight_phase_detector;
+  }
+
+  /**
+   * Write the results as attributes of the given JSON object.  Call
+   * after SolveContests().
+   */
+  void Write(JSON::ObjectWriter &root) const;
+
+private:
+  void Update(const MoreData &basic, const DerivedInfo &calculated);
+  void Finish(const MoreData &basic);
+};
+
+#endif
@@ -0,0 +1,328 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Replay a flight through the complete GlideComputer as fast as
+ * possible.  The GlideComputer only sees the time stamps of the
+ * fixes, and the contest solvers run synchronously (see --contest),
+ * so the results do not depend on the speed of the machine and can
+ * be compared between runs.  The results are written to stdout and
+ * the time spent in each stage to stderr.
+ */
+
+#include "DebugReplay.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "OS/ConvertPathName.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Util/StringAPI.hxx"
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Task/TaskManager.hpp"
+#include "Engine/Task/Ordered/OrderedTask.hpp"
+#include "Computer/GlideComputer.hpp"
+#include "Computer/GlideComputerInterface.hpp"
+#include "Computer/StageTimes.hpp"
+#include "Computer/Settings.hpp"
+#include "Task/ProtectedTaskManager.hpp"
+#include "Task/TaskFile.hpp"
+#include "Operation/Operation.hpp"
+#include "Formatter/TimeFormatter.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* fake symbols: */
+
+#include "Computer/ConditionMonitor/ConditionMonitors.hpp"
+#include "Input/InputQueue.hpp"
+#include "Logger/Logger.hpp"
+#include "Components.hpp"
+#include "Simulator.hpp"
+#include "Protection.hpp"
+#include "LocalPath.hpp"
+#include "Task/SaveFile.hpp"
+#include "Waypoint/FlarmGlue.hpp"
+
+Waypoints way_points;
+ProtectedTaskManager *protected_task_manager;
+RasterTerrain *terrain;
+
+#ifdef SIMULATOR_AVAILABLE
+bool global_simulator_flag = false;
+#endif
+
+void ForceCalculation() {}
+
+/* the replay must not touch the task state files of a real
+   installation: an empty data path makes LoadTaskState() fail */
+void
+LocalPath(TCHAR *buffer, const TCHAR *file)
+{
+  *buffer = 0;
+}
+
+bool SaveTaskState(bool, bool, const OrderedTask &) { return false; }
+void RemoveTaskState() {}
+bool ProtectedTaskManager::TaskSaveDefault() { return false; }
+
+void
+FlarmWaypointGlue::AddTeammateTask(const GeoPoint &location,
+                                   const RasterTerrain *terrain,
+                                   ProtectedTaskManager *protected_task_manager,
+                                   bool non_current_flarm_lock)
+{
+}
+
+void
+ConditionMonitorsUpdate(const NMEAInfo &basic, const DerivedInfo &calculated,
+                        const ComputerSettings &settings)
+{
+}
+
+bool InputEvents::processGlideComputer(unsigned) { return false; }
+void Logger::LogStartEvent(const NMEAInfo &gps_info) {}
+void Logger::LogFinishEvent(const NMEAInfo &gps_info) {}
+void Logger::LogPoint(const NMEAInfo &gps_info) {}
+
+/* done with fake symbols. */
+
+static bool
+LoadAirspace(Airspaces &airspaces, const char *path)
+{
+  FileLineReader reader(path, Charset::AUTO);
+  if (reader.error()) {
+    fprintf(stderr, "Failed to open %s\n", path);
+    return false;
+  }
+
+  NullOperationEnvironment operation;
+  AirspaceParser parser(airspaces);
+  if (!parser.Parse(reader, operation)) {
+    fprintf(stderr, "Failed to parse %s\n", path);
+    return false;
+  }
+
+  airspaces.Optimise();
+  return true;
+}
+
+static void
+PrintTime(const char *name, fixed time)
+{
+  TCHAR buffer[32];
+  FormatTime(buffer, time);
+  _tprintf(_T("%s: %s\n"), name, buffer);
+}
+
+static void
+PrintResults(const DerivedInfo &calculated, unsigned n_warnings)
+{
+  const FlyingState &flight = calculated.flight;
+  if (!negative(flight.takeoff_time))
+    PrintTime("takeoff", flight.takeoff_time);
+  if (!negative(flight.landing_time))
+    PrintTime("landing", flight.landing_time);
+  PrintTime("flight_time", flight.flight_time);
+
+  const TaskStats &task = calculated.ordered_task_stats;
+  if (task.task_valid) {
+    printf("task_started: %d\n", task.start.task_started);
+    printf("task_finished: %d\n", task.task_finished);
+    printf("task_distance_scored: %.0f\n", (double)task.distance_scored);
+  }
+
+  for (unsigned i = 0; i < 3; ++i) {
+    const ContestResult &result = calculated.contest_stats.GetResult(i);
+    if (!result.IsDefined())
+      continue;
+
+    printf("contest[%u]: score=%.2f distance=%.0f speed=%.2f\n", i,
+           (double)result.score, (double)result.distance,
+           (double)result.GetSpeed());
+  }
+
+  printf("airspace_warnings: %u\n", n_warnings);
+}
+
+static void
+PrintStageTimes(const GlideComputerStageTimes &stage_times,
+                unsigned n_fixes, uint64_t gps_us, uint64_t idle_us)
+{
+  fprintf(stderr, "%-14s %8s %10s %10s\n", "stage", "calls", "ms", "us/call");
+
+  for (unsigned i = 0; i < GlideComputerStageTimes::N; ++i) {
+    const GlideComputerStage stage = GlideComputerStage(i);
+    const unsigned count = stage_times.GetCount(stage);
+    const uint64_t duration = stage_times.GetDuration(stage);
+    fprintf(stderr, "%-14s %8u %10.1f %10.2f\n",
+            GlideComputerStageTimes::GetName(stage), count,
+            duration / 1000., count > 0 ? double(duration) / count : 0.);
+  }
+
+  fprintf(stderr, "%-14s %8u %10.1f %10.2f\n", "ProcessGPS", n_fixes,
+          gps_us / 1000., n_fixes > 0 ? double(gps_us) / n_fixes : 0.);
+  fprintf(stderr, "%-14s %8s %10.1f\n", "ProcessIdle", "",
+          idle_us / 1000.);
+}
+
+int main(int argc, char **argv)
+{
+  const char *task_path = nullptr, *airspace_path = nullptr;
+  unsigned idle_interval = 1, contest_interval = 300;
+
+  Args args(argc, argv,
+            "[options] DRIVER FILE\n"
+            "Options:\n"
+            "  --task=FILE       Load this task before the flight\n"
+            "  --airspace=FILE   Load airspaces for the warning computer\n"
+            "  --idle=N          Call ProcessIdle() after every Nth fix (default = 1)\n"
+            "  --contest=N       Solve the contest in every Nth ProcessIdle() call (default = 300)");
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && arg[0] == '-' && arg[1] == '-') {
+    args.Skip();
+
+    const char *value;
+    if ((value = StringAfterPrefix(arg, "--task=")) != nullptr)
+      task_path = value;
+    else if ((value = StringAfterPrefix(arg, "--airspace=")) != nullptr)
+      airspace_path = value;
+    else if ((value = StringAfterPrefix(arg, "--idle=")) != nullptr)
+      idle_interval = args.ParsePositive(value);
+    else if ((value = StringAfterPrefix(arg, "--contest=")) != nullptr)
+      contest_interval = args.ParsePositive(value);
+    else
+      args.UsageError();
+  }
+
+  DebugReplay *replay = CreateDebugReplay(args);
+  if (replay == nullptr)
+    return EXIT_FAILURE;
+
+  args.ExpectEnd();
+
+  ComputerSettings settings;
+  settings.SetDefaults();
+  settings.polar.glide_polar_task = GlidePolar(fixed(1));
+  settings.contest.enable = true;
+
+  Airspaces airspace_database;
+  if (airspace_path != nullptr &&
+      !LoadAirspace(airspace_database, airspace_path))
+    return EXIT_FAILURE;
+
+  TaskManager task_manager(settings.task, way_points);
+  task_manager.SetGlidePolar(settings.polar.glide_polar_task);
+
+  GlideComputerTaskEvents task_events;
+  task_manager.SetTaskEvents(task_events);
+
+  ProtectedTaskManager task_glue(task_manager, settings.task);
+  protected_task_manager = &task_glue;
+
+  if (task_path != nullptr) {
+    OrderedTask *task = TaskFile::GetTask(PathName(task_path), settings.task,
+                                          &way_points, 0);
+    if (task == nullptr) {
+      fprintf(stderr, "Failed to load task %s\n", task_path);
+      return EXIT_FAILURE;
+    }
+
+    task_glue.TaskCommit(*task);
+    delete task;
+  }
+
+  GlideComputer glide_computer(way_points, airspace_database,
+                               task_glue,
+                               task_events);
+  glide_computer.ReadComputerSettings(settings);
+  glide_computer.SetTerrain(nullptr);
+  glide_computer.SetContestSynchronous(contest_interval);
+  glide_computer.Initialise();
+
+  GlideComputerStageTimes stage_times;
+  stage_times.Clear();
+  glide_computer.SetStageTimes(&stage_times);
+
+  unsigned n_fixes = 0, n_warnings = 0, idle_counter = 0;
+  uint64_t gps_us = 0, idle_us = 0;
+  Validity last_warning;
+  last_warning.Clear();
+  fixed first_time(-1), last_time(-1);
+
+  const uint64_t start_us = MonotonicClockUS();
+
+  while (replay->Next()) {
+    const MoreData &basic = replay->Basic();
+    if (basic.time_available) {
+      if (negative(first_time))
+        first_time = basic.time;
+      last_time = basic.time;
+    }
+
+    glide_computer.ReadBlackboard(basic);
+
+    uint64_t t = MonotonicClockUS();
+    glide_computer.ProcessGPS();
+    gps_us += MonotonicClockUS() - t;
+    ++n_fixes;
+
+    if (++idle_counter == idle_interval) {
+      idle_counter = 0;
+
+      t = MonotonicClockUS();
+      glide_computer.ProcessIdle();
+      idle_us += MonotonicClockUS() - t;
+    }
+
+    const Validity &latest = glide_computer.Calculated().airspace_warnings.latest;
+    if (latest.Modified(last_warning)) {
+      ++n_warnings;
+      last_warning = latest;
+    }
+  }
+
+  uint64_t t = MonotonicClockUS();
+  glide_computer.ProcessExhaustive();
+  idle_us += MonotonicClockUS() - t;
+
+  const uint64_t duration_us = MonotonicClockUS() - start_us;
+
+  delete replay;
+  protected_task_manager = nullptr;
+
+  printf("fixes: %u\n", n_fixes);
+  PrintResults(glide_computer.Calculated(), n_warnings);
+
+  PrintStageTimes(stage_times, n_fixes, gps_us, idle_us);
+
+  const double wall = duration_us / 1000000.;
+  const double flight = negative(first_time)
+    ? 0.
+    : double(last_time - first_time);
+  fprintf(stderr, "replayed %.0f s of flight in %.3f s (%.0fx real time)\n",
+          flight, wall, wall > 0 ? flight / wall : 0.);
+
+  return EXIT_SUCCESS;
+}
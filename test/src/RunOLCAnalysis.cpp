@@ -25,6 +25,9 @@
 #include "Printing.hpp"
 #include "OS/Args.hpp"
 #include "DebugReplay.hpp"
+#include "Thread/ThreadPool.hpp"
+#include "Time/PeriodClock.hpp"
+#include "Util/Macros.hpp"
 
 #include <assert.h>
 #include <stdio.h>
@@ -61,8 +64,17 @@ static ContestManager sis_at(Contest::SIS_AT,
 static ContestManager olc_netcoupe(Contest::NET_COUPE,
                                    full_trace, triangle_trace, sprint_trace);
 
+/**
+ * The managers which are solved exhaustively at the end; the sprint
+ * results are taken from the incremental solver.
+ */
+static ContestManager *const exhaustive_managers[] = {
+  &olc_classic, &olc_fai, &olc_league, &olc_plus,
+  &dmst, &xcontest, &sis_at, &olc_netcoupe,
+};
+
 static int
-TestOLC(DebugReplay &replay)
+TestOLC(DebugReplay &replay, ThreadPool &pool)
 {
   bool released = false;
 
@@ -94,17 +106,22 @@ TestOLC(DebugReplay &replay)
     olc_league.UpdateIdle();
   }
 
-  olc_classic.SolveExhaustive();
-  olc_fai.SolveExhaustive();
-  olc_league.SolveExhaustive();
-  olc_plus.SolveExhaustive();
-  dmst.SolveExhaustive();
-  xcontest.SolveExhaustive();
-  sis_at.SolveExhaustive();
-  olc_netcoupe.SolveExhaustive();
+  /* the managers share only the (now constant) traces, so they can
+     be solved concurrently */
+  PeriodClock clock;
+  clock.Update();
+
+  pool.ForEach(ARRAY_SIZE(exhaustive_managers), [](unsigned i){
+      exhaustive_managers[i]->SolveExhaustive();
+    });
+
+  const int elapsed = clock.Elapsed();
 
   putchar('\n');
 
+  std::cout << "# exhaustive solve: " << elapsed << " ms, "
+            << pool.GetConcurrency() << " thread(s)\n";
+
   std::cout << "classic\n";
   PrintHelper::print(olc_classic.GetStats().GetResult());
   std::cout << "league\n";
@@ -162,7 +179,11 @@ int main(int argc, char **argv)
 
   args.ExpectEnd();
 
-  int result = TestOLC(*replay);
+  ThreadPool pool(ThreadPool::GetDefaultWorkers(ARRAY_SIZE(exhaustive_managers)));
+  for (ContestManager *manager : exhaustive_managers)
+    manager->SetExecutor(&pool);
+
+  int result = TestOLC(*replay, pool);
   delete replay;
   return result;
 }
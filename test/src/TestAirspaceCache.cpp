@@ -0,0 +1,288 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Airspace/AirspaceCache.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "IO/FileCache.hpp"
+#include "IO/FileLineReader.hpp"
+#include "OS/FileUtil.hpp"
+#include "Operation/Operation.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <tchar.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+
+typedef std::vector<const AbstractAirspace *> AirspaceList;
+
+static bool
+ParseFile(const TCHAR *path, Airspaces &airspaces, AirspaceList &added)
+{
+  FileLineReader reader(path, Charset::AUTO);
+  if (reader.error())
+    return false;
+
+  AirspaceParser parser(airspaces);
+  NullOperationEnvironment operation;
+  return parser.Parse(reader, operation, &added);
+}
+
+static bool
+Save(const TCHAR *path, const AirspaceList &airspaces,
+     std::vector<char> &data)
+{
+  FILE *file = tmpfile();
+  if (file == nullptr)
+    return false;
+
+  bool success = SaveAirspaceCache(file, path, airspaces);
+  if (success) {
+    data.resize(ftell(file));
+    rewind(file);
+    success = fread(&data.front(), 1, data.size(), file) == data.size();
+  }
+
+  fclose(file);
+  return success;
+}
+
+static void
+Append(std::string &s, const char *format, double value)
+{
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), format, value);
+  s += buffer;
+}
+
+static void
+Append(std::string &s, const AirspaceAltitude &altitude)
+{
+  Append(s, " %a", (double)altitude.altitude);
+  Append(s, " %a", (double)altitude.flight_level);
+  Append(s, " %a", (double)altitude.altitude_above_terrain);
+  Append(s, " %g", (int)altitude.reference);
+}
+
+/**
+ * All properties of the airspace which are stored in the cache, with
+ * exact floating point values.
+ */
+static std::string
+Describe(const AbstractAirspace &airspace)
+{
+  std::string s = airspace.GetName();
+  s += '|';
+  s += airspace.GetRadioText();
+  Append(s, " %g", airspace.GetType());
+  Append(s, " %g", airspace.GetDays().GetRawMask());
+  Append(s, " %g", (int)airspace.GetShape());
+  Append(s, airspace.GetBase());
+  Append(s, airspace.GetTop());
+
+  if (airspace.GetShape() == AbstractAirspace::Shape::CIRCLE) {
+    const AirspaceCircle &circle = (const AirspaceCircle &)airspace;
+    Append(s, " %a", (double)circle.GetCenter().longitude.Native());
+    Append(s, " %a", (double)circle.GetCenter().latitude.Native());
+    Append(s, " %a", (double)circle.GetRadius());
+  }
+
+  for (const auto &i : airspace.GetPoints()) {
+    Append(s, " %a", (double)i.GetLocation().longitude.Native());
+    Append(s, " %a", (double)i.GetLocation().latitude.Native());
+  }
+
+  return s;
+}
+
+static std::vector<std::string>
+Describe(const AirspaceList &airspaces)
+{
+  std::vector<std::string> result;
+  for (const auto *i : airspaces)
+    result.push_back(Describe(*i));
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+static std::vector<std::string>
+Describe(const Airspaces &airspaces)
+{
+  AirspaceList list;
+  for (const auto &i : airspaces)
+    list.push_back(&i.GetAirspace());
+  return Describe(list);
+}
+
+static void
+TestRoundTrip(const TCHAR *path)
+{
+  Airspaces parsed;
+  AirspaceList added;
+  ok1(ParseFile(path, parsed, added));
+
+  std::vector<char> data;
+  ok1(Save(path, added, data));
+
+  Airspaces loaded;
+  ok1(LoadAirspaceCache(data.data(), data.size(), path, loaded));
+  loaded.Optimise();
+
+  ok1(Describe(added) == Describe(loaded));
+}
+
+static void
+TestInvalid()
+{
+  const TCHAR *path = _T("test/data/airspace/openair.txt");
+
+  Airspaces parsed;
+  AirspaceList added;
+  std::vector<char> data;
+  if (!ParseFile(path, parsed, added) || !Save(path, added, data)) {
+    skip(4, 0, "Failed to create cache");
+    return;
+  }
+
+  Airspaces loaded;
+
+  /* the cache belongs to a different file */
+  ok1(!LoadAirspaceCache(data.data(), data.size(),
+                         _T("test/data/airspace/tnp.sua"), loaded));
+
+  /* truncated */
+  bool rejected = true;
+  for (size_t size = 0; size < data.size(); size += 1 + size / 8)
+    if (LoadAirspaceCache(data.data(), size, path, loaded))
+      rejected = false;
+  ok1(rejected);
+
+  /* another version */
+  std::vector<char> other = data;
+  ++other[0];
+  ok1(!LoadAirspaceCache(other.data(), other.size(), path, loaded));
+
+  /* nothing has been added by the failed attempts */
+  ok1(loaded.IsEmpty());
+}
+
+static bool
+CopyFile(const char *src, const char *dest)
+{
+  FILE *in = fopen(src, "rb");
+  if (in == nullptr)
+    return false;
+
+  FILE *out = fopen(dest, "wb");
+  if (out == nullptr) {
+    fclose(in);
+    return false;
+  }
+
+  char buffer[4096];
+  size_t n;
+  bool success = true;
+  while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0)
+    if (fwrite(buffer, 1, n, out) != n)
+      success = false;
+
+  fclose(in);
+  return fclose(out) == 0 && success;
+}
+
+/**
+ * Store the cache in a #FileCache and map it again, like
+ * ReadAirspace() does.  The payload follows the #FileCache header
+ * and is therefore not 8-byte aligned in the mapping.
+ */
+static void
+TestFileCache()
+{
+  char dir[] = "/tmp/TestAirspaceCache.XXXXXX";
+  if (mkdtemp(dir) == nullptr) {
+    skip(7, 0, "Failed to create directory");
+    return;
+  }
+
+  const std::string path = std::string(dir) + "/openair.txt";
+  const std::string cache_path = std::string(dir) + "/airspace.cache";
+  const TCHAR *cache_name = _T("airspace.cache");
+
+  Airspaces parsed;
+  AirspaceList added;
+  if (!CopyFile("test/data/airspace/openair.txt", path.c_str()) ||
+      !ParseFile(path.c_str(), parsed, added)) {
+    skip(7, 0, "Failed to parse airspace file");
+    return;
+  }
+
+  FileCache cache(dir);
+
+  /* nothing stored yet */
+  Airspaces loaded;
+  ok1(!LoadAirspaceCacheFile(cache, cache_name, path.c_str(), loaded));
+
+  SaveAirspaceCacheFile(cache, cache_name, path.c_str(), added);
+  ok1(File::Exists(cache_path.c_str()));
+
+  ok1(LoadAirspaceCacheFile(cache, cache_name, path.c_str(), loaded));
+  loaded.Optimise();
+  ok1(Describe(added) == Describe(loaded));
+
+  /* the airspace file has been replaced; its modification time
+     differs from the one recorded in the cache */
+  struct utimbuf times;
+  times.actime = times.modtime = time(nullptr) - 3600;
+  ok1(utime(path.c_str(), &times) == 0);
+
+  Airspaces stale;
+  ok1(!LoadAirspaceCacheFile(cache, cache_name, path.c_str(), stale) &&
+      stale.IsEmpty());
+
+  /* the stale entry has been deleted */
+  ok1(!File::Exists(cache_path.c_str()));
+
+  unlink(path.c_str());
+  rmdir(dir);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(23);
+
+  TestRoundTrip(_T("test/data/airspace/openair.txt"));
+  TestRoundTrip(_T("test/data/airspace/tnp.sua"));
+  TestRoundTrip(_T("test/data/AirspaceAus-DAA.txt"));
+  TestInvalid();
+  TestFileCache();
+
+  return exit_status();
+}
@@ -0,0 +1,279 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Compares the pre-filtered queries of #Airspaces with a brute force
+ * search which checks the altitudes and the activity of every
+ * airspace the unfiltered queries return.
+ */
+
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceVisitor.hpp"
+#include "Engine/Airspace/AirspaceIntersectionVisitor.hpp"
+#include "Navigation/Aircraft.hpp"
+#include "Geo/GeoVector.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <stdlib.h>
+
+typedef std::vector<const AbstractAirspace *> AirspaceList;
+
+static const GeoPoint origin(Angle::Degrees(7), Angle::Degrees(51));
+static constexpr double extent = 2;
+
+static GeoPoint
+RandomLocation()
+{
+  return GeoPoint(origin.longitude +
+                  Angle::Degrees(extent * (rand() % 10000) / 10000.),
+                  origin.latitude +
+                  Angle::Degrees(extent * (rand() % 10000) / 10000.));
+}
+
+static AirspaceAltitude
+RandomAltitude(int min, int max)
+{
+  AirspaceAltitude altitude;
+  const int value = min + rand() % (max - min);
+
+  switch (rand() % 3) {
+  case 0:
+    altitude.reference = AltitudeReference::MSL;
+    altitude.altitude = fixed(value);
+    break;
+
+  case 1:
+    altitude.reference = AltitudeReference::AGL;
+    altitude.altitude_above_terrain = rand() % 4 == 0
+      ? fixed(0)
+      : fixed(value / 2);
+    break;
+
+  default:
+    altitude.reference = AltitudeReference::STD;
+    altitude.flight_level = fixed(value / 30);
+    break;
+  }
+
+  return altitude;
+}
+
+static AbstractAirspace *
+RandomAirspace()
+{
+  const GeoPoint center = RandomLocation();
+  const fixed radius(1000 + rand() % 15000);
+
+  AbstractAirspace *airspace;
+  if (rand() % 2 == 0)
+    airspace = new AirspaceCircle(center, radius);
+  else {
+    std::vector<GeoPoint> points;
+    const unsigned n = 4 + rand() % 20;
+    for (unsigned i = 0; i < n; ++i)
+      points.push_back(GeoVector(radius * fixed(0.5 + (rand() % 100) / 200.),
+                                 Angle::FullCircle() * i / n)
+                       .EndPoint(center));
+
+    airspace = new AirspacePolygon(points);
+  }
+
+  const AirspaceAltitude base = RandomAltitude(0, 3000);
+  const AirspaceAltitude top = RandomAltitude(1000, 6000);
+  airspace->SetProperties(_T("test"), CTR, base, top);
+
+  if (rand() % 4 == 0)
+    airspace->SetDays(AirspaceActivity(rand() % 7));
+
+  return airspace;
+}
+
+static AircraftState
+RandomState()
+{
+  AircraftState state;
+  state.location = RandomLocation();
+  state.altitude = fixed(rand() % 5000);
+  /* sometimes negative, see AirspaceAltitude::IsBelow() */
+  state.altitude_agl = state.altitude - fixed(rand() % 1500 - 50);
+  return state;
+}
+
+class ListVisitor final : public AirspaceVisitor {
+public:
+  AirspaceList result;
+
+  void Visit(const AbstractAirspace &airspace) override {
+    result.push_back(&airspace);
+  }
+};
+
+class ListIntersectionVisitor final : public AirspaceIntersectionVisitor {
+public:
+  AirspaceList result;
+
+  void Visit(const AbstractAirspace &airspace) override {
+    result.push_back(&airspace);
+  }
+};
+
+static AirspaceList
+Sorted(AirspaceList list)
+{
+  std::sort(list.begin(), list.end());
+  return list;
+}
+
+static AirspaceList
+Sorted(const Airspaces::AirspaceVector &v)
+{
+  AirspaceList list;
+  for (const auto &i : v)
+    list.push_back(&i.GetAirspace());
+  return Sorted(list);
+}
+
+static AirspaceList
+Below(const AirspaceList &list, const AltitudeState &state, fixed ceiling)
+{
+  AirspaceList result;
+  for (auto i : list)
+    if (i->IsActive() && i->GetBaseAltitude(state) <= ceiling)
+      result.push_back(i);
+  return Sorted(result);
+}
+
+static bool
+CheckInside(const Airspaces &airspaces)
+{
+  for (unsigned i = 0; i < 500; ++i) {
+    const AircraftState state = RandomState();
+
+    AirspaceList expected;
+    for (const auto &j : airspaces)
+      if (j.GetAirspace().Inside(state))
+        expected.push_back(&j.GetAirspace());
+
+    if (Sorted(airspaces.FindInside(state)) != Sorted(expected))
+      return false;
+  }
+
+  return true;
+}
+
+static bool
+CheckIntersecting(const Airspaces &airspaces)
+{
+  for (unsigned i = 0; i < 500; ++i) {
+    const AircraftState state = RandomState();
+    const GeoPoint end = GeoVector(fixed(1000 + rand() % 30000),
+                                   Angle::Degrees(rand() % 360))
+      .EndPoint(state.location);
+    const fixed ceiling = state.altitude + fixed(1000);
+
+    ListIntersectionVisitor all, filtered;
+    airspaces.VisitIntersecting(state.location, end, all);
+    airspaces.VisitIntersecting(state.location, end, state, ceiling,
+                                filtered);
+
+    if (Sorted(filtered.result) != Below(all.result, state, ceiling))
+      return false;
+  }
+
+  return true;
+}
+
+static bool
+CheckVisitInside(const Airspaces &airspaces)
+{
+  for (unsigned i = 0; i < 500; ++i) {
+    const AircraftState state = RandomState();
+    const fixed ceiling = state.altitude + fixed(1000);
+
+    ListVisitor all, filtered;
+    airspaces.VisitInside(state.location, all);
+    airspaces.VisitInside(state.location, state, ceiling, filtered);
+
+    if (Sorted(filtered.result) != Below(all.result, state, ceiling))
+      return false;
+  }
+
+  return true;
+}
+
+static void
+Check(const Airspaces &airspaces)
+{
+  ok1(CheckInside(airspaces));
+  ok1(CheckIntersecting(airspaces));
+  ok1(CheckVisitInside(airspaces));
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(21);
+
+  srand(1);
+
+  Airspaces airspaces;
+  for (unsigned i = 0; i < 2000; ++i)
+    airspaces.Add(RandomAirspace());
+
+  airspaces.Optimise();
+  airspaces.SetFlightLevels(AtmosphericPressure::Standard());
+  airspaces.SetActivity(AirspaceActivity(1));
+  ok1(airspaces.GetSize() == 2000);
+  Check(airspaces);
+
+  /* the table must follow QNH and activity changes */
+  airspaces.SetFlightLevels(AtmosphericPressure::HectoPascal(fixed(985)));
+  airspaces.SetActivity(AirspaceActivity(4));
+  Check(airspaces);
+
+  /* a local copy, updated incrementally */
+  Airspaces local(false);
+  local.SynchroniseInRange(airspaces, origin, fixed(50000));
+  ok1(!local.IsEmpty());
+  Check(local);
+
+  local.SynchroniseInRange(airspaces, RandomLocation(), fixed(80000));
+  Check(local);
+
+  /* the master's QNH changes the shared airspace objects */
+  airspaces.SetFlightLevels(AtmosphericPressure::HectoPascal(fixed(1030)));
+  local.SynchroniseInRange(airspaces, RandomLocation(), fixed(80000));
+  Check(local);
+
+  /* ... even if the contents of the local copy remain the same */
+  const GeoPoint location = RandomLocation();
+  local.SynchroniseInRange(airspaces, location, fixed(80000));
+  airspaces.SetFlightLevels(AtmosphericPressure::HectoPascal(fixed(1000)));
+  ok1(!local.SynchroniseInRange(airspaces, location, fixed(80000)));
+  Check(local);
+
+  return exit_status();
+}
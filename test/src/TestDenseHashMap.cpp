@@ -0,0 +1,114 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Util/DenseHashMap.hpp"
+#include "TestUtil.hpp"
+
+/**
+ * A bad hash function which makes all keys collide in groups of 16,
+ * to exercise the linear probing.
+ */
+struct BadHash {
+  unsigned operator()(unsigned key) const {
+    return key / 16;
+  }
+};
+
+typedef DenseHashMap<unsigned, unsigned, BadHash> Map;
+
+static bool
+CheckAll(const Map &map, unsigned n)
+{
+  if (map.size() != n)
+    return false;
+
+  for (unsigned i = 0; i < n; ++i) {
+    const auto index = map.find(i * 3);
+    if (index == Map::NONE || map[index].key != i * 3 ||
+        map[index].value != i)
+      return false;
+
+    if (map.find(i * 3 + 1) != Map::NONE)
+      return false;
+  }
+
+  return true;
+}
+
+static void
+Fill(Map &map, unsigned n)
+{
+  for (unsigned i = 0; i < n; ++i)
+    map.insert(i * 3, i);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(20);
+
+  Map map;
+  ok1(map.empty());
+  ok1(map.find(42) == Map::NONE);
+
+  auto result = map.insert(42, 1);
+  ok1(result.second);
+  ok1(result.first == 0);
+  ok1(map.size() == 1);
+
+  /* an existing key is not overwritten */
+  result = map.insert(42, 2);
+  ok1(!result.second);
+  ok1(result.first == 0);
+  ok1(map[0].value == 1);
+
+  /* modify the value in place */
+  map[map.find(42)].value = 3;
+  ok1(map[map.find(42)].value == 3);
+
+  /* grow over several rehashes */
+  map.clear();
+  ok1(map.empty());
+  ok1(map.find(42) == Map::NONE);
+  Fill(map, 1000);
+  ok1(CheckAll(map, 1000));
+
+  /* indices are stable across rehashes */
+  ok1(map.find(999 * 3) == 999);
+
+  /* sparse clear erases only the used slots */
+  map.clear();
+  Fill(map, 10);
+  ok1(CheckAll(map, 10));
+  map.clear();
+  ok1(map.find(0) == Map::NONE);
+  Fill(map, 500);
+  ok1(CheckAll(map, 500));
+
+  DenseHashSet<unsigned> set(16);
+  ok1(set.insert(7));
+  ok1(!set.insert(7));
+  ok1(set.contains(7) && !set.contains(8));
+  set.clear();
+  ok1(!set.contains(7) && set.empty());
+
+  return exit_status();
+}
@@ -172,6 +172,35 @@ TestFix()
   ok1(fix.gps_altitude == 7);
 }
 
+static void
+TestFixInPlace()
+{
+  IGCExtensions extensions;
+  extensions.clear();
+  ok1(IGCParseExtensions("I023638FXA3940SIU", extensions));
+
+  /* two records back to back, as found in a mapped file; the
+     length-based parser must not look beyond the first line */
+  static constexpr char buffer[] =
+    "B1122385103117N00742367EA-001200487003\r\n"
+    "B1122395103117N00742367EA0049000487";
+  const size_t length = strchr(buffer, '\r') - buffer;
+
+  IGCFix fix;
+  ok1(!IGCParseFix(buffer, 34, extensions, fix));
+  ok1(IGCParseFix(buffer, length, extensions, fix));
+  ok1(fix.time == BrokenTime(11, 22, 38));
+  ok1(equals(fix.location, 51.05195, 7.70611667));
+  ok1(fix.pressure_altitude == -12);
+  ok1(fix.gps_altitude == 487);
+  ok1(fix.siu == -1);
+
+  ok1(IGCParseFix(buffer + length + 2, sizeof(buffer) - length - 3,
+                  extensions, fix));
+  ok1(fix.time == BrokenTime(11, 22, 39));
+  ok1(fix.pressure_altitude == 490);
+}
+
 static void
 TestFixTime()
 {
@@ -252,13 +281,14 @@ TestDeclarationTurnpoint()
 
 int main(int argc, char **argv)
 {
-  plan_tests(136);
+  plan_tests(147);
 
   TestHeader();
   TestDate();
   TestLocation();
   TestExtensions();
   TestFix();
+  TestFixInPlace();
   TestFixTime();
   TestDeclarationHeader();
   TestDeclarationTurnpoint();
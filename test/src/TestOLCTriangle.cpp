@@ -0,0 +1,134 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Engine/Contest/Solvers/OLCTriangle.hpp"
+#include "Engine/Contest/Solvers/OLCFAI.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "IGC/IGCParser.hpp"
+#include "IGC/IGCFix.hpp"
+#include "IGC/IGCExtensions.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Thread/ThreadPool.hpp"
+#include "TestUtil.hpp"
+#include "Util/Macros.hpp"
+
+static const char *const igc_files[] = {
+  "test/data/01lz1hq1.igc",
+  "test/data/0asljd01.igc",
+  "test/data/9crx3101.igc",
+  "test/data/apf-bug554.igc",
+};
+
+static bool
+LoadTrace(const char *filename, Trace &trace)
+{
+  FileLineReaderA reader(filename);
+  if (reader.error())
+    return false;
+
+  IGCExtensions extensions;
+  extensions.clear();
+
+  char *line;
+  while ((line = reader.ReadLine()) != NULL) {
+    IGCFix fix;
+    if (IGCParseFix(line, extensions, fix) && fix.gps_valid)
+      trace.push_back(TracePoint(fix.location, fix.time.GetSecondOfDay(),
+                                 fixed(fix.gps_altitude), fixed(0), 0));
+  }
+
+  return !trace.empty();
+}
+
+/**
+ * Run the solver until the exhaustive search has finished.
+ */
+static void
+SolveExhaustive(OLCTriangle &solver)
+{
+  for (unsigned i = 0; i < 100; ++i)
+    if (solver.Solve(true) == SolverResult::FAILED)
+      break;
+}
+
+static bool
+IsSameSolution(const AbstractContest &a, const AbstractContest &b)
+{
+  const ContestTraceVector &sa = a.GetBestSolution();
+  const ContestTraceVector &sb = b.GetBestSolution();
+  if (sa.size() != sb.size())
+    return false;
+
+  for (unsigned i = 0; i < sa.size(); ++i)
+    if (sa[i].GetTime() != sb[i].GetTime())
+      return false;
+
+  return true;
+}
+
+/**
+ * Solve the triangle in the calling thread and with the #ThreadPool,
+ * and check that both find the same one.
+ */
+static void
+TestSerialParallel(ParallelExecutor &executor,
+                   OLCTriangle &serial, OLCTriangle &parallel)
+{
+  serial.Reset();
+  parallel.Reset();
+  parallel.SetExecutor(&executor);
+
+  SolveExhaustive(serial);
+  SolveExhaustive(parallel);
+
+  ok1(serial.GetBestResult().score > fixed(0));
+  ok1(serial.GetBestResult().distance == parallel.GetBestResult().distance);
+  ok1(IsSameSolution(serial, parallel));
+}
+
+static void
+TestFile(const char *filename, ParallelExecutor &executor)
+{
+  Trace trace(0, Trace::null_time, 1024);
+  if (!LoadTrace(filename, trace)) {
+    skip(6, 0, "Failed to load IGC file");
+    return;
+  }
+
+  OLCTriangle serial(trace, false, false), parallel(trace, false, false);
+  TestSerialParallel(executor, serial, parallel);
+
+  OLCFAI serial_fai(trace, false), parallel_fai(trace, false);
+  TestSerialParallel(executor, serial_fai, parallel_fai);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(6 * ARRAY_SIZE(igc_files));
+
+  ThreadPool pool(4);
+
+  for (const char *i : igc_files)
+    TestFile(i, pool);
+
+  return exit_status();
+}
@@ -0,0 +1,199 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Geo/Flat/PackedRTree.hpp"
+#include "Util/Macros.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <stdlib.h>
+
+struct Item : FlatBoundingBox {
+  unsigned id;
+
+  Item(const FlatBoundingBox &box, unsigned _id)
+    :FlatBoundingBox(box), id(_id) {}
+
+  bool operator==(const Item &other) const {
+    return id == other.id;
+  }
+};
+
+static FlatBoundingBox
+RandomBox(int extent, int max_size)
+{
+  const FlatGeoPoint ll(rand() % extent - extent / 2,
+                        rand() % extent - extent / 2);
+  return FlatBoundingBox(ll, FlatGeoPoint(ll.longitude + rand() % max_size,
+                                          ll.latitude + rand() % max_size));
+}
+
+static std::vector<unsigned>
+Query(const PackedRTree<Item> &tree, const FlatBoundingBox &box)
+{
+  std::vector<unsigned> result;
+  tree.VisitOverlapping(box, [&result](const Item &item) {
+      result.push_back(item.id);
+    });
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+static std::vector<unsigned>
+QuerySlots(const PackedRTree<Item> &tree, const FlatBoundingBox &box)
+{
+  std::vector<unsigned> result;
+  tree.VisitOverlappingSlots(box, [&](unsigned first, unsigned last) {
+      for (unsigned i = first; i < last; ++i)
+        if (!tree.IsRemoved(i) && tree.GetSlot(i).Overlaps(box))
+          result.push_back(tree.GetSlot(i).id);
+    });
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+static std::vector<unsigned>
+Query(const std::vector<Item> &items, const FlatBoundingBox &box)
+{
+  std::vector<unsigned> result;
+  for (const auto &i : items)
+    if (i.Overlaps(box))
+      result.push_back(i.id);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+static std::vector<unsigned>
+Contents(const PackedRTree<Item> &tree)
+{
+  std::vector<unsigned> result;
+  for (const auto &i : tree)
+    result.push_back(i.id);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+static std::vector<unsigned>
+Contents(const std::vector<Item> &items)
+{
+  std::vector<unsigned> result;
+  for (const auto &i : items)
+    result.push_back(i.id);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+/**
+ * Compare the tree with a brute force search.
+ */
+static bool
+Check(const PackedRTree<Item> &tree, const std::vector<Item> &items)
+{
+  if (tree.size() != items.size() || tree.empty() != items.empty() ||
+      Contents(tree) != Contents(items))
+    return false;
+
+  for (unsigned i = 0; i < 200; ++i) {
+    const FlatBoundingBox box = RandomBox(100000, 20000);
+    const std::vector<unsigned> expected = Query(items, box);
+    if (Query(tree, box) != expected || QuerySlots(tree, box) != expected)
+      return false;
+  }
+
+  /* touching edges count as overlap */
+  for (unsigned i = 0; i < std::min(20u, unsigned(items.size())); ++i) {
+    const FlatGeoPoint &ur = items[i].GetUpperRight();
+    if (Query(tree, FlatBoundingBox(ur, ur)) !=
+        Query(items, FlatBoundingBox(ur, ur)))
+      return false;
+  }
+
+  return true;
+}
+
+static void
+TestTree(unsigned n)
+{
+  std::vector<Item> items;
+  PackedRTree<Item> tree;
+
+  for (unsigned i = 0; i < n; ++i) {
+    items.emplace_back(RandomBox(100000, 5000), i);
+    tree.Insert(items.back());
+  }
+
+  /* unoptimised: everything is in the overflow list */
+  ok1(Check(tree, items));
+
+  tree.Optimise();
+  ok1(Check(tree, items));
+
+  /* remove a third, add some more */
+  unsigned not_found = 0;
+  for (unsigned i = 0; i < n / 3; ++i) {
+    const unsigned j = rand() % items.size();
+    if (!tree.Remove(items[j]))
+      ++not_found;
+    items.erase(items.begin() + j);
+  }
+
+  for (unsigned i = 0; i < n / 5; ++i) {
+    items.emplace_back(RandomBox(100000, 5000), n + i);
+    tree.Insert(items.back());
+  }
+
+  ok1(Check(tree, items));
+
+  /* remove some of the new ones again */
+  for (unsigned i = 0; i < n / 10; ++i) {
+    if (!tree.Remove(items.back()))
+      ++not_found;
+    items.pop_back();
+  }
+
+  ok1(not_found == 0);
+  ok1(Check(tree, items));
+  ok1(!tree.Remove(Item(RandomBox(100000, 5000), 0 - 1)));
+
+  tree.Optimise();
+  ok1(Check(tree, items));
+
+  tree.Clear();
+  items.clear();
+  ok1(tree.empty());
+  ok1(Check(tree, items));
+}
+
+int main(int argc, char **argv)
+{
+  static const unsigned sizes[] = { 0, 1, 15, 16, 17, 255, 256, 257, 5000 };
+  plan_tests(ARRAY_SIZE(sizes) * 9);
+
+  srand(1);
+
+  for (unsigned n : sizes)
+    TestTree(n);
+
+  return exit_status();
+}
@@ -0,0 +1,125 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Engine/Trace/PackedTrace.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+#include <stdlib.h>
+
+static TracePoint
+MakePoint(unsigned time, double longitude, double latitude, int altitude,
+          int vario, unsigned drift)
+{
+  return TracePoint(GeoPoint(Angle::Degrees(fixed(longitude)),
+                             Angle::Degrees(fixed(latitude))),
+                    time, altitude, fixed(vario) / 256, drift);
+}
+
+static bool
+Equals(const TracePoint &a, const TracePoint &b)
+{
+  return a.GetTime() == b.GetTime() &&
+    fabs(a.GetLocation().longitude.Degrees() -
+         b.GetLocation().longitude.Degrees()) < 1e-7 &&
+    fabs(a.GetLocation().latitude.Degrees() -
+         b.GetLocation().latitude.Degrees()) < 1e-7 &&
+    a.GetIntegerAltitude() == b.GetIntegerAltitude() &&
+    a.GetVario() == b.GetVario() &&
+    a.GetEngineNoiseLevel() == b.GetEngineNoiseLevel() &&
+    a.GetDriftFactor() == b.GetDriftFactor();
+}
+
+static bool
+Equals(const PackedTrace &packed, const std::vector<TracePoint> &points)
+{
+  if (packed.size() != points.size())
+    return false;
+
+  auto i = points.begin();
+  for (const TracePoint point : packed)
+    if (!Equals(point, *i++))
+      return false;
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(10);
+
+  PackedTrace packed;
+  ok1(packed.empty());
+  ok1(packed.begin() == packed.end());
+
+  /* a random walk with occasional gaps, altitude and vario jumps */
+  std::vector<TracePoint> points;
+  unsigned time = 36000;
+  double longitude = 7.5, latitude = -45.25;
+  int altitude = 800, vario = 0;
+  for (unsigned i = 0; i < 10000; ++i) {
+    time += rand() % 50 == 0 ? 100 + rand() % 5000 : 1;
+    longitude += (rand() % 601 - 300) * 1e-6;
+    latitude += (rand() % 601 - 300) * 1e-6;
+    altitude += rand() % 21 - 10;
+    if (rand() % 4 == 0)
+      vario = rand() % 2001 - 1000;
+
+    TracePoint point = MakePoint(time, longitude, latitude, altitude, vario,
+                                 rand() % 100 == 0 ? rand() % 257 : 256);
+    if (rand() % 100 == 0)
+      point.SetEngineNoiseLevel(rand() % 1000);
+
+    points.push_back(point);
+    packed.push_back(point);
+  }
+
+  ok1(Equals(packed, points));
+
+  /* much smaller than the decoded fixes, even with the slack of
+     std::vector */
+  ok1(packed.GetMemoryUsage() < packed.size() * sizeof(TracePoint) / 2);
+
+  /* fixes which are not newer are ignored */
+  packed.push_back(points.back());
+  ok1(Equals(packed, points));
+
+  /* incremental synchronisation */
+  PackedTrace copy;
+  ok1(copy.Sync(packed));
+  ok1(!copy.Sync(packed));
+
+  const TracePoint extra = MakePoint(time + 1, longitude, latitude,
+                                     altitude, vario, 256);
+  points.push_back(extra);
+  packed.push_back(extra);
+  ok1(copy.Sync(packed) && Equals(copy, points));
+
+  /* a large time warp restarts the store */
+  packed.push_back(MakePoint(100, 0, 0, 0, 0, 0));
+  ok1(packed.size() == 1);
+  ok1(copy.Sync(packed) && copy.size() == 1);
+
+  return exit_status();
+}
@@ -0,0 +1,185 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Geo/PolygonEdgeIndex.hpp"
+#include "Geo/SearchPointVector.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "Geo/Flat/FlatBoundingBox.hpp"
+#include "Geo/Flat/FlatRay.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+
+#include <stdlib.h>
+
+/**
+ * A closed, non-convex polygon: a star with a randomised radius.
+ */
+static SearchPointVector
+MakeStar(const GeoPoint &center, unsigned n, double radius, double noise)
+{
+  SearchPointVector border;
+  for (unsigned i = 0; i < n; ++i) {
+    const double r = radius * (1 + noise * (rand() % 1000) / 1000.);
+    const Angle bearing = Angle::FullCircle() * i / n;
+    const Angle dx = Angle::Degrees(r * bearing.cos());
+    const Angle dy = Angle::Degrees(r * bearing.sin());
+    border.emplace_back(GeoPoint(center.longitude + dx,
+                                 center.latitude + dy));
+  }
+
+  border.emplace_back(border.front().GetLocation());
+  return border;
+}
+
+/**
+ * A closed comb shaped polygon, with long horizontal edges.
+ */
+static SearchPointVector
+MakeComb(const GeoPoint &origin, unsigned n_teeth)
+{
+  SearchPointVector border;
+  const Angle w = Angle::Degrees(0.01), h = Angle::Degrees(0.5);
+  for (unsigned i = 0; i < n_teeth; ++i) {
+    const Angle x = origin.longitude + w * (2 * i);
+    border.emplace_back(GeoPoint(x, origin.latitude + h));
+    border.emplace_back(GeoPoint(x + w, origin.latitude + h));
+    border.emplace_back(GeoPoint(x + w, origin.latitude + h * fixed(0.1)));
+    border.emplace_back(GeoPoint(x + w * 2, origin.latitude + h * fixed(0.1)));
+  }
+
+  border.emplace_back(GeoPoint(origin.longitude + w * (2 * n_teeth),
+                               origin.latitude));
+  border.emplace_back(origin);
+  border.emplace_back(border.front().GetLocation());
+  return border;
+}
+
+static GeoPoint
+RandomPoint(const GeoBounds &bounds)
+{
+  const Angle lon = bounds.GetWest() +
+    bounds.GetWidth() * fixed(1.4 * (rand() % 10000) / 10000. - 0.2);
+  const Angle lat = bounds.GetSouth() +
+    bounds.GetHeight() * fixed(1.4 * (rand() % 10000) / 10000. - 0.2);
+  return GeoPoint(lon, lat);
+}
+
+static void
+TestPolygon(SearchPointVector &border)
+{
+  const GeoBounds bounds = border.CalculateGeoBounds();
+  const FlatProjection projection(bounds.GetCenter());
+  border.Project(projection);
+
+  PolygonEdgeIndex index;
+  ok1(PolygonEdgeIndex::IsWorthwhile(border));
+
+  index.Build(border);
+  ok1(index.IsDefined());
+  ok1(!index.IsProjected());
+
+  index.Project(border);
+  ok1(index.IsProjected());
+
+  unsigned inside = 0, inside_errors = 0, nearest_errors = 0;
+  for (unsigned i = 0; i < 5000; ++i) {
+    const GeoPoint p = RandomPoint(bounds);
+    const bool expected = border.IsInside(p);
+    if (expected)
+      ++inside;
+    if (index.IsInside(border, p) != expected)
+      ++inside_errors;
+
+    const FlatGeoPoint fp = projection.ProjectInteger(p);
+    if (index.NearestPoint(border, fp) != border.NearestPoint(fp))
+      ++nearest_errors;
+  }
+
+  ok1(inside > 0);
+  ok1(inside_errors == 0);
+  ok1(nearest_errors == 0);
+
+  /* every edge intersecting a ray must be among the edges found in
+     the ray's bounding box */
+  unsigned intersections = 0, intersect_errors = 0, order_errors = 0;
+  std::vector<unsigned> edges;
+  for (unsigned i = 0; i < 1000; ++i) {
+    const FlatGeoPoint a = projection.ProjectInteger(RandomPoint(bounds));
+    const FlatGeoPoint b = projection.ProjectInteger(RandomPoint(bounds));
+    const FlatRay ray(a, b);
+
+    index.FindEdges(FlatBoundingBox(FlatGeoPoint(std::min(a.longitude,
+                                                          b.longitude),
+                                                 std::min(a.latitude,
+                                                          b.latitude)),
+                                    FlatGeoPoint(std::max(a.longitude,
+                                                          b.longitude),
+                                                 std::max(a.latitude,
+                                                          b.latitude))),
+                    edges);
+
+    if (!std::is_sorted(edges.begin(), edges.end()) ||
+        std::adjacent_find(edges.begin(), edges.end()) != edges.end())
+      ++order_errors;
+
+    for (unsigned j = 0; j + 1 < border.size(); ++j) {
+      const FlatRay segment(border[j].GetFlatLocation(),
+                            border[j + 1].GetFlatLocation());
+      if (negative(ray.DistinctIntersection(segment)))
+        continue;
+
+      ++intersections;
+      if (!std::binary_search(edges.begin(), edges.end(), j))
+        ++intersect_errors;
+    }
+  }
+
+  ok1(intersections > 0);
+  ok1(intersect_errors == 0);
+  ok1(order_errors == 0);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(2 * 10 + 1);
+
+  srand(42);
+
+  SearchPointVector star = MakeStar(GeoPoint(Angle::Degrees(7.5),
+                                             Angle::Degrees(47.2)),
+                                    2000, 0.3, 0.5);
+  TestPolygon(star);
+
+  SearchPointVector comb = MakeComb(GeoPoint(Angle::Degrees(-1.2),
+                                             Angle::Degrees(51.7)),
+                                    100);
+  TestPolygon(comb);
+
+  /* small polygons are left alone */
+  SearchPointVector small = MakeStar(GeoPoint(Angle::Zero(), Angle::Zero()),
+                                     10, 0.1, 0.5);
+  ok1(!PolygonEdgeIndex::IsWorthwhile(small));
+
+  return exit_status();
+}
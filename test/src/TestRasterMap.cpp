@@ -0,0 +1,141 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/RasterMap.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/ConstBuffer.hxx"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+#include <tchar.h>
+
+/**
+ * A grid of locations which extends beyond the map on all sides.
+ */
+static std::vector<GeoPoint>
+MakeGrid(const GeoBounds &bounds, unsigned n)
+{
+  const Angle west = bounds.GetWest(), south = bounds.GetSouth();
+  const Angle width = bounds.GetWidth(), height = bounds.GetHeight();
+
+  std::vector<GeoPoint> grid;
+  for (unsigned y = 0; y <= n; ++y)
+    for (unsigned x = 0; x <= n; ++x)
+      grid.emplace_back(west + width * (fixed(x) * fixed(1.4) / n - fixed(0.2)),
+                        south + height * (fixed(y) * fixed(1.4) / n - fixed(0.2)));
+
+  return grid;
+}
+
+static std::vector<short>
+GetHeights(const RasterMap &map, const std::vector<GeoPoint> &grid)
+{
+  std::vector<short> heights(grid.size());
+  map.GetHeights(ConstBuffer<GeoPoint>(grid.data(), grid.size()),
+                 heights.data());
+  return heights;
+}
+
+/**
+ * Does RasterMap::GetHeights() return the same as GetHeight() for
+ * each location?
+ */
+static bool
+CompareHeights(const RasterMap &map, const std::vector<GeoPoint> &grid,
+               const std::vector<short> &heights)
+{
+  for (unsigned i = 0; i < grid.size(); ++i)
+    if (heights[i] != map.GetHeight(grid[i]))
+      return false;
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(7);
+
+  NullOperationEnvironment operation;
+  RasterMap map(_T("test/data/benalla9.xcm/terrain.jp2"), nullptr, nullptr,
+                operation);
+  if (!map.IsDefined()) {
+    skip(7, 0, "Failed to load the terrain");
+    return exit_status();
+  }
+
+  /* more than one chunk of RasterMap::GetHeights() */
+  const std::vector<GeoPoint> grid = MakeGrid(map.GetBounds(), 60);
+
+  unsigned n_outside = 0;
+  for (const GeoPoint &location : grid)
+    if (!map.IsInside(location))
+      ++n_outside;
+
+  ok1(n_outside > 0 && n_outside < grid.size());
+
+  /* only the tiles near the centre are loaded; the others are
+     answered from the overview */
+  do {
+    map.SetViewCenter(map.GetMapCenter(), fixed(10000));
+  } while (map.IsDirty());
+
+  const std::vector<short> partial = GetHeights(map, grid);
+  ok1(CompareHeights(map, grid, partial));
+
+  /* outside the map */
+  bool invalid = true;
+  for (unsigned i = 0; i < grid.size(); ++i)
+    if (!map.IsInside(grid[i]) && !RasterBuffer::IsInvalid(partial[i]))
+      invalid = false;
+  ok1(invalid);
+
+  /* load all tiles */
+  do {
+    map.SetViewCenter(map.GetMapCenter(), fixed(1000000));
+  } while (map.IsDirty());
+
+  const std::vector<short> full = GetHeights(map, grid);
+  ok1(CompareHeights(map, grid, full));
+
+  /* some of the locations were on tiles which were not loaded
+     before */
+  unsigned n_changed = 0;
+  for (unsigned i = 0; i < grid.size(); ++i)
+    if (partial[i] != full[i])
+      ++n_changed;
+  ok1(n_changed > 0);
+
+  /* the locations outside the map did not change */
+  bool outside_unchanged = true;
+  for (unsigned i = 0; i < grid.size(); ++i)
+    if (!map.IsInside(grid[i]) && partial[i] != full[i])
+      outside_unchanged = false;
+  ok1(outside_unchanged);
+
+  /* an empty buffer */
+  map.GetHeights(ConstBuffer<GeoPoint>(nullptr, 0), nullptr);
+  ok1(true);
+
+  return exit_status();
+}
@@ -0,0 +1,234 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/RasterTileCache.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+
+static constexpr unsigned TILE_SIZE = 256;
+static constexpr unsigned N_TILES = 4;
+static constexpr unsigned MAP_SIZE = TILE_SIZE * N_TILES;
+
+/**
+ * A synthetic terrain: a plane which rises towards south-east, so
+ * every pixel has a distinct and predictable height.
+ */
+static constexpr short
+TestHeight(unsigned x, unsigned y)
+{
+  return short(4 * x + y);
+}
+
+/**
+ * A #RasterTileCache which is filled from an in-memory tile store
+ * instead of a JPEG2000 file.
+ */
+class TestTileCache : public RasterTileCache {
+  std::vector<uint8_t> store;
+
+public:
+  TestTileCache() {
+    SetSize(MAP_SIZE, MAP_SIZE, TILE_SIZE, TILE_SIZE, N_TILES, N_TILES);
+    SetLatLonBounds(7, 8, 51, 50);
+
+    for (unsigned row = 0; row < N_TILES; ++row)
+      for (unsigned column = 0; column < N_TILES; ++column)
+        SetTile(row * N_TILES + column,
+                column * TILE_SIZE, row * TILE_SIZE,
+                (column + 1) * TILE_SIZE, (row + 1) * TILE_SIZE);
+
+    std::fill_n(GetOverview(), (MAP_SIZE >> 4) * (MAP_SIZE >> 4), 0);
+
+    SetInitialised(true);
+    scan_overview = false;
+
+    BuildStore();
+  }
+
+private:
+  /**
+   * Write a tile store which contains all tiles.
+   */
+  void BuildStore() {
+    constexpr unsigned n_tiles = N_TILES * N_TILES;
+
+    TileStoreHeader header;
+    memset(&header, 0, sizeof(header));
+    header.version = TileStoreHeader::VERSION;
+    header.width = header.height = MAP_SIZE;
+    header.tile_width = header.tile_height = TILE_SIZE;
+    header.tile_columns = header.tile_rows = N_TILES;
+
+    const size_t index_size = n_tiles * sizeof(uint32_t);
+    const size_t tile_size = TILE_SIZE * TILE_SIZE * sizeof(short);
+    store.resize(sizeof(header) + index_size + n_tiles * tile_size);
+    memcpy(&store[0], &header, sizeof(header));
+
+    uint32_t *index = (uint32_t *)&store[sizeof(header)];
+
+    for (unsigned i = 0; i < n_tiles; ++i) {
+      const uint32_t offset = sizeof(header) + index_size + i * tile_size;
+      index[i] = offset;
+
+      const RasterTile &tile = tiles.GetLinear(i);
+      short *data = (short *)&store[offset];
+      for (unsigned y = 0; y < TILE_SIZE; ++y)
+        for (unsigned x = 0; x < TILE_SIZE; ++x)
+          *data++ = TestHeight(tile.xstart + x, tile.ystart + y);
+    }
+
+    SetTileStore(&store[0], store.size());
+  }
+};
+
+static bool
+CheckHeights(const RasterTileCache &cache)
+{
+  for (unsigned y = 0; y < MAP_SIZE; y += 7)
+    for (unsigned x = 0; x < MAP_SIZE; x += 5)
+      if (cache.GetHeight(x, y) != TestHeight(x, y))
+        return false;
+
+  return true;
+}
+
+static bool
+CheckInterpolatedHeights(const RasterTileCache &cache)
+{
+  for (unsigned y = 0; y < MAP_SIZE - 1; y += 7) {
+    for (unsigned x = 0; x < MAP_SIZE - 1; x += 5) {
+      if ((x + 1) % TILE_SIZE == 0 || (y + 1) % TILE_SIZE == 0)
+        /* no interpolation across tile boundaries */
+        continue;
+
+      /* half way between two pixels in both directions */
+      const short h = cache.GetInterpolatedHeight((x << 8) | 0x80,
+                                                  (y << 8) | 0x80);
+      if (abs(h - (TestHeight(x, y) + TestHeight(x + 1, y + 1)) / 2) > 1)
+        return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Scan one row and compare the samples with the plane.
+ */
+static bool
+CheckScanLine(const RasterTileCache &cache,
+              unsigned x0, unsigned x1, unsigned y)
+{
+  const unsigned size = x1 - x0 + 1;
+  std::vector<short> buffer(size);
+  cache.ScanLine(RasterLocation(x0 << 8, y << 8),
+                 RasterLocation(x1 << 8, y << 8),
+                 &buffer[0], size, true);
+
+  for (unsigned i = 0; i < size; ++i)
+    if (buffer[i] != TestHeight(x0 + i, y))
+      return false;
+
+  return true;
+}
+
+static void
+TestSynchronous()
+{
+  TestTileCache cache;
+  ok1(cache.HasTileStore());
+
+  /* load only the tile at the top left corner */
+  cache.UpdateTiles("", 0, 0, 0);
+  ok1(cache.GetHeight(10, 10) == TestHeight(10, 10));
+
+  /* load all tiles */
+  cache.UpdateTiles("", MAP_SIZE / 2, MAP_SIZE / 2, MAP_SIZE);
+  ok1(!cache.IsDirty());
+  ok1(CheckHeights(cache));
+  ok1(CheckInterpolatedHeights(cache));
+
+  ok1(CheckScanLine(cache, 300, 340, 100));
+
+  /* another poll does not affect the loaded tiles */
+  cache.UpdateTiles("", 0, 0, MAP_SIZE * 2);
+  ok1(CheckHeights(cache));
+}
+
+static void
+TestAsynchronous()
+{
+  TestTileCache cache;
+
+  ok1(cache.PrepareTiles(MAP_SIZE / 2, MAP_SIZE / 2, MAP_SIZE,
+                         nullptr, 0));
+  cache.DecodeTiles("");
+  cache.CommitTiles();
+
+  ok1(CheckHeights(cache));
+  ok1(CheckInterpolatedHeights(cache));
+  ok1(CheckScanLine(cache, 300, 340, 100));
+}
+
+/**
+ * A failure to open the map file during the asynchronous decode must
+ * not affect the tiles which have already been published.
+ */
+static void
+TestDecodeFailure()
+{
+  TestTileCache cache;
+
+  /* load only the tile at the top left corner from the tile store */
+  cache.UpdateTiles("", 0, 0, 0);
+  ok1(cache.GetHeight(10, 10) == TestHeight(10, 10));
+
+  /* the others would have to be decoded from a file which does not
+     exist */
+  cache.ClearTileStore();
+  ok1(cache.PrepareTiles(MAP_SIZE / 2, MAP_SIZE / 2, MAP_SIZE,
+                         nullptr, 0));
+  ok1(!cache.DecodeTiles("/nonexistent/terrain.jp2"));
+
+  ok1(cache.GetInitialised());
+  ok1(cache.GetWidth() == MAP_SIZE && cache.GetHeight() == MAP_SIZE);
+  ok1(cache.GetHeight(10, 10) == TestHeight(10, 10));
+
+  cache.CommitTiles();
+  ok1(cache.GetHeight(10, 10) == TestHeight(10, 10));
+  ok1(!cache.IsDirty());
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(19);
+
+  TestSynchronous();
+  TestAsynchronous();
+  TestDecodeFailure();
+
+  return exit_status();
+}
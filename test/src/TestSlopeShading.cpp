@@ -0,0 +1,195 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+
+#include "Terrain/OptimisedSlopeShading.hpp"
+#include "Util/AllocatedArray.hpp"
+#include "Util/Macros.hpp"
+
+extern "C" {
+#include "tap.h"
+}
+
+#include <string.h>
+
+enum class Terrain {
+  SMOOTH,
+  NOISY,
+  SPECIAL,
+};
+
+/**
+ * A simple deterministic pseudo random number generator.
+ */
+static unsigned
+Random(unsigned &seed)
+{
+  seed = seed * 1103515245 + 12345;
+  return seed >> 8;
+}
+
+static void
+FillTerrain(short *data, unsigned n, Terrain terrain, unsigned seed)
+{
+  int h = 1000;
+
+  for (unsigned i = 0; i < n; ++i) {
+    switch (terrain) {
+    case Terrain::SMOOTH:
+      h = Clamp(h + int(Random(seed) % 201) - 100, -100, 4000);
+      data[i] = h;
+      break;
+
+    case Terrain::NOISY:
+      data[i] = short(Random(seed));
+      break;
+
+    case Terrain::SPECIAL:
+      switch (Random(seed) % 8) {
+      case 0:
+        data[i] = RasterBuffer::TERRAIN_INVALID;
+        break;
+
+      case 1:
+        data[i] = RasterBuffer::TERRAIN_WATER_THRESHOLD - 1;
+        break;
+
+      case 2:
+        data[i] = RasterBuffer::TERRAIN_WATER_THRESHOLD;
+        break;
+
+      default:
+        data[i] = Random(seed) % 3000;
+      }
+      break;
+    }
+  }
+}
+
+static constexpr SlopeShadingParameters lights[] = {
+  { 0, 0, 255, 0, 0 },
+  { -126, -165, 44, 0, 0 },
+  { 179, -103, 143, 0, 0 },
+};
+
+static constexpr int contrasts[] = { -50, 0, 64, 255 };
+
+static bool
+TestShadeRow(unsigned q, Terrain terrain, int contrast)
+{
+  const unsigned width = 2 * q + 75, height = 2 * q + 1;
+  AllocatedArray<short> data(width * height);
+  AllocatedArray<int8_t> expected(width), actual(width);
+
+  const unsigned max_height_slope_factor = 8192u / (q * q);
+  const unsigned height_slope_factors[] = {
+    1, max_height_slope_factor / 2 + 1, max_height_slope_factor,
+  };
+
+  bool result = true;
+  for (const auto &light : lights) {
+    for (const unsigned height_slope_factor : height_slope_factors) {
+      FillTerrain(data.begin(), width * height, terrain,
+                  q * 7 + height_slope_factor);
+
+      SlopeShadingParameters params = light;
+      params.contrast = contrast;
+      params.height_slope_factor = height_slope_factor;
+
+      const short *src = data.begin() + q * width + q;
+      const unsigned n = width - 2 * q;
+
+      /* the row above and below may be closer than "q" at the
+         border of the height matrix */
+      for (unsigned p31 = q; p31 <= 2 * q; p31 += q) {
+        const unsigned row_minus_offset = (p31 - q) * width;
+        const unsigned row_plus_offset = q * width;
+
+        memset(expected.begin(), 0, width);
+        memset(actual.begin(), 0, width);
+
+        PortableSlopeShading(params).ShadeRow(expected.begin(), src, n,
+                                               row_minus_offset,
+                                               row_plus_offset, q, p31);
+        SlopeShading(params).ShadeRow(actual.begin(), src, n,
+                                      row_minus_offset,
+                                      row_plus_offset, q, p31);
+
+        if (memcmp(expected.begin(), actual.begin(), width) != 0)
+          result = false;
+      }
+    }
+  }
+
+  return result;
+}
+
+static bool
+TestClassifyRow(Terrain terrain, unsigned height_scale)
+{
+  const unsigned width = 83;
+  AllocatedArray<short> data(width);
+  AllocatedArray<uint8_t> expected_index(width), expected_contour(width);
+  AllocatedArray<uint8_t> actual_index(width), actual_contour(width);
+
+  FillTerrain(data.begin(), width, terrain, height_scale);
+
+  bool result = true;
+  for (const unsigned contour_height_scale : { height_scale * 2, 16u }) {
+    PortableSlopeShading::ClassifyRow(expected_index.begin(),
+                                      expected_contour.begin(),
+                                      data.begin(), width,
+                                      height_scale, contour_height_scale);
+    SlopeShading::ClassifyRow(actual_index.begin(), actual_contour.begin(),
+                              data.begin(), width,
+                              height_scale, contour_height_scale);
+
+    if (memcmp(expected_index.begin(), actual_index.begin(), width) != 0 ||
+        memcmp(expected_contour.begin(), actual_contour.begin(), width) != 0)
+      result = false;
+  }
+
+  return result;
+}
+
+int main(int argc, char **argv)
+{
+  static constexpr unsigned qs[] = { 1, 2, 7, 25 };
+  static constexpr Terrain terrains[] = {
+    Terrain::SMOOTH, Terrain::NOISY, Terrain::SPECIAL,
+  };
+  static constexpr unsigned height_scales[] = { 0, 2, 4, 6 };
+
+  plan_tests(ARRAY_SIZE(qs) * ARRAY_SIZE(terrains) * ARRAY_SIZE(contrasts) +
+             ARRAY_SIZE(terrains) * ARRAY_SIZE(height_scales));
+
+  for (const unsigned q : qs)
+    for (const Terrain terrain : terrains)
+      for (const int contrast : contrasts)
+        ok1(TestShadeRow(q, terrain, contrast));
+
+  for (const Terrain terrain : terrains)
+    for (const unsigned height_scale : height_scales)
+      ok1(TestClassifyRow(terrain, height_scale));
+
+  return exit_status();
+}
@@ -0,0 +1,162 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread/SnapshotBuffer.hpp"
+#include "Thread/Thread.hpp"
+#include "Thread/Mutex.hpp"
+
+extern "C" {
+#include "tap.h"
+}
+
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+/**
+ * A large object which is consistent only if all elements are equal,
+ * similar in size to MoreData.
+ */
+struct Blob {
+  unsigned values[1024];
+
+  void Fill(unsigned value) {
+    std::fill_n(values, 1024, value);
+  }
+
+  bool IsConsistent() const {
+    for (unsigned i = 1; i < 1024; ++i)
+      if (values[i] != values[0])
+        return false;
+    return true;
+  }
+};
+
+static constexpr unsigned N_READS = 20000;
+
+/**
+ * Publishes increasing values as fast as possible, like a GPS device
+ * at a very high rate.
+ */
+class WriterThread final : public Thread {
+  SnapshotBuffer<Blob> &snapshot;
+  Mutex &mutex;
+  Blob &locked;
+
+  Blob blob;
+
+public:
+  std::atomic<bool> stop;
+
+  WriterThread(SnapshotBuffer<Blob> &_snapshot, Mutex &_mutex, Blob &_locked)
+    :snapshot(_snapshot), mutex(_mutex), locked(_locked), stop(false) {}
+
+protected:
+  void Run() override {
+    for (unsigned value = 1; !stop.load(std::memory_order_relaxed);
+         ++value) {
+      blob.Fill(value);
+
+      const ScopeLock protect(mutex);
+      locked = blob;
+      snapshot.Publish(blob);
+    }
+  }
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static double
+ToMicroseconds(Clock::duration d)
+{
+  return std::chrono::duration<double, std::micro>(d).count();
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(6);
+
+  SnapshotBuffer<Blob> snapshot;
+  Mutex mutex;
+  Blob locked, blob;
+
+  blob.Fill(0);
+  locked = blob;
+  snapshot.Publish(blob);
+  ok1(snapshot.GetVersion() == 1);
+
+  snapshot.Read(blob);
+  ok1(blob.IsConsistent() && blob.values[0] == 0);
+
+  WriterThread writer(snapshot, mutex, locked);
+  writer.Start();
+
+  /* the old way: copy under the writer's mutex */
+  Clock::duration locked_time = Clock::duration::zero(), locked_max = locked_time;
+  bool consistent = true;
+  for (unsigned i = 0; i < N_READS; ++i) {
+    const auto start = Clock::now();
+    {
+      const ScopeLock protect(mutex);
+      blob = locked;
+    }
+    const auto duration = Clock::now() - start;
+    locked_time += duration;
+    locked_max = std::max(locked_max, duration);
+    consistent &= blob.IsConsistent();
+  }
+
+  ok1(consistent);
+
+  /* the new way: lock-free snapshot */
+  Clock::duration snapshot_time = Clock::duration::zero(), snapshot_max = snapshot_time;
+  consistent = true;
+  unsigned last_value = 0;
+  bool monotonic = true;
+  for (unsigned i = 0; i < N_READS; ++i) {
+    const auto start = Clock::now();
+    snapshot.Read(blob);
+    const auto duration = Clock::now() - start;
+    snapshot_time += duration;
+    snapshot_max = std::max(snapshot_max, duration);
+    consistent &= blob.IsConsistent();
+    monotonic &= blob.values[0] >= last_value;
+    last_value = blob.values[0];
+  }
+
+  writer.stop.store(true);
+  writer.Join();
+
+  ok1(consistent);
+  ok1(monotonic);
+
+  snapshot.Read(blob);
+  ok1(blob.values[0] == locked.values[0]);
+
+  diag("read time with mutex: mean %.2f us, max %.1f us",
+       ToMicroseconds(locked_time) / N_READS, ToMicroseconds(locked_max));
+  diag("read time with snapshot: mean %.2f us, max %.1f us, %u retries",
+       ToMicroseconds(snapshot_time) / N_READS, ToMicroseconds(snapshot_max),
+       snapshot.GetRetryCount());
+
+  return exit_status();
+}
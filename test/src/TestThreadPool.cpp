@@ -0,0 +1,115 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread/ThreadPool.hpp"
+
+extern "C" {
+#include "tap.h"
+}
+
+#include <algorithm>
+
+static constexpr unsigned N = 100;
+
+/**
+ * Run ForEach() and check that each index was visited exactly once.
+ */
+static bool
+TestForEach(ParallelExecutor &executor, unsigned n)
+{
+  unsigned counts[N];
+  std::fill_n(counts, N, 0u);
+
+  Mutex mutex;
+  executor.ForEach(n, [&counts, &mutex](unsigned i){
+      const ScopeLock protect(mutex);
+      ++counts[i];
+    });
+
+  for (unsigned i = 0; i < N; ++i)
+    if (counts[i] != (i < n ? 1u : 0u))
+      return false;
+
+  return true;
+}
+
+/**
+ * Call ForEach() from inside a job; the inner calls must not
+ * deadlock and must visit each index exactly once.
+ */
+static bool
+TestNested(ParallelExecutor &executor)
+{
+  unsigned counts[4][N];
+  for (auto &i : counts)
+    std::fill_n(i, N, 0u);
+
+  Mutex mutex;
+  executor.ForEach(4, [&executor, &counts, &mutex](unsigned i){
+      auto &c = counts[i];
+      executor.ForEach(N, [&c, &mutex](unsigned j){
+          const ScopeLock protect(mutex);
+          ++c[j];
+        });
+    });
+
+  for (const auto &c : counts)
+    for (unsigned j = 0; j < N; ++j)
+      if (c[j] != 1)
+        return false;
+
+  return true;
+}
+
+static void
+TestPool(unsigned n_workers)
+{
+  ThreadPool pool(n_workers);
+  ok1(pool.GetConcurrency() == n_workers + 1);
+
+  ok1(TestForEach(pool, 0));
+  ok1(TestForEach(pool, 1));
+  ok1(TestForEach(pool, 2));
+  ok1(TestForEach(pool, N));
+
+  /* the pool must be reusable */
+  bool repeated = true;
+  for (unsigned i = 0; i < 20; ++i)
+    if (!TestForEach(pool, N - i))
+      repeated = false;
+  ok1(repeated);
+
+  ok1(TestNested(pool));
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(22);
+
+  TestPool(0);
+  TestPool(1);
+  TestPool(3);
+
+  ok1(ThreadPool::GetDefaultWorkers(3) <= 3);
+
+  return exit_status();
+}
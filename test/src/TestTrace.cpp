@@ -26,12 +26,16 @@
 #include "IO/FileLineReader.hpp"
 #include "Engine/Trace/Trace.hpp"
 #include "Engine/Trace/Vector.hpp"
+#include "Time/PeriodClock.hpp"
 #include "Printing.hpp"
 #include "TestUtil.hpp"
+#include "Util/Macros.hpp"
 
 #include <windef.h>
 #include <assert.h>
 #include <cstdio>
+#include <string.h>
+#include <vector>
 
 static void
 OnAdvance(Trace &trace, const GeoPoint &loc, const fixed alt, const fixed t)
@@ -85,15 +89,184 @@ TestTrace(const char *filename, unsigned ntrace, bool output=false)
   return true;
 }
 
+static bool
+LoadFixes(const char *filename, std::vector<TracePoint> &points)
+{
+  FileLineReaderA reader(filename);
+  if (reader.error())
+    return false;
+
+  IGCExtensions extensions;
+  extensions.clear();
+
+  char *line;
+  while ((line = reader.ReadLine()) != NULL) {
+    IGCFix fix;
+    if (IGCParseFix(line, extensions, fix) && fix.gps_valid)
+      points.push_back(TracePoint(fix.location, fix.time.GetSecondOfDay(),
+                                  fixed(fix.gps_altitude), fixed(0), 0));
+  }
+
+  return !points.empty();
+}
+
+/**
+ * A #Trace configuration and the result of feeding an IGC file
+ * through it.  The values were obtained with the #Trace
+ * implementation based on Boost.Intrusive containers.
+ */
+struct ThinResult {
+  const char *filename;
+  unsigned no_thin_time, max_size;
+
+  unsigned size, time_checksum;
+  unsigned average_delta_time, average_delta_distance;
+};
+
+static constexpr ThinResult thin_results[] = {
+  { "test/data/01lz1hq1.igc", 0, 128, 108, 795029340u, 208, 54 },
+  { "test/data/01lz1hq1.igc", 120, 128, 108, 1486840420u, 304, 77 },
+  { "test/data/01lz1hq1.igc", 0, 1024, 844, 2972686202u, 25, 7 },
+  { "test/data/01lz1hq1.igc", 600, 1024, 844, 3465488936u, 30, 9 },
+  { "test/data/9crx3101.igc", 0, 128, 99, 2335224000u, 134, 35 },
+  { "test/data/9crx3101.igc", 120, 128, 99, 1596182156u, 308, 75 },
+  { "test/data/9crx3101.igc", 0, 1024, 867, 2729774775u, 16, 5 },
+  { "test/data/9crx3101.igc", 600, 1024, 867, 2038303432u, 18, 5 },
+};
+
+static unsigned
+TimeChecksum(const TracePointVector &points)
+{
+  unsigned checksum = 0;
+  for (const TracePoint &point : points)
+    checksum = checksum * 31 + point.GetTime();
+  return checksum;
+}
+
+static bool
+IsChronological(const TracePointVector &points)
+{
+  for (unsigned i = 1; i < points.size(); ++i)
+    if (points[i].GetTime() <= points[i - 1].GetTime())
+      return false;
+
+  return true;
+}
+
+/**
+ * Are all points of #all which are not older than #no_thin_time
+ * before the last one contained in #thinned?
+ */
+static bool
+HasRecentPoints(const TracePointVector &all, const TracePointVector &thinned,
+                unsigned no_thin_time)
+{
+  const unsigned recent = all.back().GetTime() - no_thin_time;
+
+  auto j = thinned.begin();
+  for (const TracePoint &point : all) {
+    if (point.GetTime() < recent)
+      continue;
+
+    while (j != thinned.end() && j->GetTime() < point.GetTime())
+      ++j;
+
+    if (j == thinned.end() || j->GetTime() != point.GetTime())
+      return false;
+  }
+
+  return true;
+}
+
+static void
+TestThin(const ThinResult &expected)
+{
+  std::vector<TracePoint> fixes;
+  if (!LoadFixes(expected.filename, fixes)) {
+    skip(9, 0, "Failed to load IGC file");
+    return;
+  }
+
+  /* a trace which is large enough to keep all points */
+  Trace all(0, Trace::null_time, fixes.size() + 1);
+  Trace trace(expected.no_thin_time, Trace::null_time, expected.max_size);
+
+  bool bounded = true;
+  for (const TracePoint &fix : fixes) {
+    all.push_back(fix);
+    trace.push_back(fix);
+    if (trace.size() > expected.max_size)
+      bounded = false;
+  }
+
+  TracePointVector all_points, points;
+  all.GetPoints(all_points);
+  trace.GetPoints(points);
+
+  ok1(bounded);
+  ok1(points.size() == trace.size() && IsChronological(points));
+  ok1(points.front().GetTime() == all_points.front().GetTime());
+  ok1(points.back().GetTime() == all_points.back().GetTime());
+  ok1(HasRecentPoints(all_points, points, expected.no_thin_time));
+
+  ok1(trace.size() == expected.size);
+  ok1(TimeChecksum(points) == expected.time_checksum);
+  ok1(trace.GetAverageDeltaTime() == expected.average_delta_time);
+  ok1(trace.GetAverageDeltaDistance() == expected.average_delta_distance);
+}
+
+/**
+ * Measure the insert and thinning throughput for a synthetic 10 hour
+ * flight with one fix per second.
+ */
+static void
+BenchmarkTrace(unsigned max_size)
+{
+  std::vector<TracePoint> points;
+  points.reserve(10 * 3600);
+
+  /* a deterministic random walk */
+  unsigned seed = 1;
+  GeoPoint location(Angle::Degrees(7.7), Angle::Degrees(51.05));
+  fixed altitude(1000);
+  for (unsigned t = 36000; points.size() < 10 * 3600; ++t) {
+    seed = seed * 1103515245 + 12345;
+    location.longitude += Angle::Degrees(fixed(int(seed >> 16 & 0xff) - 120) / 500000);
+    location.latitude += Angle::Degrees(fixed(int(seed >> 8 & 0xff) - 120) / 500000);
+    altitude += fixed(int(seed >> 24 & 0xf) - 7);
+    points.push_back(TracePoint(location, t, altitude, fixed(0), 0));
+  }
+
+  static constexpr unsigned n_runs = 10;
+
+  Trace trace(120, Trace::null_time, max_size);
+  PeriodClock clock;
+  clock.Update();
+
+  for (unsigned i = 0; i < n_runs; ++i) {
+    trace.clear();
+    for (const TracePoint &point : points)
+      trace.push_back(point);
+  }
+
+  const int elapsed = std::max(clock.Elapsed(), 1);
+  printf("# max_size %u: %u fixes in %d ms, %u fixes/s\n",
+         max_size, unsigned(points.size()) * n_runs, elapsed,
+         unsigned(points.size() * n_runs * 1000 / elapsed));
+}
 
 int main(int argc, char **argv)
 {
-  if (argc < 3) {
-    unsigned n = 100;
-    if (argc > 1) {
-      n = atoi(argv[1]);
-    }
-    TestTrace("test/data/09kc3ov3.igc", n);
+  if (argc == 2 && strcmp(argv[1], "--benchmark") == 0) {
+    for (unsigned max_size : {128u, 1024u, 8192u})
+      BenchmarkTrace(max_size);
+  } else if (argc < 3) {
+    plan_tests(9 * ARRAY_SIZE(thin_results));
+
+    for (const auto &i : thin_results)
+      TestThin(i);
+
+    return exit_status();
   } else {
     assert(argc >= 3);
     unsigned n = atoi(argv[2]);
@@ -6,7 +6,7 @@
 #include "Computer/Settings.hpp"
 #include "OS/PathName.hpp"
 #include "OS/FileUtil.hpp"
-#include "IO/FileLineReader.hpp"
+#include "IGC/IGCMappedReader.hpp"
 #include "NMEA/MoreData.hpp"
 #include "NMEA/Derived.hpp"
 #include "test_debug.hpp"
@@ -90,7 +90,7 @@ inline void load_scores(unsigned &contest_handicap) {
 class ReplayLoggerSim: public IgcReplay
 {
 public:
-  ReplayLoggerSim(NLineReader *reader)
+  ReplayLoggerSim(IGCMappedReader *reader)
     :IgcReplay(reader) {}
 
   void print(std::ostream &f, const MoreData &basic) {
@@ -112,7 +112,7 @@ test_replay(const Contest olc_type,
 
   GlidePolar glide_polar(fixed(2));
 
-  FileLineReaderA *reader = new FileLineReaderA(replay_file.c_str());
+  IGCMappedReader *reader = new IGCMappedReader(replay_file.c_str());
   if (reader->error()) {
     delete reader;
     return false;
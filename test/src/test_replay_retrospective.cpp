@@ -5,7 +5,7 @@
 #include "NMEA/FlyingState.hpp"
 #include "OS/ConvertPathName.hpp"
 #include "OS/FileUtil.hpp"
-#include "IO/FileLineReader.hpp"
+#include "IGC/IGCMappedReader.hpp"
 #include "NMEA/Info.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Engine/Contest/Solvers/Retrospective.hpp"
@@ -44,7 +44,7 @@ test_replay_retrospective()
   retro.search_range = range_threshold;
   retro.angle_tolerance = Angle::Degrees(autopilot_parms.bearing_noise);
 
-  FileLineReaderA *reader = new FileLineReaderA(replay_file.c_str());
+  IGCMappedReader *reader = new IGCMappedReader(replay_file.c_str());
   if (reader->error()) {
     delete reader;
     return false;
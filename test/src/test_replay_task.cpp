@@ -9,7 +9,7 @@
 #include "NMEA/FlyingState.hpp"
 #include "OS/ConvertPathName.hpp"
 #include "OS/FileUtil.hpp"
-#include "IO/FileLineReader.hpp"
+#include "IGC/IGCMappedReader.hpp"
 #include "Task/LoadFile.hpp"
 #include "NMEA/Info.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
@@ -36,7 +36,7 @@ task_load(const TaskBehaviour &task_behaviour)
 class ReplayLoggerSim: public IgcReplay
 {
 public:
-  ReplayLoggerSim(NLineReader *reader)
+  ReplayLoggerSim(IGCMappedReader *reader)
     :IgcReplay(reader),
      started(false) {}
 
@@ -103,7 +103,7 @@ test_replay()
 
   // task_manager.get_task_advance().get_advance_state() = TaskAdvance::AUTO;
 
-  FileLineReaderA *reader = new FileLineReaderA(replay_file.c_str());
+  IGCMappedReader *reader = new IGCMappedReader(replay_file.c_str());
   if (reader->error()) {
     delete reader;
     return false;